@@ -7,6 +7,8 @@
 #include "audio_core/sink.h"
 #include "audio_core/sink_details.h"
 #include "common/assert.h"
+#include "core/core.h"
+#include "core/dumping/backend.h"
 #include "core/settings.h"
 
 namespace AudioCore {
@@ -41,6 +43,11 @@ void DspInterface::OutputFrame(StereoFrame16& frame) {
         return;
 
     fifo.Push(frame.data(), frame.size());
+
+    auto& video_dumper = Core::System::GetInstance().VideoDumper();
+    if (video_dumper.IsDumping()) {
+        video_dumper.AddAudioFrame(frame);
+    }
 }
 
 void DspInterface::OutputSample(std::array<s16, 2> sample) {
@@ -48,6 +55,11 @@ void DspInterface::OutputSample(std::array<s16, 2> sample) {
         return;
 
     fifo.Push(&sample, 1);
+
+    auto& video_dumper = Core::System::GetInstance().VideoDumper();
+    if (video_dumper.IsDumping()) {
+        video_dumper.AddAudioSample(sample);
+    }
 }
 
 void DspInterface::OutputCallback(s16* buffer, std::size_t num_frames) {
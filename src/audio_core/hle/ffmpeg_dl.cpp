@@ -22,6 +22,7 @@ struct LibraryDeleter {
 
 std::unique_ptr<HMODULE, LibraryDeleter> dll_util{nullptr};
 std::unique_ptr<HMODULE, LibraryDeleter> dll_codec{nullptr};
+std::unique_ptr<HMODULE, LibraryDeleter> dll_format{nullptr};
 
 } // namespace
 
@@ -42,6 +43,24 @@ FuncDL<int(AVCodecParserContext*, AVCodecContext*, uint8_t**, int*, const uint8_
     av_parser_parse2_dl;
 FuncDL<void(AVCodecParserContext*)> av_parser_close_dl;
 
+FuncDL<int(AVFrame*, int)> av_frame_get_buffer_dl;
+FuncDL<int(AVFrame*)> av_frame_make_writable_dl;
+FuncDL<AVCodec*(AVCodecID)> avcodec_find_encoder_dl;
+FuncDL<AVCodec*(const char*)> avcodec_find_encoder_by_name_dl;
+FuncDL<int(AVCodecContext*, const AVFrame*)> avcodec_send_frame_dl;
+FuncDL<int(AVCodecContext*, AVPacket*)> avcodec_receive_packet_dl;
+FuncDL<int(AVCodecParameters*, const AVCodecContext*)> avcodec_parameters_from_context_dl;
+FuncDL<void(AVPacket*, AVRational, AVRational)> av_packet_rescale_ts_dl;
+FuncDL<int(AVFormatContext**, AVOutputFormat*, const char*, const char*)>
+    avformat_alloc_output_context2_dl;
+FuncDL<AVStream*(AVFormatContext*, const AVCodec*)> avformat_new_stream_dl;
+FuncDL<int(AVFormatContext*, AVDictionary**)> avformat_write_header_dl;
+FuncDL<int(AVFormatContext*, AVPacket*)> av_interleaved_write_frame_dl;
+FuncDL<int(AVFormatContext*)> av_write_trailer_dl;
+FuncDL<void(AVFormatContext*)> avformat_free_context_dl;
+FuncDL<int(AVIOContext**, const char*, int)> avio_open_dl;
+FuncDL<int(AVIOContext**)> avio_closep_dl;
+
 bool InitFFmpegDL() {
     std::string dll_path = FileUtil::GetUserPath(FileUtil::UserPath::DLLDir);
     FileUtil::CreateDir(dll_path);
@@ -175,4 +194,136 @@ bool InitFFmpegDL() {
     return true;
 }
 
+bool InitFFmpegEncoderDL() {
+    if (!InitFFmpegDL()) {
+        return false;
+    }
+
+    dll_format.reset(LoadLibrary("avformat-58.dll"));
+    if (!dll_format) {
+        DWORD error_message_id = GetLastError();
+        LPSTR message_buffer = nullptr;
+        size_t size =
+            FormatMessageA(FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM |
+                               FORMAT_MESSAGE_IGNORE_INSERTS,
+                           nullptr, error_message_id, MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT),
+                           reinterpret_cast<LPSTR>(&message_buffer), 0, nullptr);
+
+        std::string message(message_buffer, size);
+
+        LocalFree(message_buffer);
+        LOG_ERROR(Audio_DSP, "Could not load avformat-58.dll: {}", message);
+        return false;
+    }
+
+    av_frame_get_buffer_dl = FuncDL<int(AVFrame*, int)>(dll_util.get(), "av_frame_get_buffer");
+    if (!av_frame_get_buffer_dl) {
+        LOG_ERROR(Audio_DSP, "Can not load function av_frame_get_buffer");
+        return false;
+    }
+
+    av_frame_make_writable_dl = FuncDL<int(AVFrame*)>(dll_util.get(), "av_frame_make_writable");
+    if (!av_frame_make_writable_dl) {
+        LOG_ERROR(Audio_DSP, "Can not load function av_frame_make_writable");
+        return false;
+    }
+
+    avcodec_find_encoder_dl = FuncDL<AVCodec*(AVCodecID)>(dll_codec.get(), "avcodec_find_encoder");
+    if (!avcodec_find_encoder_dl) {
+        LOG_ERROR(Audio_DSP, "Can not load function avcodec_find_encoder");
+        return false;
+    }
+
+    avcodec_find_encoder_by_name_dl =
+        FuncDL<AVCodec*(const char*)>(dll_codec.get(), "avcodec_find_encoder_by_name");
+    if (!avcodec_find_encoder_by_name_dl) {
+        LOG_ERROR(Audio_DSP, "Can not load function avcodec_find_encoder_by_name");
+        return false;
+    }
+
+    avcodec_send_frame_dl =
+        FuncDL<int(AVCodecContext*, const AVFrame*)>(dll_codec.get(), "avcodec_send_frame");
+    if (!avcodec_send_frame_dl) {
+        LOG_ERROR(Audio_DSP, "Can not load function avcodec_send_frame");
+        return false;
+    }
+
+    avcodec_receive_packet_dl =
+        FuncDL<int(AVCodecContext*, AVPacket*)>(dll_codec.get(), "avcodec_receive_packet");
+    if (!avcodec_receive_packet_dl) {
+        LOG_ERROR(Audio_DSP, "Can not load function avcodec_receive_packet");
+        return false;
+    }
+
+    avcodec_parameters_from_context_dl = FuncDL<int(AVCodecParameters*, const AVCodecContext*)>(
+        dll_codec.get(), "avcodec_parameters_from_context");
+    if (!avcodec_parameters_from_context_dl) {
+        LOG_ERROR(Audio_DSP, "Can not load function avcodec_parameters_from_context");
+        return false;
+    }
+
+    av_packet_rescale_ts_dl =
+        FuncDL<void(AVPacket*, AVRational, AVRational)>(dll_codec.get(), "av_packet_rescale_ts");
+    if (!av_packet_rescale_ts_dl) {
+        LOG_ERROR(Audio_DSP, "Can not load function av_packet_rescale_ts");
+        return false;
+    }
+
+    avformat_alloc_output_context2_dl =
+        FuncDL<int(AVFormatContext**, AVOutputFormat*, const char*, const char*)>(
+            dll_format.get(), "avformat_alloc_output_context2");
+    if (!avformat_alloc_output_context2_dl) {
+        LOG_ERROR(Audio_DSP, "Can not load function avformat_alloc_output_context2");
+        return false;
+    }
+
+    avformat_new_stream_dl = FuncDL<AVStream*(AVFormatContext*, const AVCodec*)>(
+        dll_format.get(), "avformat_new_stream");
+    if (!avformat_new_stream_dl) {
+        LOG_ERROR(Audio_DSP, "Can not load function avformat_new_stream");
+        return false;
+    }
+
+    avformat_write_header_dl =
+        FuncDL<int(AVFormatContext*, AVDictionary**)>(dll_format.get(), "avformat_write_header");
+    if (!avformat_write_header_dl) {
+        LOG_ERROR(Audio_DSP, "Can not load function avformat_write_header");
+        return false;
+    }
+
+    av_interleaved_write_frame_dl =
+        FuncDL<int(AVFormatContext*, AVPacket*)>(dll_format.get(), "av_interleaved_write_frame");
+    if (!av_interleaved_write_frame_dl) {
+        LOG_ERROR(Audio_DSP, "Can not load function av_interleaved_write_frame");
+        return false;
+    }
+
+    av_write_trailer_dl = FuncDL<int(AVFormatContext*)>(dll_format.get(), "av_write_trailer");
+    if (!av_write_trailer_dl) {
+        LOG_ERROR(Audio_DSP, "Can not load function av_write_trailer");
+        return false;
+    }
+
+    avformat_free_context_dl =
+        FuncDL<void(AVFormatContext*)>(dll_format.get(), "avformat_free_context");
+    if (!avformat_free_context_dl) {
+        LOG_ERROR(Audio_DSP, "Can not load function avformat_free_context");
+        return false;
+    }
+
+    avio_open_dl = FuncDL<int(AVIOContext**, const char*, int)>(dll_format.get(), "avio_open");
+    if (!avio_open_dl) {
+        LOG_ERROR(Audio_DSP, "Can not load function avio_open");
+        return false;
+    }
+
+    avio_closep_dl = FuncDL<int(AVIOContext**)>(dll_format.get(), "avio_closep");
+    if (!avio_closep_dl) {
+        LOG_ERROR(Audio_DSP, "Can not load function avio_closep");
+        return false;
+    }
+
+    return true;
+}
+
 #endif // _Win32
@@ -10,6 +10,7 @@
 
 extern "C" {
 #include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
 }
 
 #ifdef _WIN32
@@ -53,6 +54,28 @@ extern FuncDL<void(AVCodecParserContext*)> av_parser_close_dl;
 
 bool InitFFmpegDL();
 
+// Encoding and muxing functions, used by the video dumper
+extern FuncDL<int(AVFrame*, int)> av_frame_get_buffer_dl;
+extern FuncDL<int(AVFrame*)> av_frame_make_writable_dl;
+extern FuncDL<AVCodec*(AVCodecID)> avcodec_find_encoder_dl;
+extern FuncDL<AVCodec*(const char*)> avcodec_find_encoder_by_name_dl;
+extern FuncDL<int(AVCodecContext*, const AVFrame*)> avcodec_send_frame_dl;
+extern FuncDL<int(AVCodecContext*, AVPacket*)> avcodec_receive_packet_dl;
+extern FuncDL<int(AVCodecParameters*, const AVCodecContext*)> avcodec_parameters_from_context_dl;
+extern FuncDL<void(AVPacket*, AVRational, AVRational)> av_packet_rescale_ts_dl;
+extern FuncDL<int(AVFormatContext**, AVOutputFormat*, const char*, const char*)>
+    avformat_alloc_output_context2_dl;
+extern FuncDL<AVStream*(AVFormatContext*, const AVCodec*)> avformat_new_stream_dl;
+extern FuncDL<int(AVFormatContext*, AVDictionary**)> avformat_write_header_dl;
+extern FuncDL<int(AVFormatContext*, AVPacket*)> av_interleaved_write_frame_dl;
+extern FuncDL<int(AVFormatContext*)> av_write_trailer_dl;
+extern FuncDL<void(AVFormatContext*)> avformat_free_context_dl;
+extern FuncDL<int(AVIOContext**, const char*, int)> avio_open_dl;
+extern FuncDL<int(AVIOContext**)> avio_closep_dl;
+
+/// Loads avformat and the encoding functions in addition to everything InitFFmpegDL loads
+bool InitFFmpegEncoderDL();
+
 #else // _Win32
 
 // No dynamic loading for Unix and Apple
@@ -72,7 +95,29 @@ const auto av_parser_init_dl = &av_parser_init;
 const auto av_parser_parse2_dl = &av_parser_parse2;
 const auto av_parser_close_dl = &av_parser_close;
 
-bool InitFFmpegDL() {
+// Encoding and muxing functions, used by the video dumper
+const auto av_frame_get_buffer_dl = &av_frame_get_buffer;
+const auto av_frame_make_writable_dl = &av_frame_make_writable;
+const auto avcodec_find_encoder_dl = &avcodec_find_encoder;
+const auto avcodec_find_encoder_by_name_dl = &avcodec_find_encoder_by_name;
+const auto avcodec_send_frame_dl = &avcodec_send_frame;
+const auto avcodec_receive_packet_dl = &avcodec_receive_packet;
+const auto avcodec_parameters_from_context_dl = &avcodec_parameters_from_context;
+const auto av_packet_rescale_ts_dl = &av_packet_rescale_ts;
+const auto avformat_alloc_output_context2_dl = &avformat_alloc_output_context2;
+const auto avformat_new_stream_dl = &avformat_new_stream;
+const auto avformat_write_header_dl = &avformat_write_header;
+const auto av_interleaved_write_frame_dl = &av_interleaved_write_frame;
+const auto av_write_trailer_dl = &av_write_trailer;
+const auto avformat_free_context_dl = &avformat_free_context;
+const auto avio_open_dl = &avio_open;
+const auto avio_closep_dl = &avio_closep;
+
+inline bool InitFFmpegDL() {
+    return true;
+}
+
+inline bool InitFFmpegEncoderDL() {
     return true;
 }
 
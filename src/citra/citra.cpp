@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <regex>
@@ -24,6 +25,7 @@
 #endif
 
 #include "citra/config.h"
+#include "citra/emu_window/emu_window_headless.h"
 #include "citra/emu_window/emu_window_sdl2.h"
 #include "common/common_paths.h"
 #include "common/detached_tasks.h"
@@ -35,6 +37,7 @@
 #include "common/scope_exit.h"
 #include "common/string_util.h"
 #include "core/core.h"
+#include "core/dumping/backend.h"
 #include "core/file_sys/cia_container.h"
 #include "core/frontend/applets/default_applets.h"
 #include "core/gdbstub/gdbstub.h"
@@ -61,6 +64,7 @@ static void PrintHelp(const char* argv0) {
                  " Nickname, password, address and port for multiplayer\n"
                  "-r, --movie-record=[file]  Record a movie (game inputs) to the given file\n"
                  "-p, --movie-play=[file]    Playback the movie (game inputs) from the given file\n"
+                 "-d, --dump-video=[file]    Dumps audio and video to the given file\n"
                  "-f, --fullscreen     Start in fullscreen mode\n"
                  "-h, --help           Display this help and exit\n"
                  "-v, --version        Output version information and exit\n";
@@ -186,6 +190,7 @@ int main(int argc, char** argv) {
     u32 gdb_port = static_cast<u32>(Settings::values.gdbstub_port);
     std::string movie_record;
     std::string movie_play;
+    std::string dump_video;
 
     InitializeLogging();
 
@@ -214,6 +219,7 @@ int main(int argc, char** argv) {
         {"multiplayer", required_argument, 0, 'm'},
         {"movie-record", required_argument, 0, 'r'},
         {"movie-play", required_argument, 0, 'p'},
+        {"dump-video", required_argument, 0, 'd'},
         {"fullscreen", no_argument, 0, 'f'},
         {"help", no_argument, 0, 'h'},
         {"version", no_argument, 0, 'v'},
@@ -221,7 +227,7 @@ int main(int argc, char** argv) {
     };
 
     while (optind < argc) {
-        int arg = getopt_long(argc, argv, "g:i:m:r:p:fhv", long_options, &option_index);
+        int arg = getopt_long(argc, argv, "g:i:m:r:p:d:fhv", long_options, &option_index);
         if (arg != -1) {
             switch (static_cast<char>(arg)) {
             case 'g':
@@ -284,6 +290,9 @@ int main(int argc, char** argv) {
             case 'p':
                 movie_play = optarg;
                 break;
+            case 'd':
+                dump_video = optarg;
+                break;
             case 'f':
                 fullscreen = true;
                 LOG_INFO(Frontend, "Starting in fullscreen mode...");
@@ -337,7 +346,17 @@ int main(int argc, char** argv) {
     // Register frontend applets
     Frontend::RegisterDefaultApplets();
 
-    std::unique_ptr<EmuWindow_SDL2> emu_window{std::make_unique<EmuWindow_SDL2>(fullscreen)};
+    std::unique_ptr<Frontend::EmuWindow> emu_window;
+    std::function<bool()> is_window_open;
+    if (Settings::values.renderer_backend == Settings::RendererBackend::OpenGL) {
+        auto sdl_window = std::make_unique<EmuWindow_SDL2>(fullscreen);
+        is_window_open = [window = sdl_window.get()] { return window->IsOpen(); };
+        emu_window = std::move(sdl_window);
+    } else {
+        auto headless_window = std::make_unique<EmuWindow_Headless>();
+        is_window_open = [window = headless_window.get()] { return window->IsOpen(); };
+        emu_window = std::move(headless_window);
+    }
 
     Core::System& system{Core::System::GetInstance()};
 
@@ -398,8 +417,11 @@ int main(int argc, char** argv) {
     if (!movie_record.empty()) {
         Core::Movie::GetInstance().StartRecording(movie_record);
     }
+    if (!dump_video.empty()) {
+        system.VideoDumper().StartDumping(dump_video);
+    }
 
-    while (emu_window->IsOpen()) {
+    while (is_window_open()) {
         system.RunLoop();
     }
 
@@ -103,8 +103,12 @@ void Config::ReadValues() {
 
     // Core
     Settings::values.use_cpu_jit = sdl2_config->GetBoolean("Core", "use_cpu_jit", true);
+    Settings::values.dyncom_cache_size =
+        static_cast<u32>(sdl2_config->GetInteger("Core", "dyncom_cache_size", 128));
 
     // Renderer
+    Settings::values.renderer_backend = static_cast<Settings::RendererBackend>(
+        sdl2_config->GetInteger("Renderer", "renderer_backend", 0));
     Settings::values.use_gles = sdl2_config->GetBoolean("Renderer", "use_gles", false);
     Settings::values.use_hw_renderer = sdl2_config->GetBoolean("Renderer", "use_hw_renderer", true);
 #ifdef __APPLE__
@@ -120,9 +124,12 @@ void Config::ReadValues() {
     Settings::values.shaders_accurate_mul =
         sdl2_config->GetBoolean("Renderer", "shaders_accurate_mul", false);
     Settings::values.use_shader_jit = sdl2_config->GetBoolean("Renderer", "use_shader_jit", true);
+    Settings::values.use_gpu_thread = sdl2_config->GetBoolean("Renderer", "use_gpu_thread", false);
     Settings::values.resolution_factor =
         static_cast<u16>(sdl2_config->GetInteger("Renderer", "resolution_factor", 1));
     Settings::values.vsync_enabled = sdl2_config->GetBoolean("Renderer", "vsync_enabled", false);
+    Settings::values.use_present_thread =
+        sdl2_config->GetBoolean("Renderer", "use_present_thread", false);
     Settings::values.use_frame_limit = sdl2_config->GetBoolean("Renderer", "use_frame_limit", true);
     Settings::values.frame_limit =
         static_cast<u16>(sdl2_config->GetInteger("Renderer", "frame_limit", 100));
@@ -237,6 +244,14 @@ void Config::ReadValues() {
         Settings::values.lle_modules.emplace(service_module.name, use_lle);
     }
 
+    // Video Dumping
+    Settings::values.dump_video_encoder =
+        sdl2_config->GetString("VideoDumping", "video_encoder", "");
+    Settings::values.dump_audio_encoder =
+        sdl2_config->GetString("VideoDumping", "audio_encoder", "flac");
+    Settings::values.dump_ring_depth =
+        static_cast<u32>(sdl2_config->GetInteger("VideoDumping", "ring_depth", 8));
+
     // Web Service
     Settings::values.enable_telemetry =
         sdl2_config->GetBoolean("WebService", "enable_telemetry", true);
@@ -91,7 +91,16 @@ udp_pad_index=
 # 0: Interpreter (slow), 1 (default): JIT (fast)
 use_cpu_jit =
 
+# Size limit in MiB of the buffer holding the instructions translated by the interpreter. The whole
+# buffer is flushed when it fills up, larger sizes flush less often. (Default 128)
+dyncom_cache_size =
+
 [Renderer]
+# Which renderer to use. The null renderers don't open a window and need no GPU, which makes them
+# useful to measure raw emulation speed, together with an unlimited frame limit.
+# 0 (default): OpenGL, 1: Null (no rasterization), 2: Null with the software rasterizer
+renderer_backend =
+
 # Whether to render using GLES or OpenGL
 # 0 (default): OpenGL, 1: GLES
 use_gles =
@@ -116,6 +125,10 @@ shaders_accurate_gs =
 # 0: Interpreter (slow), 1 (default): JIT (fast)
 use_shader_jit =
 
+# Whether to process GPU commands on a dedicated thread, overlapping rendering with CPU emulation
+# 0 (default): Off, 1: On
+use_gpu_thread =
+
 # Resolution scale factor
 # 0: Auto (scales resolution to window size), 1: Native 3DS screen resolution, Otherwise a scale
 # factor for the 3DS resolution
@@ -125,6 +138,11 @@ resolution_factor =
 # 0 (default): Off, 1: On
 vsync_enabled =
 
+# Whether to present frames to the window from a dedicated thread, so that V-Sync and slow buffer
+# swaps don't stall emulation. Frames that aren't presented in time are dropped.
+# 0 (default): Off, 1: On
+use_present_thread =
+
 # Turns on the frame limiter, which will limit frames output to the target game speed
 # 0: Off, 1: On (default)
 use_frame_limit =
@@ -256,6 +274,20 @@ use_gdbstub=false
 gdbstub_port=24689
 # To LLE a service module add "LLE\<module name>=true"
 
+[VideoDumping]
+# Settings for dumping video and audio with --dump-video. The container format is guessed from the
+# extension of the output file.
+# Name of the FFmpeg video encoder, e.g. libx264. Leave empty to use the container's default
+video_encoder =
+
+# Name of the FFmpeg audio encoder. It has to support the 32728 Hz sample rate of the 3DS
+# Default: flac
+audio_encoder =
+
+# Number of frames that can wait for the encoder before emulation is slowed down to let it catch up
+# Default: 8
+ring_depth =
+
 [WebService]
 # Whether or not to enable telemetry
 # 0: No, 1 (default): Yes
@@ -0,0 +1,43 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <csignal>
+#include "citra/emu_window/emu_window_headless.h"
+#include "common/logging/log.h"
+#include "common/scm_rev.h"
+#include "core/3ds.h"
+#include "core/settings.h"
+#include "input_common/main.h"
+#include "network/network.h"
+
+static volatile std::sig_atomic_t interrupted = 0;
+
+static void OnInterrupt(int) {
+    interrupted = 1;
+}
+
+EmuWindow_Headless::EmuWindow_Headless() {
+    InputCommon::Init();
+    Network::Init();
+
+    // Without a window to close, shut down cleanly on Ctrl+C so that the final stats get logged
+    std::signal(SIGINT, OnInterrupt);
+    std::signal(SIGTERM, OnInterrupt);
+
+    UpdateCurrentFramebufferLayout(Core::kScreenTopWidth,
+                                   Core::kScreenTopHeight + Core::kScreenBottomHeight);
+
+    LOG_INFO(Frontend, "Citra Version: {} | {}-{}", Common::g_build_fullname, Common::g_scm_branch,
+             Common::g_scm_desc);
+    Settings::LogSettings();
+}
+
+EmuWindow_Headless::~EmuWindow_Headless() {
+    Network::Shutdown();
+    InputCommon::Shutdown();
+}
+
+bool EmuWindow_Headless::IsOpen() const {
+    return interrupted == 0;
+}
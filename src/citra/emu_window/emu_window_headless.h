@@ -0,0 +1,29 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "core/frontend/emu_window.h"
+
+/// Window used with the null renderers: it has no graphics context and never shows anything
+class EmuWindow_Headless : public Frontend::EmuWindow {
+public:
+    EmuWindow_Headless();
+    ~EmuWindow_Headless();
+
+    /// Does nothing, there is no back buffer to swap
+    void SwapBuffers() override {}
+
+    /// Does nothing, there are no window events
+    void PollEvents() override {}
+
+    /// Does nothing, there is no graphics context
+    void MakeCurrent() override {}
+
+    /// Does nothing, there is no graphics context
+    void DoneCurrent() override {}
+
+    /// Whether emulation should keep running, until the process is interrupted
+    bool IsOpen() const;
+};
@@ -20,6 +20,31 @@
 #include "input_common/sdl/sdl.h"
 #include "network/network.h"
 
+class SDLGLContext : public Frontend::GraphicsContext {
+public:
+    SDLGLContext(SDL_Window* window, SDL_GLContext context) : window{window}, context{context} {}
+
+    ~SDLGLContext() override {
+        SDL_GL_DeleteContext(context);
+    }
+
+    void SwapBuffers() override {
+        SDL_GL_SwapWindow(window);
+    }
+
+    void MakeCurrent() override {
+        SDL_GL_MakeCurrent(window, context);
+    }
+
+    void DoneCurrent() override {
+        SDL_GL_MakeCurrent(window, nullptr);
+    }
+
+private:
+    SDL_Window* window;
+    SDL_GLContext context;
+};
+
 void EmuWindow_SDL2::OnMouseMotion(s32 x, s32 y) {
     TouchMoved((unsigned)std::max(x, 0), (unsigned)std::max(y, 0));
     InputCommon::GetMotionEmu()->Tilt(x, y);
@@ -252,6 +277,26 @@ void EmuWindow_SDL2::DoneCurrent() {
     SDL_GL_MakeCurrent(render_window, nullptr);
 }
 
+std::unique_ptr<Frontend::GraphicsContext> EmuWindow_SDL2::CreateSharedContext() const {
+    // SDL shares the new context with the one that is current on the calling thread, and makes the
+    // new context current
+    SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 1);
+    SDL_GLContext shared_context = SDL_GL_CreateContext(render_window);
+    SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 0);
+
+    if (shared_context == nullptr) {
+        LOG_ERROR(Frontend, "Failed to create shared SDL2 GL context: {}", SDL_GetError());
+        SDL_GL_MakeCurrent(render_window, gl_context);
+        return nullptr;
+    }
+
+    // The swap interval is a property of the context presenting to the window
+    SDL_GL_SetSwapInterval(Settings::values.vsync_enabled);
+    SDL_GL_MakeCurrent(render_window, gl_context);
+
+    return std::make_unique<SDLGLContext>(render_window, shared_context);
+}
+
 void EmuWindow_SDL2::OnMinimalClientAreaChangeRequest(
     const std::pair<unsigned, unsigned>& minimal_size) {
 
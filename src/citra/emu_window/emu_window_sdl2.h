@@ -27,6 +27,9 @@ public:
     /// Releases the GL context from the caller thread
     void DoneCurrent() override;
 
+    /// Creates a GL context sharing objects with the main one, presenting to the same window
+    std::unique_ptr<Frontend::GraphicsContext> CreateSharedContext() const override;
+
     /// Whether the window is still open, and a close request hasn't yet been sent
     bool IsOpen() const;
 
@@ -145,6 +145,7 @@ void Config::ReadValues() {
 
     qt_config->beginGroup("Core");
     Settings::values.use_cpu_jit = ReadSetting("use_cpu_jit", true).toBool();
+    Settings::values.dyncom_cache_size = ReadSetting("dyncom_cache_size", 128).toUInt();
     qt_config->endGroup();
 
     qt_config->beginGroup("Renderer");
@@ -442,6 +443,7 @@ void Config::SaveValues() {
 
     qt_config->beginGroup("Core");
     WriteSetting("use_cpu_jit", Settings::values.use_cpu_jit, true);
+    WriteSetting("dyncom_cache_size", Settings::values.dyncom_cache_size, 128);
     qt_config->endGroup();
 
     qt_config->beginGroup("Renderer");
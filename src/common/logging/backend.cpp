@@ -236,6 +236,7 @@ void DebuggerBackend::Write(const Entry& entry) {
     CLS(Input)                                                                                     \
     CLS(Network)                                                                                   \
     CLS(Movie)                                                                                     \
+    CLS(Dumping)                                                                                   \
     CLS(Loader)                                                                                    \
     CLS(WebService)                                                                                \
     CLS(RPC_Server)
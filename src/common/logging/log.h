@@ -99,6 +99,7 @@ enum class Class : ClassType {
     Input,             ///< Input emulation
     Network,           ///< Network emulation
     Movie,             ///< Movie (Input Recording) Playback
+    Dumping,           ///< Video and audio dumping
     WebService,        ///< Interface to Citra Web Services
     RPC_Server,        ///< RPC server
     Count              ///< Total number of logging classes
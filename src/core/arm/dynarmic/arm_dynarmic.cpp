@@ -274,15 +274,17 @@ void ARM_Dynarmic::ClearInstructionCache() {
     for (const auto& j : jits) {
         j.second->ClearCache();
     }
-    interpreter_state->instruction_cache.clear();
+    interpreter_state->instruction_cache.Clear();
 }
 
 void ARM_Dynarmic::InvalidateCacheRange(u32 start_address, std::size_t length) {
     jit->InvalidateCacheRange(start_address, length);
+    interpreter_state->instruction_cache.InvalidateRange(start_address, length);
 }
 
 void ARM_Dynarmic::PageTableChanged() {
     current_page_table = memory.GetCurrentPageTable();
+    interpreter_state->PageTableChanged();
 
     auto iter = jits.find(current_page_table);
     if (iter != jits.end()) {
@@ -298,7 +300,7 @@ void ARM_Dynarmic::PageTableChanged() {
 std::unique_ptr<Dynarmic::A32::Jit> ARM_Dynarmic::MakeJit() {
     Dynarmic::A32::UserConfig config;
     config.callbacks = cb.get();
-    config.page_table = &current_page_table->pointers;
+    config.page_table = &current_page_table->GetPointerArray();
     config.coprocessors[15] = std::make_shared<DynarmicCP15>(interpreter_state);
     config.define_unpredictable_behaviour = true;
     return std::make_unique<Dynarmic::A32::Jit>(config);
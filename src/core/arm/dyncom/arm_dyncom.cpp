@@ -5,9 +5,9 @@
 #include <algorithm>
 #include <cstring>
 #include <memory>
+#include "common/logging/log.h"
 #include "core/arm/dyncom/arm_dyncom.h"
 #include "core/arm/dyncom/arm_dyncom_interpreter.h"
-#include "core/arm/dyncom/arm_dyncom_trans.h"
 #include "core/arm/skyeye_common/armstate.h"
 #include "core/core.h"
 #include "core/core_timing.h"
@@ -69,12 +69,17 @@ private:
 };
 
 ARM_DynCom::ARM_DynCom(Core::System* system, Memory::MemorySystem& memory,
-                       PrivilegeMode initial_mode)
+                       PrivilegeMode initial_mode, std::size_t translation_cache_capacity)
     : system(system) {
-    state = std::make_unique<ARMul_State>(system, memory, initial_mode);
+    state = std::make_unique<ARMul_State>(system, memory, initial_mode,
+                                          translation_cache_capacity);
 }
 
-ARM_DynCom::~ARM_DynCom() {}
+ARM_DynCom::~ARM_DynCom() {
+    const InstructionCache& cache = state->instruction_cache;
+    LOG_INFO(Core_ARM11, "Translation cache of {} MiB flushed {} times",
+             cache.GetCapacity() >> 20, cache.GetFlushCount());
+}
 
 void ARM_DynCom::Run() {
     DEBUG_ASSERT(system != nullptr);
@@ -86,15 +91,15 @@ void ARM_DynCom::Step() {
 }
 
 void ARM_DynCom::ClearInstructionCache() {
-    state->instruction_cache.clear();
-    trans_cache_buf_top = 0;
+    state->instruction_cache.Clear();
 }
 
-void ARM_DynCom::InvalidateCacheRange(u32, std::size_t) {
-    ClearInstructionCache();
+void ARM_DynCom::InvalidateCacheRange(u32 start_address, std::size_t length) {
+    state->instruction_cache.InvalidateRange(start_address, length);
 }
 
 void ARM_DynCom::PageTableChanged() {
+    state->PageTableChanged();
     ClearInstructionCache();
 }
 
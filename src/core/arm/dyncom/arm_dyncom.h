@@ -20,8 +20,14 @@ class MemorySystem;
 
 class ARM_DynCom final : public ARM_Interface {
 public:
+    /**
+     * @param translation_cache_capacity Maximum size in bytes of the buffer holding the
+     *                                   translated instructions, flushed whenever it fills up
+     */
     explicit ARM_DynCom(Core::System* system, Memory::MemorySystem& memory,
-                        PrivilegeMode initial_mode);
+                        PrivilegeMode initial_mode,
+                        std::size_t translation_cache_capacity =
+                            InstructionCache::DEFAULT_CAPACITY);
     ~ARM_DynCom() override;
 
     void Run() override;
@@ -755,7 +755,8 @@ get_addr_fp_t GetAddressingOpLoadStoreT(unsigned int inst) {
 
 enum { FETCH_SUCCESS, FETCH_FAILURE };
 
-static ThumbDecodeStatus DecodeThumbInstruction(u32 inst, u32 addr, u32* arm_inst, u32* inst_size,
+static ThumbDecodeStatus DecodeThumbInstruction(InstructionCache& cache, u32 inst, u32 addr,
+                                                u32* arm_inst, u32* inst_size,
                                                 ARM_INST_PTR* ptr_inst_base) {
     // Check if in Thumb mode
     ThumbDecodeStatus ret = TranslateThumbInstruction(addr, inst, arm_inst, inst_size);
@@ -769,7 +770,7 @@ static ThumbDecodeStatus DecodeThumbInstruction(u32 inst, u32 addr, u32* arm_ins
         case 27:
             if (((tinstr & 0x0F00) != 0x0E00) && ((tinstr & 0x0F00) != 0x0F00)) {
                 inst_index = table_length - 4;
-                *ptr_inst_base = arm_instruction_trans[inst_index](tinstr, inst_index);
+                *ptr_inst_base = arm_instruction_trans[inst_index](cache, tinstr, inst_index);
             } else {
                 LOG_ERROR(Core_ARM11, "thumb decoder error");
             }
@@ -777,24 +778,24 @@ static ThumbDecodeStatus DecodeThumbInstruction(u32 inst, u32 addr, u32* arm_ins
         case 28:
             // Branch 2, unconditional branch
             inst_index = table_length - 5;
-            *ptr_inst_base = arm_instruction_trans[inst_index](tinstr, inst_index);
+            *ptr_inst_base = arm_instruction_trans[inst_index](cache, tinstr, inst_index);
             break;
 
         case 8:
         case 29:
             // For BLX 1 thumb instruction
             inst_index = table_length - 1;
-            *ptr_inst_base = arm_instruction_trans[inst_index](tinstr, inst_index);
+            *ptr_inst_base = arm_instruction_trans[inst_index](cache, tinstr, inst_index);
             break;
         case 30:
             // For BL 1 thumb instruction
             inst_index = table_length - 3;
-            *ptr_inst_base = arm_instruction_trans[inst_index](tinstr, inst_index);
+            *ptr_inst_base = arm_instruction_trans[inst_index](cache, tinstr, inst_index);
             break;
         case 31:
             // For BL 2 thumb instruction
             inst_index = table_length - 2;
-            *ptr_inst_base = arm_instruction_trans[inst_index](tinstr, inst_index);
+            *ptr_inst_base = arm_instruction_trans[inst_index](cache, tinstr, inst_index);
             break;
         default:
             ret = ThumbDecodeStatus::UNDEFINED;
@@ -808,7 +809,7 @@ enum { KEEP_GOING, FETCH_EXCEPTION };
 
 MICROPROFILE_DEFINE(DynCom_Decode, "DynCom", "Decode", MP_RGB(255, 64, 64));
 
-static unsigned int InterpreterTranslateInstruction(const ARMul_State* cpu, const u32 phys_addr,
+static unsigned int InterpreterTranslateInstruction(ARMul_State* cpu, const u32 phys_addr,
                                                     ARM_INST_PTR& inst_base) {
     u32 inst_size = 4;
     u32 inst = cpu->memory.Read32(phys_addr & 0xFFFFFFFC);
@@ -818,7 +819,8 @@ static unsigned int InterpreterTranslateInstruction(const ARMul_State* cpu, cons
     if (cpu->TFlag) {
         u32 arm_inst;
         ThumbDecodeStatus state =
-            DecodeThumbInstruction(inst, phys_addr, &arm_inst, &inst_size, &inst_base);
+            DecodeThumbInstruction(cpu->instruction_cache, inst, phys_addr, &arm_inst, &inst_size,
+                                   &inst_base);
 
         // We have translated the Thumb branch instruction in the Thumb decoder
         if (state == ThumbDecodeStatus::BRANCH) {
@@ -835,7 +837,7 @@ static unsigned int InterpreterTranslateInstruction(const ARMul_State* cpu, cons
                   cpu->Reg[15]);
         CITRA_IGNORE_EXIT(-1);
     }
-    inst_base = arm_instruction_trans[idx](inst, idx);
+    inst_base = arm_instruction_trans[idx](cpu->instruction_cache, inst, idx);
 
     return inst_size;
 }
@@ -850,7 +852,7 @@ static int InterpreterTranslateBlock(ARMul_State* cpu, std::size_t& bb_start, u3
     ARM_INST_PTR inst_base = nullptr;
     TransExtData ret = TransExtData::NON_BRANCH;
     int size = 0; // instruction size of basic block
-    bb_start = trans_cache_buf_top;
+    bb_start = cpu->instruction_cache.GetTranslationSize();
 
     u32 phys_addr = addr;
     u32 pc_start = cpu->Reg[15];
@@ -868,7 +870,7 @@ static int InterpreterTranslateBlock(ARMul_State* cpu, std::size_t& bb_start, u3
         ret = inst_base->br;
     };
 
-    cpu->instruction_cache[pc_start] = bb_start;
+    cpu->instruction_cache.Insert(pc_start, static_cast<u32>(bb_start));
 
     return KEEP_GOING;
 }
@@ -877,7 +879,7 @@ static int InterpreterTranslateSingle(ARMul_State* cpu, std::size_t& bb_start, u
     MICROPROFILE_SCOPE(DynCom_Decode);
 
     ARM_INST_PTR inst_base = nullptr;
-    bb_start = trans_cache_buf_top;
+    bb_start = cpu->instruction_cache.GetTranslationSize();
 
     u32 phys_addr = addr;
     u32 pc_start = cpu->Reg[15];
@@ -888,7 +890,7 @@ static int InterpreterTranslateSingle(ARMul_State* cpu, std::size_t& bb_start, u
         inst_base->br = TransExtData::SINGLE_STEP;
     }
 
-    cpu->instruction_cache[pc_start] = bb_start;
+    cpu->instruction_cache.Insert(pc_start, static_cast<u32>(bb_start));
 
     return KEEP_GOING;
 }
@@ -948,11 +950,25 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
 #define FETCH_INST                                                                                 \
     if (inst_base->br != TransExtData::NON_BRANCH)                                                 \
         goto DISPATCH;                                                                             \
-    inst_base = (arm_inst*)&trans_cache_buf[ptr]
+    inst_base = (arm_inst*)cpu->instruction_cache.GetTranslation(ptr)
 
 #define INC_PC(l) ptr += sizeof(arm_inst) + l
 #define INC_PC_STUB ptr += sizeof(arm_inst)
 
+// Continues a direct branch with the block at the new PC through the link cached in the branch
+// instruction, resolving the link on first use, instead of going back to the dispatcher. Links
+// only target blocks in the page of the branch, so invalidating that page also drops every block
+// linking into it, and flushing the translation cache discards the links along with the blocks.
+// The dispatcher still handles pending interrupts and debugger breakpoint lookups.
+#define CHAIN_BLOCK(link, branch_pc)                                                               \
+    if ((link) == InstructionCache::INVALID_OFFSET && (PC >> 12) == ((branch_pc) >> 12))           \
+        (link) = cpu->instruction_cache.Find(PC);                                                  \
+    if ((link) == InstructionCache::INVALID_OFFSET || !cpu->NirqSig || GDBStub::IsConnected())     \
+        goto DISPATCH;                                                                             \
+    ptr = (link);                                                                                  \
+    inst_base = (arm_inst*)cpu->instruction_cache.GetTranslation(ptr);                             \
+    GOTO_NEXT_INST
+
 #define GDB_BP_CHECK                                                                               \
     cpu->Cpsr &= ~(1 << 5);                                                                        \
     cpu->Cpsr |= cpu->TFlag << 5;                                                                  \
@@ -1641,15 +1657,19 @@ DISPATCH : {
         cpu->Reg[15] &= 0xfffffffc;
 
     // Find the cached instruction cream, otherwise translate it...
-    auto itr = cpu->instruction_cache.find(cpu->Reg[15]);
-    if (itr != cpu->instruction_cache.end()) {
-        ptr = itr->second;
-    } else if (cpu->NumInstrsToExecute != 1) {
-        if (InterpreterTranslateBlock(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
-            goto END;
+    if (const u32 offset = cpu->instruction_cache.Find(cpu->Reg[15]);
+        offset != InstructionCache::INVALID_OFFSET) {
+        ptr = offset;
     } else {
-        if (InterpreterTranslateSingle(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
-            goto END;
+        cpu->instruction_cache.ReserveBlock();
+
+        if (cpu->NumInstrsToExecute != 1) {
+            if (InterpreterTranslateBlock(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
+                goto END;
+        } else {
+            if (InterpreterTranslateSingle(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
+                goto END;
+        }
     }
 
     // Find breakpoint if one exists within the block
@@ -1658,7 +1678,7 @@ DISPATCH : {
             GDBStub::GetNextBreakpointFromAddress(cpu->Reg[15], GDBStub::BreakpointType::Execute);
     }
 
-    inst_base = (arm_inst*)&trans_cache_buf[ptr];
+    inst_base = (arm_inst*)cpu->instruction_cache.GetTranslation(ptr);
     GOTO_NEXT_INST;
 }
 ADC_INST : {
@@ -1761,18 +1781,17 @@ AND_INST : {
     GOTO_NEXT_INST;
 }
 BBL_INST : {
+    bbl_inst* inst_cream = (bbl_inst*)inst_base->component;
+    const u32 branch_pc = PC;
     if ((inst_base->cond == ConditionCode::AL) || CondPassed(cpu, inst_base->cond)) {
-        bbl_inst* inst_cream = (bbl_inst*)inst_base->component;
         if (inst_cream->L) {
             LINK_RTN_ADDR;
         }
         SET_PC;
-        INC_PC(sizeof(bbl_inst));
-        goto DISPATCH;
+        CHAIN_BLOCK(inst_cream->taken_link, branch_pc);
     }
     cpu->Reg[15] += cpu->GetInstructionSize();
-    INC_PC(sizeof(bbl_inst));
-    goto DISPATCH;
+    CHAIN_BLOCK(inst_cream->not_taken_link, branch_pc);
 }
 BIC_INST : {
     bic_inst* inst_cream = (bic_inst*)inst_base->component;
@@ -4321,20 +4340,21 @@ UMULL_INST : {
 }
 B_2_THUMB : {
     b_2_thumb* inst_cream = (b_2_thumb*)inst_base->component;
+    const u32 branch_pc = PC;
     cpu->Reg[15] = cpu->Reg[15] + 4 + inst_cream->imm;
-    INC_PC(sizeof(b_2_thumb));
-    goto DISPATCH;
+    CHAIN_BLOCK(inst_cream->taken_link, branch_pc);
 }
 B_COND_THUMB : {
     b_cond_thumb* inst_cream = (b_cond_thumb*)inst_base->component;
+    const u32 branch_pc = PC;
 
-    if (CondPassed(cpu, inst_cream->cond))
+    if (CondPassed(cpu, inst_cream->cond)) {
         cpu->Reg[15] = cpu->Reg[15] + 4 + inst_cream->imm;
-    else
-        cpu->Reg[15] += 2;
+        CHAIN_BLOCK(inst_cream->taken_link, branch_pc);
+    }
 
-    INC_PC(sizeof(b_cond_thumb));
-    goto DISPATCH;
+    cpu->Reg[15] += 2;
+    CHAIN_BLOCK(inst_cream->not_taken_link, branch_pc);
 }
 BL_1_THUMB : {
     bl_1_thumb* inst_cream = (bl_1_thumb*)inst_base->component;
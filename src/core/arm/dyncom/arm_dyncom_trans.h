@@ -8,6 +8,7 @@
 #include "common/common_types.h"
 
 struct ARMul_State;
+class InstructionCache;
 typedef unsigned int (*shtop_fp_t)(ARMul_State* cpu, unsigned int sht_oper);
 
 enum class TransExtData {
@@ -83,11 +84,15 @@ struct eor_inst {
     shtop_fp_t shtop_func;
 };
 
+// Direct branches cache the translation cache offsets of the blocks they continue with, see
+// CHAIN_BLOCK in the interpreter. The links are InstructionCache::INVALID_OFFSET until resolved.
 struct bbl_inst {
     unsigned int L;
     int signed_immed_24;
     unsigned int next_addr;
     unsigned int jmp_addr;
+    u32 taken_link;
+    u32 not_taken_link;
 };
 
 struct bx_inst {
@@ -451,10 +456,13 @@ struct setend_inst {
 
 struct b_2_thumb {
     unsigned int imm;
+    u32 taken_link;
 };
 struct b_cond_thumb {
     unsigned int imm;
     unsigned int cond;
+    u32 taken_link;
+    u32 not_taken_link;
 };
 
 struct bl_1_thumb {
@@ -488,11 +496,8 @@ struct ldst_inst {
 };
 
 typedef arm_inst* ARM_INST_PTR;
-typedef ARM_INST_PTR (*transop_fp_t)(unsigned int, int);
+/// Translates an instruction into the translation buffer of the given cache
+typedef ARM_INST_PTR (*transop_fp_t)(InstructionCache&, unsigned int, int);
 
 extern const transop_fp_t arm_instruction_trans[];
 extern const std::size_t arm_instruction_trans_len;
-
-#define TRANS_CACHE_SIZE (64 * 1024 * 2000)
-extern char trans_cache_buf[TRANS_CACHE_SIZE];
-extern std::size_t trans_cache_buf_top;
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cstring>
 #include "common/logging/log.h"
 #include "common/swap.h"
 #include "core/arm/skyeye_common/armstate.h"
@@ -11,8 +12,9 @@
 #include "core/memory.h"
 
 ARMul_State::ARMul_State(Core::System* system, Memory::MemorySystem& memory,
-                         PrivilegeMode initial_mode)
-    : system(system), memory(memory) {
+                         PrivilegeMode initial_mode, std::size_t translation_cache_capacity)
+    : system(system), memory(memory), instruction_cache(translation_cache_capacity) {
+    PageTableChanged();
     Reset();
     ChangePrivilegeMode(initial_mode);
 }
@@ -190,16 +192,64 @@ static void CheckMemoryBreakpoint(u32 address, GDBStub::BreakpointType type) {
     }
 }
 
+void ARMul_State::PageTableChanged() {
+    page_table = memory.GetCurrentPageTable();
+}
+
+template <typename T>
+T ARMul_State::ReadMemory(u32 address) const {
+    if (page_table) {
+        // Plain memory pages have a pointer, everything else needs the memory system's slow path
+        const u8* page_pointer = page_table->GetPointer(address >> Memory::PAGE_BITS);
+        if (page_pointer) {
+            T value;
+            std::memcpy(&value, &page_pointer[address & Memory::PAGE_MASK], sizeof(T));
+            return value;
+        }
+    }
+
+    if constexpr (sizeof(T) == 1) {
+        return memory.Read8(address);
+    } else if constexpr (sizeof(T) == 2) {
+        return memory.Read16(address);
+    } else if constexpr (sizeof(T) == 4) {
+        return memory.Read32(address);
+    } else {
+        return memory.Read64(address);
+    }
+}
+
+template <typename T>
+void ARMul_State::WriteMemory(u32 address, T data) {
+    if (page_table) {
+        u8* page_pointer = page_table->GetPointer(address >> Memory::PAGE_BITS);
+        if (page_pointer) {
+            std::memcpy(&page_pointer[address & Memory::PAGE_MASK], &data, sizeof(T));
+            return;
+        }
+    }
+
+    if constexpr (sizeof(T) == 1) {
+        memory.Write8(address, data);
+    } else if constexpr (sizeof(T) == 2) {
+        memory.Write16(address, data);
+    } else if constexpr (sizeof(T) == 4) {
+        memory.Write32(address, data);
+    } else {
+        memory.Write64(address, data);
+    }
+}
+
 u8 ARMul_State::ReadMemory8(u32 address) const {
     CheckMemoryBreakpoint(address, GDBStub::BreakpointType::Read);
 
-    return memory.Read8(address);
+    return ReadMemory<u8>(address);
 }
 
 u16 ARMul_State::ReadMemory16(u32 address) const {
     CheckMemoryBreakpoint(address, GDBStub::BreakpointType::Read);
 
-    u16 data = memory.Read16(address);
+    u16 data = ReadMemory<u16>(address);
 
     if (InBigEndianMode())
         data = Common::swap16(data);
@@ -210,7 +260,7 @@ u16 ARMul_State::ReadMemory16(u32 address) const {
 u32 ARMul_State::ReadMemory32(u32 address) const {
     CheckMemoryBreakpoint(address, GDBStub::BreakpointType::Read);
 
-    u32 data = memory.Read32(address);
+    u32 data = ReadMemory<u32>(address);
 
     if (InBigEndianMode())
         data = Common::swap32(data);
@@ -221,7 +271,7 @@ u32 ARMul_State::ReadMemory32(u32 address) const {
 u64 ARMul_State::ReadMemory64(u32 address) const {
     CheckMemoryBreakpoint(address, GDBStub::BreakpointType::Read);
 
-    u64 data = memory.Read64(address);
+    u64 data = ReadMemory<u64>(address);
 
     if (InBigEndianMode())
         data = Common::swap64(data);
@@ -232,7 +282,7 @@ u64 ARMul_State::ReadMemory64(u32 address) const {
 void ARMul_State::WriteMemory8(u32 address, u8 data) {
     CheckMemoryBreakpoint(address, GDBStub::BreakpointType::Write);
 
-    memory.Write8(address, data);
+    WriteMemory<u8>(address, data);
 }
 
 void ARMul_State::WriteMemory16(u32 address, u16 data) {
@@ -241,7 +291,7 @@ void ARMul_State::WriteMemory16(u32 address, u16 data) {
     if (InBigEndianMode())
         data = Common::swap16(data);
 
-    memory.Write16(address, data);
+    WriteMemory<u16>(address, data);
 }
 
 void ARMul_State::WriteMemory32(u32 address, u32 data) {
@@ -250,7 +300,7 @@ void ARMul_State::WriteMemory32(u32 address, u32 data) {
     if (InBigEndianMode())
         data = Common::swap32(data);
 
-    memory.Write32(address, data);
+    WriteMemory<u32>(address, data);
 }
 
 void ARMul_State::WriteMemory64(u32 address, u64 data) {
@@ -259,7 +309,7 @@ void ARMul_State::WriteMemory64(u32 address, u64 data) {
     if (InBigEndianMode())
         data = Common::swap64(data);
 
-    memory.Write64(address, data);
+    WriteMemory<u64>(address, data);
 }
 
 // Reads from the CP15 registers. Used with implementation of the MRC instruction.
@@ -18,9 +18,9 @@
 #pragma once
 
 #include <array>
-#include <unordered_map>
 #include "common/common_types.h"
 #include "core/arm/skyeye_common/arm_regformat.h"
+#include "core/arm/skyeye_common/instruction_cache.h"
 #include "core/gdbstub/gdbstub.h"
 
 namespace Core {
@@ -29,6 +29,7 @@ class System;
 
 namespace Memory {
 class MemorySystem;
+struct PageTable;
 }
 
 // Signal levels
@@ -148,7 +149,7 @@ enum {
 struct ARMul_State final {
 public:
     explicit ARMul_State(Core::System* system, Memory::MemorySystem& memory,
-                         PrivilegeMode initial_mode);
+                         PrivilegeMode initial_mode, std::size_t translation_cache_capacity);
 
     void ChangePrivilegeMode(u32 new_mode);
     void Reset();
@@ -206,6 +207,10 @@ public:
 
     void ServeBreak();
 
+    /// Updates the page table used for direct memory accesses, must be called whenever the memory
+    /// system switches page tables
+    void PageTableChanged();
+
     Core::System* system;
     Memory::MemorySystem& memory;
 
@@ -254,11 +259,20 @@ public:
 
     // TODO(bunnei): Move this cache to a better place - it should be per codeset (likely per
     // process for our purposes), not per ARMul_State (which tracks CPU core state).
-    std::unordered_map<u32, std::size_t> instruction_cache;
+    InstructionCache instruction_cache;
 
 private:
     void ResetMPCoreCP15Registers();
 
+    template <typename T>
+    T ReadMemory(u32 address) const;
+    template <typename T>
+    void WriteMemory(u32 address, T data);
+
+    /// Page table of the memory system, accesses to plain memory pages go through it directly
+    /// instead of calling into the memory system
+    const Memory::PageTable* page_table = nullptr;
+
     // Defines a reservation granule of 2 words, which protects the first 2 words starting at the
     // tag. This is the smallest granule allowed by the v7 spec, and is coincidentally just large
     // enough to support LDR/STREXD.
@@ -0,0 +1,95 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include "common/alignment.h"
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "core/arm/skyeye_common/instruction_cache.h"
+
+InstructionCache::InstructionCache(std::size_t capacity) : capacity(capacity) {
+    ASSERT(capacity >= MAX_BLOCK_TRANSLATION_SIZE);
+}
+
+InstructionCache::~InstructionCache() = default;
+
+void InstructionCache::Insert(u32 address, u32 offset) {
+    if (!pages) {
+        pages = std::make_unique<std::unique_ptr<Page>[]>(NUM_PAGES);
+    }
+
+    const u32 page_index = address >> PAGE_BITS;
+    auto& page = pages[page_index];
+    if (!page) {
+        page = std::make_unique<Page>();
+        page->fill(INVALID_OFFSET);
+        allocated_pages.push_back(page_index);
+    }
+
+    (*page)[(address & PAGE_MASK) >> INSTRUCTION_ALIGNMENT_BITS] = offset;
+}
+
+void InstructionCache::InvalidateRange(u32 start_address, std::size_t length) {
+    if (!pages || length == 0)
+        return;
+
+    const u32 first_page = start_address >> PAGE_BITS;
+    const u64 end_address = std::min<u64>(static_cast<u64>(start_address) + length, 1ULL << 32);
+    const u32 last_page = static_cast<u32>((end_address - 1) >> PAGE_BITS);
+    const auto end = std::remove_if(allocated_pages.begin(), allocated_pages.end(),
+                                    [&](u32 page_index) {
+                                        if (page_index < first_page || page_index > last_page)
+                                            return false;
+                                        pages[page_index].reset();
+                                        return true;
+                                    });
+    allocated_pages.erase(end, allocated_pages.end());
+}
+
+void InstructionCache::Clear() {
+    // The translation buffer keeps its allocation, it would most likely grow back to it anyway
+    buffer_top = 0;
+
+    if (!pages)
+        return;
+
+    for (const u32 page_index : allocated_pages) {
+        pages[page_index].reset();
+    }
+    allocated_pages.clear();
+}
+
+void InstructionCache::ReserveBlock() {
+    if (buffer_top + MAX_BLOCK_TRANSLATION_SIZE <= capacity)
+        return;
+
+    // Invalidating code only drops its lookup entries, so this also reclaims the space taken by
+    // the translations of invalidated blocks
+    ++flush_count;
+    LOG_DEBUG(Core_ARM11, "Translation cache reached its capacity of {} bytes, flushing ({} times)",
+              capacity, flush_count);
+    Clear();
+}
+
+void* InstructionCache::Allocate(std::size_t size) {
+    const std::size_t start = buffer_top;
+    buffer_top += size;
+    ASSERT_MSG(buffer_top <= capacity, "Translation cache is full!");
+
+    if (buffer_top > buffer_size) {
+        // Growing geometrically keeps the total amount of copying linear in the final size
+        const std::size_t new_size = std::min(
+            std::max(Common::AlignUp<std::size_t>(buffer_top, CHUNK_SIZE), buffer_size * 2),
+            capacity);
+        std::unique_ptr<char[]> new_buffer(new char[new_size]);
+        if (buffer) {
+            std::memcpy(new_buffer.get(), buffer.get(), start);
+        }
+        buffer = std::move(new_buffer);
+        buffer_size = new_size;
+    }
+
+    return buffer.get() + start;
+}
@@ -0,0 +1,118 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "common/common_types.h"
+
+/**
+ * Translation cache of the dyncom interpreter: holds the translated instructions and maps the guest
+ * addresses of translated basic blocks to their offset in it.
+ *
+ * Lookups go through a page-indexed table of per-page offset arrays, so resolving a block takes two
+ * loads. Translated blocks never cross a page boundary, which lets code writes invalidate the
+ * lookups page by page.
+ *
+ * The translation buffer is allocated on first use and doubles in size as needed, up to the
+ * capacity given on construction. Once the next block might not fit anymore, the whole cache is
+ * flushed.
+ */
+class InstructionCache {
+public:
+    /// Returned by Find when no block has been translated at the address
+    static constexpr u32 INVALID_OFFSET = 0xFFFFFFFF;
+
+    /// Default maximum size of the translation buffer
+    static constexpr std::size_t DEFAULT_CAPACITY = 128 * 1024 * 1024;
+
+    /// Initial size of the translation buffer, which then doubles whenever it runs out of space
+    static constexpr std::size_t CHUNK_SIZE = 4 * 1024 * 1024;
+
+    /// Upper bound of the space taken by the translation of one block. Blocks end at page
+    /// boundaries, so they hold at most 2048 (Thumb) instructions.
+    static constexpr std::size_t MAX_BLOCK_TRANSLATION_SIZE = 2048 * 256;
+
+    explicit InstructionCache(std::size_t capacity = DEFAULT_CAPACITY);
+    ~InstructionCache();
+
+    /// Returns the translation buffer offset of the block starting at the address, or
+    /// INVALID_OFFSET if there is none
+    u32 Find(u32 address) const {
+        if (!pages)
+            return INVALID_OFFSET;
+
+        const Page* page = pages[address >> PAGE_BITS].get();
+        if (!page)
+            return INVALID_OFFSET;
+
+        return (*page)[(address & PAGE_MASK) >> INSTRUCTION_ALIGNMENT_BITS];
+    }
+
+    /// Records the translation buffer offset of the block starting at the address
+    void Insert(u32 address, u32 offset);
+
+    /// Forgets the blocks in every page overlapping the given range
+    void InvalidateRange(u32 start_address, std::size_t length);
+
+    /// Forgets all blocks and discards their translations
+    void Clear();
+
+    /// Flushes the cache if it might not have room to translate another block. Must be called
+    /// before translating a block, as a flush discards the translations being executed.
+    void ReserveBlock();
+
+    /**
+     * Allocates space for a translated instruction at the end of the translation buffer. This may
+     * move the buffer, so pointers obtained before become invalid; offsets stay valid.
+     * @returns Pointer to the allocated space
+     */
+    void* Allocate(std::size_t size);
+
+    /// Returns the translation at the given offset of the translation buffer
+    void* GetTranslation(std::size_t offset) const {
+        return buffer.get() + offset;
+    }
+
+    /// Returns the offset at which the next translation will be allocated
+    std::size_t GetTranslationSize() const {
+        return buffer_top;
+    }
+
+    std::size_t GetCapacity() const {
+        return capacity;
+    }
+
+    /// Returns how many times the cache was flushed because it reached its capacity
+    u64 GetFlushCount() const {
+        return flush_count;
+    }
+
+private:
+    /// Translated blocks end at the boundaries of pages of this size
+    static constexpr u32 PAGE_BITS = 12;
+    static constexpr u32 PAGE_MASK = (1 << PAGE_BITS) - 1;
+    static constexpr std::size_t NUM_PAGES = 1 << (32 - PAGE_BITS);
+    /// Thumb instructions are halfword aligned, so blocks can start at any even address
+    static constexpr u32 INSTRUCTION_ALIGNMENT_BITS = 1;
+    static constexpr std::size_t ENTRIES_PER_PAGE = (1 << PAGE_BITS) >> INSTRUCTION_ALIGNMENT_BITS;
+
+    using Page = std::array<u32, ENTRIES_PER_PAGE>;
+
+    /// Page table covering the whole address space, allocated on the first insertion
+    std::unique_ptr<std::unique_ptr<Page>[]> pages;
+    /// Indices of the pages that currently have an offset array
+    std::vector<u32> allocated_pages;
+
+    std::unique_ptr<char[]> buffer;
+    /// Allocated size of the translation buffer
+    std::size_t buffer_size = 0;
+    /// Used size of the translation buffer
+    std::size_t buffer_top = 0;
+    const std::size_t capacity;
+    u64 flush_count = 0;
+};
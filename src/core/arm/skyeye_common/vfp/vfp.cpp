@@ -27,6 +27,12 @@
 #include "core/arm/skyeye_common/vfp/asm_vfp.h"
 #include "core/arm/skyeye_common/vfp/vfp.h"
 
+bool vfp_host_fast_path_enabled = true;
+
+void VFPSetHostFastPath(bool enabled) {
+    vfp_host_fast_path_enabled = enabled;
+}
+
 void VFPInit(ARMul_State* state) {
     state->VFP[VFP_FPSID] = VFP_FPSID_IMPLMEN << 24 | VFP_FPSID_SW << 23 | VFP_FPSID_SUBARCH << 16 |
                             VFP_FPSID_PARTNUM << 8 | VFP_FPSID_VARIANT << 4 | VFP_FPSID_REVISION;
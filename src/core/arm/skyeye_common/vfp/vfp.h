@@ -28,6 +28,12 @@
 
 void VFPInit(ARMul_State* state);
 
+/**
+ * Enables or disables computing VFP arithmetic on the host FPU when the FPSCR mode and the operands
+ * allow it to match the software implementation bit for bit. Enabled by default.
+ */
+void VFPSetHostFastPath(bool enabled);
+
 s32 vfp_get_float(ARMul_State* state, u32 reg);
 void vfp_put_float(ARMul_State* state, s32 val, u32 reg);
 u64 vfp_get_double(ARMul_State* state, u32 reg);
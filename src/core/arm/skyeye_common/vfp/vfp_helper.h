@@ -423,3 +423,19 @@ u32 vfp_double_multiply(vfp_double* vdd, vfp_double* vdn, vfp_double* vdm, u32 f
 u32 vfp_double_add(vfp_double* vdd, vfp_double* vdn, vfp_double* vdm, u32 fpscr);
 u32 vfp_double_normaliseround(ARMul_State* state, int dd, vfp_double* vd, u32 fpscr, u32 exceptions,
                               const char* func);
+
+// Whether arithmetic may be done on the host FPU, see VFPSetHostFastPath
+extern bool vfp_host_fast_path_enabled;
+
+/*
+ * The host FPU rounds to nearest, and its results can be truncated towards zero afterwards.
+ * Flush-to-zero and default NaN mode make no difference, since the fast path leaves denormals and
+ * NaNs to the software implementation.
+ */
+inline bool vfp_host_fast_path_usable(u32 fpscr) {
+    constexpr u32 trap_enables =
+        FPSCR_IDE | FPSCR_IXE | FPSCR_UFE | FPSCR_OFE | FPSCR_DZE | FPSCR_IOE;
+    const u32 rmode = fpscr & FPSCR_RMODE_MASK;
+    return vfp_host_fast_path_enabled && (fpscr & trap_enables) == 0 &&
+           (rmode == FPSCR_ROUND_NEAREST || rmode == FPSCR_ROUND_TOZERO);
+}
@@ -52,6 +52,8 @@
  */
 
 #include <algorithm>
+#include <cmath>
+#include <cstring>
 #include "common/logging/log.h"
 #include "core/arm/skyeye_common/vfp/asm_vfp.h"
 #include "core/arm/skyeye_common/vfp/vfp.h"
@@ -962,6 +964,87 @@ static u32 vfp_double_fnmsc(ARMul_State* state, int dd, int dn, int dm, u32 fpsc
                                           "fnmsc");
 }
 
+/*
+ * Host FPU fast path for fadd, fsub, fmul and fdiv, see vfp_single_host_op.
+ *
+ * The error terms are computed with fused multiply-adds, which are only exact as long as they
+ * don't underflow themselves. Products and quotients with tiny magnitudes are therefore left to
+ * the software implementation as well.
+ *
+ * Returns false if the software implementation has to be used.
+ */
+static bool vfp_double_host_op(u32 fop, s64 n, s64 m, u32 fpscr, s64* result, u32* exceptions) {
+    // Smallest biased exponent of a product or dividend for which the error terms can't underflow
+    constexpr u64 min_exact_error_exponent = 64;
+
+    if (!vfp_host_fast_path_usable(fpscr))
+        return false;
+
+    const auto exponent_of = [](u64 val) { return (val >> 52) & 0x7ff; };
+    const auto is_normal_or_zero = [&](u64 val) {
+        const u64 exponent = exponent_of(val);
+        return exponent != 2047 && (exponent != 0 || (val & 0xfffffffffffffULL) == 0);
+    };
+    if (!is_normal_or_zero(n) || !is_normal_or_zero(m))
+        return false;
+
+    double a, b, d;
+    std::memcpy(&a, &n, sizeof(a));
+    std::memcpy(&b, &m, sizeof(b));
+
+    // Sign of the exact result minus d
+    int error;
+    switch (fop) {
+    case FOP_FADD:
+    case FOP_FSUB: {
+        if (fop == FOP_FSUB)
+            b = -b;
+        // 2Sum: d + err == a + b exactly
+        d = a + b;
+        const double b_virtual = d - a;
+        const double a_virtual = d - b_virtual;
+        const double err = (a - a_virtual) + (b - b_virtual);
+        error = (err > 0) - (err < 0);
+        break;
+    }
+    case FOP_FMUL: {
+        if (exponent_of(n) + exponent_of(m) < 1023 + min_exact_error_exponent)
+            return false;
+        d = a * b;
+        const double err = std::fma(a, b, -d);
+        error = (err > 0) - (err < 0);
+        break;
+    }
+    case FOP_FDIV: {
+        if (exponent_of(n) < min_exact_error_exponent)
+            return false;
+        d = a / b;
+        const double remainder = std::fma(-d, b, a);
+        error = ((remainder > 0) - (remainder < 0)) * (b > 0 ? 1 : -1);
+        break;
+    }
+    default:
+        return false;
+    }
+
+    u64 bits;
+    std::memcpy(&bits, &d, sizeof(bits));
+    if (exponent_of(bits) == 2047)
+        return false;
+
+    // Moving the encoding one step towards zero truncates a result that was rounded away from it
+    const bool negative = (bits & 0x8000000000000000ULL) != 0;
+    if ((fpscr & FPSCR_RMODE_MASK) == FPSCR_ROUND_TOZERO && error == (negative ? 1 : -1))
+        bits--;
+
+    if (exponent_of(bits) <= 1)
+        return false;
+
+    *result = bits;
+    *exceptions = error != 0 ? FPSCR_IXC : 0;
+    return true;
+}
+
 /*
  * sd = sn * sm
  */
@@ -970,6 +1053,14 @@ static u32 vfp_double_fmul(ARMul_State* state, int dd, int dn, int dm, u32 fpscr
     u32 exceptions = 0;
 
     LOG_TRACE(Core_ARM11, "In {}", __FUNCTION__);
+
+    s64 result;
+    if (vfp_double_host_op(FOP_FMUL, vfp_get_double(state, dn), vfp_get_double(state, dm), fpscr,
+                           &result, &exceptions)) {
+        vfp_put_double(state, result, dd);
+        return exceptions;
+    }
+
     exceptions |= vfp_double_unpack(&vdn, vfp_get_double(state, dn), fpscr);
     if (vdn.exponent == 0 && vdn.significand)
         vfp_double_normalise_denormal(&vdn);
@@ -1012,6 +1103,14 @@ static u32 vfp_double_fadd(ARMul_State* state, int dd, int dn, int dm, u32 fpscr
     u32 exceptions = 0;
 
     LOG_TRACE(Core_ARM11, "In {}", __FUNCTION__);
+
+    s64 result;
+    if (vfp_double_host_op(FOP_FADD, vfp_get_double(state, dn), vfp_get_double(state, dm), fpscr,
+                           &result, &exceptions)) {
+        vfp_put_double(state, result, dd);
+        return exceptions;
+    }
+
     exceptions |= vfp_double_unpack(&vdn, vfp_get_double(state, dn), fpscr);
     if (vdn.exponent == 0 && vdn.significand)
         vfp_double_normalise_denormal(&vdn);
@@ -1033,6 +1132,14 @@ static u32 vfp_double_fsub(ARMul_State* state, int dd, int dn, int dm, u32 fpscr
     u32 exceptions = 0;
 
     LOG_TRACE(Core_ARM11, "In {}", __FUNCTION__);
+
+    s64 result;
+    if (vfp_double_host_op(FOP_FSUB, vfp_get_double(state, dn), vfp_get_double(state, dm), fpscr,
+                           &result, &exceptions)) {
+        vfp_put_double(state, result, dd);
+        return exceptions;
+    }
+
     exceptions |= vfp_double_unpack(&vdn, vfp_get_double(state, dn), fpscr);
     if (vdn.exponent == 0 && vdn.significand)
         vfp_double_normalise_denormal(&vdn);
@@ -1060,6 +1167,14 @@ static u32 vfp_double_fdiv(ARMul_State* state, int dd, int dn, int dm, u32 fpscr
     int tm, tn;
 
     LOG_TRACE(Core_ARM11, "In {}", __FUNCTION__);
+
+    s64 result;
+    if (vfp_double_host_op(FOP_FDIV, vfp_get_double(state, dn), vfp_get_double(state, dm), fpscr,
+                           &result, &exceptions)) {
+        vfp_put_double(state, result, dd);
+        return exceptions;
+    }
+
     exceptions |= vfp_double_unpack(&vdn, vfp_get_double(state, dn), fpscr);
     exceptions |= vfp_double_unpack(&vdm, vfp_get_double(state, dm), fpscr);
 
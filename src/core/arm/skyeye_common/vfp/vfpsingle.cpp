@@ -52,6 +52,7 @@
  */
 
 #include <algorithm>
+#include <cstring>
 #include "common/common_funcs.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
@@ -986,6 +987,80 @@ static u32 vfp_single_fnmsc(ARMul_State* state, int sd, int sn, s32 m, u32 fpscr
                                           "fnmsc");
 }
 
+/*
+ * Host FPU fast path for fadd, fmul and fdiv.
+ *
+ * The operation is only done on the host when both operands are normal numbers or zeroes and the
+ * result is a normal number above the smallest one, so that overflow, underflow, NaN propagation
+ * and denormal handling all stay with the software implementation. The error of the host result
+ * is recovered exactly, which gives the inexact flag and the direction to truncate to when
+ * rounding towards zero.
+ *
+ * Returns false if the software implementation has to be used.
+ */
+static bool vfp_single_host_op(u32 fop, s32 n, s32 m, u32 fpscr, s32* result, u32* exceptions) {
+    if (!vfp_host_fast_path_usable(fpscr))
+        return false;
+
+    const auto is_normal_or_zero = [](u32 val) {
+        const u32 exponent = (val >> 23) & 0xff;
+        return exponent != 255 && (exponent != 0 || (val & 0x7fffff) == 0);
+    };
+    if (!is_normal_or_zero(n) || !is_normal_or_zero(m))
+        return false;
+
+    float a, b, d;
+    std::memcpy(&a, &n, sizeof(a));
+    std::memcpy(&b, &m, sizeof(b));
+
+    // Sign of the exact result minus d
+    int error;
+    switch (fop) {
+    case FOP_FADD: {
+        // 2Sum: d + err == a + b exactly
+        d = a + b;
+        const float b_virtual = d - a;
+        const float a_virtual = d - b_virtual;
+        const float err = (a - a_virtual) + (b - b_virtual);
+        error = (err > 0) - (err < 0);
+        break;
+    }
+    case FOP_FMUL: {
+        // The product of two 24-bit significands is exact in double precision
+        const double product = static_cast<double>(a) * b;
+        d = static_cast<float>(product);
+        error = (product > d) - (product < d);
+        break;
+    }
+    case FOP_FDIV: {
+        // d * b is exact in double precision and close enough to a for the subtraction to be exact
+        d = a / b;
+        const double remainder = a - static_cast<double>(d) * b;
+        error = ((remainder > 0) - (remainder < 0)) * (b > 0 ? 1 : -1);
+        break;
+    }
+    default:
+        return false;
+    }
+
+    u32 bits;
+    std::memcpy(&bits, &d, sizeof(bits));
+    if (((bits >> 23) & 0xff) == 255)
+        return false;
+
+    // Moving the encoding one step towards zero truncates a result that was rounded away from it
+    const bool negative = (bits & 0x80000000) != 0;
+    if ((fpscr & FPSCR_RMODE_MASK) == FPSCR_ROUND_TOZERO && error == (negative ? 1 : -1))
+        bits--;
+
+    if (((bits >> 23) & 0xff) <= 1)
+        return false;
+
+    *result = bits;
+    *exceptions = error != 0 ? FPSCR_IXC : 0;
+    return true;
+}
+
 /*
  * sd = sn * sm
  */
@@ -996,6 +1071,12 @@ static u32 vfp_single_fmul(ARMul_State* state, int sd, int sn, s32 m, u32 fpscr)
 
     LOG_TRACE(Core_ARM11, "s{} = {:08x}", sn, n);
 
+    s32 result;
+    if (vfp_single_host_op(FOP_FMUL, n, m, fpscr, &result, &exceptions)) {
+        vfp_put_float(state, result, sd);
+        return exceptions;
+    }
+
     exceptions |= vfp_single_unpack(&vsn, n, fpscr);
     if (vsn.exponent == 0 && vsn.significand)
         vfp_single_normalise_denormal(&vsn);
@@ -1041,6 +1122,12 @@ static u32 vfp_single_fadd(ARMul_State* state, int sd, int sn, s32 m, u32 fpscr)
 
     LOG_TRACE(Core_ARM11, "s{} = {:08x}", sn, n);
 
+    s32 result;
+    if (vfp_single_host_op(FOP_FADD, n, m, fpscr, &result, &exceptions)) {
+        vfp_put_float(state, result, sd);
+        return exceptions;
+    }
+
     /*
      * Unpack and normalise denormals.
      */
@@ -1092,6 +1179,12 @@ static u32 vfp_single_fdiv(ARMul_State* state, int sd, int sn, s32 m, u32 fpscr)
 
     LOG_TRACE(Core_ARM11, "s{} = {:08x}", sn, n);
 
+    s32 result;
+    if (vfp_single_host_op(FOP_FDIV, n, m, fpscr, &result, &exceptions)) {
+        vfp_put_float(state, result, sd);
+        return exceptions;
+    }
+
     exceptions |= vfp_single_unpack(&vsn, n, fpscr);
     exceptions |= vfp_single_unpack(&vsm, m, fpscr);
 
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <memory>
 #include <thread>
 #include <utility>
@@ -17,6 +18,10 @@
 #include "core/cheats/cheats.h"
 #include "core/core.h"
 #include "core/core_timing.h"
+#include "core/dumping/backend.h"
+#ifdef ENABLE_FFMPEG_VIDEO_DUMPER
+#include "core/dumping/ffmpeg_backend.h"
+#endif
 #include "core/gdbstub/gdbstub.h"
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/kernel.h"
@@ -58,6 +63,9 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
         }
     }
 
+    // Rasterizer cache marks made by the GPU thread take effect between two slices
+    memory->ApplyPendingRasterizerMarks();
+
     // If we don't have a currently active thread then don't execute instructions,
     // instead advance to the next event and try to yield to the next thread
     if (kernel->GetThreadManager().GetCurrentThread() == nullptr) {
@@ -179,15 +187,20 @@ System::ResultStatus System::Init(Frontend::EmuWindow& emu_window, u32 system_mo
     kernel = std::make_unique<Kernel::KernelSystem>(*memory, *timing,
                                                     [this] { PrepareReschedule(); }, system_mode);
 
+    // A block translation can take up to half a MiB, the cache must hold at least one
+    const std::size_t translation_cache_capacity =
+        std::max<std::size_t>(Settings::values.dyncom_cache_size, 1) << 20;
     if (Settings::values.use_cpu_jit) {
 #ifdef ARCHITECTURE_x86_64
         cpu_core = std::make_unique<ARM_Dynarmic>(this, *memory, USER32MODE);
 #else
-        cpu_core = std::make_unique<ARM_DynCom>(this, *memory, USER32MODE);
+        cpu_core = std::make_unique<ARM_DynCom>(this, *memory, USER32MODE,
+                                                translation_cache_capacity);
         LOG_WARNING(Core, "CPU JIT requested, but Dynarmic not available");
 #endif
     } else {
-        cpu_core = std::make_unique<ARM_DynCom>(this, *memory, USER32MODE);
+        cpu_core =
+            std::make_unique<ARM_DynCom>(this, *memory, USER32MODE, translation_cache_capacity);
     }
 
     kernel->GetThreadManager().SetCPU(*cpu_core);
@@ -202,6 +215,12 @@ System::ResultStatus System::Init(Frontend::EmuWindow& emu_window, u32 system_mo
 
     memory->SetDSP(*dsp_core);
 
+#ifdef ENABLE_FFMPEG_VIDEO_DUMPER
+    video_dumper = std::make_unique<VideoDumper::FFmpegBackend>();
+#else
+    video_dumper = std::make_unique<VideoDumper::NullBackend>();
+#endif
+
     dsp_core->SetSink(Settings::values.sink_id, Settings::values.audio_device_id);
     dsp_core->EnableStretching(Settings::values.enable_audio_stretching);
 
@@ -262,6 +281,10 @@ const Timing& System::CoreTiming() const {
     return *timing;
 }
 
+VideoDumper::Backend& System::VideoDumper() {
+    return *video_dumper;
+}
+
 Memory::MemorySystem& System::Memory() {
     return *memory;
 }
@@ -299,12 +322,14 @@ void System::Shutdown() {
     // Shutdown emulation session
     GDBStub::Shutdown();
     VideoCore::Shutdown();
+    video_dumper->StopDumping();
     HW::Shutdown();
     telemetry_session.reset();
     rpc_server.reset();
     cheat_engine.reset();
     service_manager.reset();
     dsp_core.reset();
+    video_dumper.reset();
     cpu_core.reset();
     kernel.reset();
     timing.reset();
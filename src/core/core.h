@@ -32,6 +32,10 @@ namespace RPC {
 class RPCServer;
 }
 
+namespace VideoDumper {
+class Backend;
+}
+
 namespace Service {
 namespace SM {
 class ServiceManager;
@@ -194,6 +198,9 @@ public:
     /// Gets a const reference to the timing system
     const Timing& CoreTiming() const;
 
+    /// Gets a reference to the video dumper backend
+    VideoDumper::Backend& VideoDumper();
+
     /// Gets a reference to the memory system
     Memory::MemorySystem& Memory();
 
@@ -279,6 +286,9 @@ private:
     /// RPC Server for scripting support
     std::unique_ptr<RPC::RPCServer> rpc_server;
 
+    /// Video and audio dumper
+    std::unique_ptr<VideoDumper::Backend> video_dumper;
+
     std::unique_ptr<Service::FS::ArchiveManager> archive_manager;
 
     std::unique_ptr<Memory::MemorySystem> memory;
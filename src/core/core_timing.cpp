@@ -12,10 +12,6 @@
 namespace Core {
 
 // Sort by time, unless the times are the same, in which case sort by the order added to the queue
-bool Timing::Event::operator>(const Event& right) const {
-    return std::tie(time, fifo_order) > std::tie(right.time, right.fifo_order);
-}
-
 bool Timing::Event::operator<(const Event& right) const {
     return std::tie(time, fifo_order) < std::tie(right.time, right.fifo_order);
 }
@@ -28,9 +24,10 @@ TimingEventType* Timing::RegisterEvent(const std::string& name, TimedCallback ca
                "during Init to avoid breaking save states.",
                name);
 
-    auto info = event_types.emplace(name, TimingEventType{callback, nullptr});
+    auto info = event_types.emplace(name, TimingEventType{callback, nullptr, type_events.size()});
     TimingEventType* event_type = &info.first->second;
     event_type->name = &info.first->first;
+    type_events.emplace_back();
     return event_type;
 }
 
@@ -63,8 +60,7 @@ void Timing::ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_
     if (!is_global_timer_sane)
         ForceExceptionCheck(cycles_into_future);
 
-    event_queue.emplace_back(Event{timeout, event_fifo_id++, userdata, event_type});
-    std::push_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+    PushEvent(Event{timeout, event_fifo_id++, userdata, event_type});
 }
 
 void Timing::ScheduleEventThreadsafe(s64 cycles_into_future, const TimingEventType* event_type,
@@ -73,25 +69,16 @@ void Timing::ScheduleEventThreadsafe(s64 cycles_into_future, const TimingEventTy
 }
 
 void Timing::UnscheduleEvent(const TimingEventType* event_type, u64 userdata) {
-    auto itr = std::remove_if(event_queue.begin(), event_queue.end(), [&](const Event& e) {
-        return e.type == event_type && e.userdata == userdata;
-    });
-
-    // Removing random items breaks the invariant so we have to re-establish it.
-    if (itr != event_queue.end()) {
-        event_queue.erase(itr, event_queue.end());
-        std::make_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+    const auto& positions = type_events[event_type->index];
+    for (auto it = positions.find(userdata); it != positions.end(); it = positions.find(userdata)) {
+        RemoveEventAt(it->second);
     }
 }
 
 void Timing::RemoveEvent(const TimingEventType* event_type) {
-    auto itr = std::remove_if(event_queue.begin(), event_queue.end(),
-                              [&](const Event& e) { return e.type == event_type; });
-
-    // Removing random items breaks the invariant so we have to re-establish it.
-    if (itr != event_queue.end()) {
-        event_queue.erase(itr, event_queue.end());
-        std::make_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+    const auto& positions = type_events[event_type->index];
+    while (!positions.empty()) {
+        RemoveEventAt(positions.begin()->second);
     }
 }
 
@@ -111,8 +98,7 @@ void Timing::ForceExceptionCheck(s64 cycles) {
 void Timing::MoveEvents() {
     for (Event ev; ts_queue.Pop(ev);) {
         ev.fifo_order = event_fifo_id++;
-        event_queue.emplace_back(std::move(ev));
-        std::push_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+        PushEvent(ev);
     }
 }
 
@@ -126,9 +112,8 @@ void Timing::Advance() {
     is_global_timer_sane = true;
 
     while (!event_queue.empty() && event_queue.front().time <= global_timer) {
-        Event evt = std::move(event_queue.front());
-        std::pop_heap(event_queue.begin(), event_queue.end(), std::greater<>());
-        event_queue.pop_back();
+        const Event evt = event_queue.front();
+        RemoveEventAt(0);
         evt.type->callback(evt.userdata, global_timer - evt.time);
     }
 
@@ -143,6 +128,76 @@ void Timing::Advance() {
     downcount = slice_length;
 }
 
+void Timing::PushEvent(const Event& event) {
+    auto& positions = type_events[event.type->index];
+    event_queue.push_back(event);
+    // Elements of unordered containers keep their address when the container rehashes
+    event_queue.back().position =
+        &positions.emplace(event.userdata, event_queue.size() - 1)->second;
+    SiftUp(event_queue.size() - 1);
+}
+
+void Timing::RemoveEventAt(std::size_t index) {
+    const Event& event = event_queue[index];
+
+    // Several events of a type can share their userdata, look for the entry of this one
+    auto& positions = type_events[event.type->index];
+    const auto range = positions.equal_range(event.userdata);
+    const auto entry = std::find_if(range.first, range.second, [&event](const auto& candidate) {
+        return &candidate.second == event.position;
+    });
+    ASSERT(entry != range.second);
+    positions.erase(entry);
+
+    // Fill the hole with the last event of the heap and restore the heap order around it
+    const std::size_t last_index = event_queue.size() - 1;
+    if (index != last_index) {
+        PlaceEvent(index, event_queue[last_index]);
+        event_queue.pop_back();
+        if (index > 0 && event_queue[index] < event_queue[(index - 1) / 2]) {
+            SiftUp(index);
+        } else {
+            SiftDown(index);
+        }
+    } else {
+        event_queue.pop_back();
+    }
+}
+
+void Timing::PlaceEvent(std::size_t index, const Event& event) {
+    *event.position = index;
+    event_queue[index] = event;
+}
+
+void Timing::SiftUp(std::size_t index) {
+    const Event event = event_queue[index];
+    while (index > 0) {
+        const std::size_t parent = (index - 1) / 2;
+        if (!(event < event_queue[parent]))
+            break;
+        PlaceEvent(index, event_queue[parent]);
+        index = parent;
+    }
+    PlaceEvent(index, event);
+}
+
+void Timing::SiftDown(std::size_t index) {
+    const Event event = event_queue[index];
+    const std::size_t size = event_queue.size();
+    while (true) {
+        std::size_t child = 2 * index + 1;
+        if (child >= size)
+            break;
+        if (child + 1 < size && event_queue[child + 1] < event_queue[child])
+            ++child;
+        if (!(event_queue[child] < event))
+            break;
+        PlaceEvent(index, event_queue[child]);
+        index = child;
+    }
+    PlaceEvent(index, event);
+}
+
 void Timing::Idle() {
     idled_cycles += downcount;
     downcount = 0;
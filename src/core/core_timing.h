@@ -18,6 +18,7 @@
  */
 
 #include <chrono>
+#include <cstddef>
 #include <functional>
 #include <limits>
 #include <string>
@@ -130,6 +131,8 @@ using TimedCallback = std::function<void(u64 userdata, int cycles_late)>;
 struct TimingEventType {
     TimedCallback callback;
     const std::string* name;
+    /// Index of the scheduled events of this type in its Timing
+    std::size_t index;
 };
 
 class Timing {
@@ -195,11 +198,21 @@ private:
         u64 fifo_order;
         u64 userdata;
         const TimingEventType* type;
+        /// Entry of the event in the index of its type, which holds its position in the queue
+        std::size_t* position = nullptr;
 
-        bool operator>(const Event& right) const;
         bool operator<(const Event& right) const;
     };
 
+    /// Adds an event to the queue, its fifo_order must be set
+    void PushEvent(const Event& event);
+    /// Removes the event at the given position of the queue
+    void RemoveEventAt(std::size_t index);
+    /// Stores an event at the given position of the queue and records that position
+    void PlaceEvent(std::size_t index, const Event& event);
+    void SiftUp(std::size_t index);
+    void SiftDown(std::size_t index);
+
     static constexpr int MAX_SLICE_LENGTH = 20000;
 
     s64 global_timer = 0;
@@ -210,11 +223,14 @@ private:
     // elements remain stable regardless of rehashes/resizing.
     std::unordered_map<std::string, TimingEventType> event_types;
 
-    // The queue is a min-heap using std::make_heap/push_heap/pop_heap.
-    // We don't use std::priority_queue because we need to be able to serialize, unserialize and
-    // erase arbitrary events (RemoveEvent()) regardless of the queue order. These aren't
-    // accomodated by the standard adaptor class.
+    // The queue is a binary min-heap that keeps track of where each event is stored, so that
+    // arbitrary events can be erased (RemoveEvent()) by sifting a single element instead of
+    // rebuilding the heap. We don't use std::priority_queue because we also need to be able to
+    // serialize and unserialize the queue regardless of its order.
     std::vector<Event> event_queue;
+    // Positions in event_queue of the scheduled events of each type, keyed by their userdata so
+    // that UnscheduleEvent() finds them directly. Indexed by TimingEventType::index.
+    std::vector<std::unordered_multimap<u64, std::size_t>> type_events;
     u64 event_fifo_id = 0;
     // the queue for storing the events from other threads threadsafe until they will be added
     // to the event_queue by the emu thread
@@ -0,0 +1,127 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <utility>
+#include "common/assert.h"
+#include "core/dirty_page_tracker.h"
+#include "core/memory.h"
+
+namespace Memory {
+
+namespace {
+constexpr std::size_t VRAM_PAGES = VRAM_SIZE >> PAGE_BITS;
+constexpr std::size_t NUM_PAGES = VRAM_PAGES + (FCRAM_N3DS_SIZE >> PAGE_BITS);
+} // namespace
+
+DirtyPageTracker::DirtyPageTracker(const u8* fcram, const u8* vram,
+                                   std::function<void()> on_new_epoch)
+    : fcram(fcram), vram(vram), on_new_epoch(std::move(on_new_epoch)),
+      page_epochs(std::make_unique<u32[]>(NUM_PAGES)),
+      group_epochs(std::make_unique<u32[]>(NUM_PAGES / PAGES_PER_GROUP)) {
+    static_assert(NUM_PAGES % PAGES_PER_GROUP == 0);
+}
+
+DirtyPageTracker::~DirtyPageTracker() = default;
+
+DirtyPageTracker::Cursor DirtyPageTracker::CreateCursor() {
+    // Writes recorded so far belong to older epochs than the new cursor
+    return NextEpoch();
+}
+
+void DirtyPageTracker::MarkDirty(const u8* pointer, std::size_t size) {
+    if (size == 0)
+        return;
+
+    if (pointer >= fcram && pointer < fcram + FCRAM_N3DS_SIZE) {
+        const std::size_t offset = pointer - fcram;
+        const std::size_t end = std::min<std::size_t>(offset + size, FCRAM_N3DS_SIZE);
+        MarkPages(VRAM_PAGES + (offset >> PAGE_BITS), VRAM_PAGES + ((end - 1) >> PAGE_BITS) + 1);
+    } else if (pointer >= vram && pointer < vram + VRAM_SIZE) {
+        const std::size_t offset = pointer - vram;
+        const std::size_t end = std::min<std::size_t>(offset + size, VRAM_SIZE);
+        MarkPages(offset >> PAGE_BITS, ((end - 1) >> PAGE_BITS) + 1);
+    }
+}
+
+void DirtyPageTracker::MarkDirty(PAddr addr, u32 size) {
+    if (addr >= FCRAM_PADDR && addr < FCRAM_N3DS_PADDR_END) {
+        MarkDirty(fcram + (addr - FCRAM_PADDR), size);
+    } else if (addr >= VRAM_PADDR && addr < VRAM_PADDR_END) {
+        MarkDirty(vram + (addr - VRAM_PADDR), size);
+    }
+}
+
+bool DirtyPageTracker::IsDirty(Cursor cursor, PAddr addr) const {
+    const std::size_t page = PageIndex(addr);
+    return page < NUM_PAGES && page_epochs[page] >= cursor;
+}
+
+void DirtyPageTracker::Collect(Cursor& cursor, const Callback& callback) {
+    std::size_t run_start = 0;
+    std::size_t run_end = 0;
+    const auto flush_run = [&] {
+        if (run_start != run_end) {
+            callback(PageAddress(run_start), static_cast<u32>((run_end - run_start) * PAGE_SIZE));
+        }
+        run_start = run_end = 0;
+    };
+
+    for (std::size_t group = 0; group < NUM_PAGES / PAGES_PER_GROUP; ++group) {
+        if (group_epochs[group] < cursor) {
+            flush_run();
+            continue;
+        }
+
+        const std::size_t group_start = group * PAGES_PER_GROUP;
+        for (std::size_t page = group_start; page < group_start + PAGES_PER_GROUP; ++page) {
+            if (page_epochs[page] < cursor) {
+                flush_run();
+                continue;
+            }
+            // VRAM and FCRAM aren't contiguous in the physical address space
+            if (run_start == run_end || page != run_end || page == VRAM_PAGES) {
+                flush_run();
+                run_start = page;
+            }
+            run_end = page + 1;
+        }
+    }
+    flush_run();
+
+    cursor = NextEpoch();
+}
+
+void DirtyPageTracker::MarkPages(std::size_t first_page, std::size_t end_page) {
+    DEBUG_ASSERT(end_page <= NUM_PAGES);
+    std::fill(&page_epochs[first_page], &page_epochs[end_page], epoch);
+
+    const std::size_t first_group = first_page / PAGES_PER_GROUP;
+    const std::size_t end_group = (end_page - 1) / PAGES_PER_GROUP + 1;
+    std::fill(&group_epochs[first_group], &group_epochs[end_group], epoch);
+}
+
+u32 DirtyPageTracker::NextEpoch() {
+    ++epoch;
+    if (on_new_epoch) {
+        on_new_epoch();
+    }
+    return epoch;
+}
+
+std::size_t DirtyPageTracker::PageIndex(PAddr addr) {
+    if (addr >= VRAM_PADDR && addr < VRAM_PADDR_END)
+        return (addr - VRAM_PADDR) >> PAGE_BITS;
+    if (addr >= FCRAM_PADDR && addr < FCRAM_N3DS_PADDR_END)
+        return VRAM_PAGES + ((addr - FCRAM_PADDR) >> PAGE_BITS);
+    return NUM_PAGES;
+}
+
+PAddr DirtyPageTracker::PageAddress(std::size_t page) {
+    if (page < VRAM_PAGES)
+        return VRAM_PADDR + static_cast<PAddr>(page * PAGE_SIZE);
+    return FCRAM_PADDR + static_cast<PAddr>((page - VRAM_PAGES) * PAGE_SIZE);
+}
+
+} // namespace Memory
@@ -0,0 +1,95 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include "common/common_types.h"
+
+namespace Memory {
+
+/**
+ * Records which pages of FCRAM and VRAM were written, so that consumers can find out what changed
+ * since they last looked instead of rescanning or rehashing memory.
+ *
+ * Every page remembers the epoch of its last write. Each consumer holds a cursor, which is the
+ * epoch at which it last collected: the pages written at or after it are dirty for that consumer.
+ * Collecting starts a new epoch, so consumers advance independently of each other.
+ *
+ * The tracker only sees the writes it is told about. MemorySystem reports the writes that take
+ * its slow paths, and write-protects the pages of FCRAM and VRAM at the start of every epoch so
+ * that the first write to each of them, from the CPU cores or the HLE code, takes one. Writes
+ * through host pointers obtained without the page tables, like GetFCRAMPointer, are not seen.
+ *
+ * The tracker isn't synchronized, it must be used from the emulation thread.
+ */
+class DirtyPageTracker {
+public:
+    /// Position of a consumer in the write history
+    using Cursor = u32;
+
+    /// Called for each run of contiguous dirty pages with its physical address and size in bytes
+    using Callback = std::function<void(PAddr addr, u32 size)>;
+
+    /**
+     * @param fcram Host memory backing FCRAM
+     * @param vram Host memory backing VRAM
+     * @param on_new_epoch Called whenever a new epoch starts, after which every write must be
+     *                     reported again even if its page was already written
+     */
+    DirtyPageTracker(const u8* fcram, const u8* vram, std::function<void()> on_new_epoch = {});
+    ~DirtyPageTracker();
+
+    /// Returns a cursor for a new consumer, for which no page is dirty yet
+    Cursor CreateCursor();
+
+    /// Marks the pages touched by a write through a host pointer, ignoring memory other than FCRAM
+    /// and VRAM
+    void MarkDirty(const u8* pointer, std::size_t size);
+
+    /// Marks the pages touched by a write to the given physical region
+    void MarkDirty(PAddr addr, u32 size);
+
+    /// Returns whether the page holding the given physical address was written since the cursor
+    bool IsDirty(Cursor cursor, PAddr addr) const;
+
+    /**
+     * Reports the pages written since the cursor was created or last collected, then moves the
+     * cursor to the present.
+     * @param cursor Cursor of the consumer
+     * @param callback Called with every run of dirty pages, in ascending page order
+     */
+    void Collect(Cursor& cursor, const Callback& callback);
+
+private:
+    /// Pages are grouped so that collecting can skip clean groups with a single comparison
+    static constexpr std::size_t PAGES_PER_GROUP = 64;
+
+    void MarkPages(std::size_t first_page, std::size_t end_page);
+
+    /// Starts a new epoch and returns it
+    u32 NextEpoch();
+
+    /// Returns the index of the page holding the physical address, or NUM_PAGES if it's outside
+    /// of FCRAM and VRAM
+    static std::size_t PageIndex(PAddr addr);
+
+    /// Returns the physical address of the page with the given index
+    static PAddr PageAddress(std::size_t page);
+
+    const u8* fcram;
+    const u8* vram;
+    std::function<void()> on_new_epoch;
+
+    /// Epoch of the last write to every page, VRAM pages first and then FCRAM pages
+    std::unique_ptr<u32[]> page_epochs;
+    /// Epoch of the last write to any page of each group
+    std::unique_ptr<u32[]> group_epochs;
+    /// Epoch that writes are currently recorded with, starts after the zero-filled initial state
+    u32 epoch = 1;
+};
+
+} // namespace Memory
@@ -0,0 +1,12 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "core/dumping/backend.h"
+
+namespace VideoDumper {
+
+Backend::~Backend() = default;
+NullBackend::~NullBackend() = default;
+
+} // namespace VideoDumper
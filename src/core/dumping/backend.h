@@ -0,0 +1,94 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+#include "audio_core/audio_types.h"
+#include "common/common_types.h"
+#include "core/frontend/framebuffer_layout.h"
+
+namespace VideoDumper {
+
+/// A frame of video in BGRA8, with the rows stored from bottom to top as read back by OpenGL
+struct VideoFrame {
+    u32 width{};
+    u32 height{};
+    u32 stride{};
+    std::vector<u8> data;
+};
+
+/**
+ * Interface for dumping the emulated video and audio output to a file. Video frames are written
+ * directly into buffers owned by the backend: AcquireVideoFrame hands out the next free buffer of
+ * the backend's queue and SubmitVideoFrame queues it for encoding.
+ */
+class Backend {
+public:
+    virtual ~Backend();
+
+    /**
+     * Starts dumping to the given file. The container format is guessed from the file extension.
+     * @returns true on success
+     */
+    virtual bool StartDumping(const std::string& path) = 0;
+
+    /**
+     * Gets a buffer to write the next video frame into. Blocks while the encoder is behind, so
+     * that no frame is ever dropped, until StopDumping is called.
+     * @returns The buffer, sized for the given dimensions, or nullptr if not dumping or if
+     *          dumping stopped while waiting
+     */
+    virtual VideoFrame* AcquireVideoFrame(u32 width, u32 height) = 0;
+
+    /// Queues the frame previously returned by AcquireVideoFrame for encoding
+    virtual void SubmitVideoFrame(VideoFrame* frame) = 0;
+
+    /// Queues a frame of audio output for encoding
+    virtual void AddAudioFrame(const AudioCore::StereoFrame16& frame) = 0;
+
+    /// Queues a single stereo sample of audio output for encoding
+    virtual void AddAudioSample(const std::array<s16, 2>& sample) = 0;
+
+    /// Encodes everything that was queued and finalizes the file
+    virtual void StopDumping() = 0;
+
+    virtual bool IsDumping() const = 0;
+
+    /// Gets the layout the screens should be drawn with for dumping
+    virtual Layout::FramebufferLayout GetLayout() const = 0;
+};
+
+class NullBackend : public Backend {
+public:
+    ~NullBackend() override;
+
+    bool StartDumping(const std::string& path) override {
+        return false;
+    }
+
+    VideoFrame* AcquireVideoFrame(u32 width, u32 height) override {
+        return nullptr;
+    }
+
+    void SubmitVideoFrame(VideoFrame* frame) override {}
+
+    void AddAudioFrame(const AudioCore::StereoFrame16& frame) override {}
+
+    void AddAudioSample(const std::array<s16, 2>& sample) override {}
+
+    void StopDumping() override {}
+
+    bool IsDumping() const override {
+        return false;
+    }
+
+    Layout::FramebufferLayout GetLayout() const override {
+        return Layout::FramebufferLayout{};
+    }
+};
+
+} // namespace VideoDumper
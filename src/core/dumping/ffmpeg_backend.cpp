@@ -0,0 +1,521 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include "audio_core/hle/ffmpeg_dl.h"
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/thread.h"
+#include "core/dumping/ffmpeg_backend.h"
+#include "core/hw/gpu.h"
+#include "core/settings.h"
+
+namespace VideoDumper {
+
+namespace {
+
+/// Converts a bottom-up BGRA8 frame to planar YUV 4:2:0 with BT.601 coefficients
+void ConvertToYUV420(const VideoFrame& src, AVFrame* dst) {
+    const auto row = [&src](u32 y) {
+        return src.data.data() + (src.height - 1 - y) * src.stride;
+    };
+
+    for (u32 y = 0; y < src.height; ++y) {
+        const u8* in = row(y);
+        u8* out = dst->data[0] + y * dst->linesize[0];
+        for (u32 x = 0; x < src.width; ++x) {
+            const int b = in[x * 4 + 0];
+            const int g = in[x * 4 + 1];
+            const int r = in[x * 4 + 2];
+            out[x] = static_cast<u8>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+        }
+    }
+
+    for (u32 y = 0; y < src.height / 2; ++y) {
+        const u8* in0 = row(y * 2);
+        const u8* in1 = row(y * 2 + 1);
+        u8* out_u = dst->data[1] + y * dst->linesize[1];
+        u8* out_v = dst->data[2] + y * dst->linesize[2];
+        for (u32 x = 0; x < src.width / 2; ++x) {
+            const u32 i = x * 8;
+            const int b = (in0[i + 0] + in0[i + 4] + in1[i + 0] + in1[i + 4]) / 4;
+            const int g = (in0[i + 1] + in0[i + 5] + in1[i + 1] + in1[i + 5]) / 4;
+            const int r = (in0[i + 2] + in0[i + 6] + in1[i + 2] + in1[i + 6]) / 4;
+            out_u[x] = static_cast<u8>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+            out_v[x] = static_cast<u8>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        }
+    }
+}
+
+/// Converts interleaved stereo s16 samples to the sample format of the frame
+void ConvertSamples(const s16* src, int count, AVFrame* dst) {
+    switch (dst->format) {
+    case AV_SAMPLE_FMT_S16:
+        std::memcpy(dst->data[0], src, count * 2 * sizeof(s16));
+        break;
+    case AV_SAMPLE_FMT_S16P:
+        for (int i = 0; i < count; ++i) {
+            reinterpret_cast<s16*>(dst->data[0])[i] = src[i * 2 + 0];
+            reinterpret_cast<s16*>(dst->data[1])[i] = src[i * 2 + 1];
+        }
+        break;
+    case AV_SAMPLE_FMT_FLT:
+        for (int i = 0; i < count * 2; ++i) {
+            reinterpret_cast<float*>(dst->data[0])[i] = src[i] / 32768.0f;
+        }
+        break;
+    case AV_SAMPLE_FMT_FLTP:
+        for (int i = 0; i < count; ++i) {
+            reinterpret_cast<float*>(dst->data[0])[i] = src[i * 2 + 0] / 32768.0f;
+            reinterpret_cast<float*>(dst->data[1])[i] = src[i * 2 + 1] / 32768.0f;
+        }
+        break;
+    default:
+        UNREACHABLE();
+    }
+}
+
+bool IsSupportedSampleFormat(AVSampleFormat format) {
+    return format == AV_SAMPLE_FMT_S16 || format == AV_SAMPLE_FMT_S16P ||
+           format == AV_SAMPLE_FMT_FLT || format == AV_SAMPLE_FMT_FLTP;
+}
+
+} // namespace
+
+void FFmpegBackend::AVCodecContextDeleter::operator()(AVCodecContext* codec_context) const {
+    avcodec_free_context_dl(&codec_context);
+}
+
+void FFmpegBackend::AVFormatContextDeleter::operator()(AVFormatContext* format_context) const {
+    if (!(format_context->oformat->flags & AVFMT_NOFILE)) {
+        avio_closep_dl(&format_context->pb);
+    }
+    avformat_free_context_dl(format_context);
+}
+
+void FFmpegBackend::AVFrameDeleter::operator()(AVFrame* frame) const {
+    av_frame_free_dl(&frame);
+}
+
+FFmpegBackend::FFmpegBackend() = default;
+
+FFmpegBackend::~FFmpegBackend() {
+    StopDumping();
+}
+
+bool FFmpegBackend::StartDumping(const std::string& path) {
+    if (is_dumping) {
+        LOG_ERROR(Dumping, "Already dumping");
+        return false;
+    }
+
+    if (!InitFFmpegEncoderDL()) {
+        LOG_ERROR(Dumping, "Could not load the FFmpeg libraries");
+        return false;
+    }
+
+    layout = Layout::FrameLayoutFromResolutionScale(1);
+
+    AVFormatContext* format_context_raw = nullptr;
+    if (avformat_alloc_output_context2_dl(&format_context_raw, nullptr, nullptr, path.c_str()) <
+        0) {
+        LOG_ERROR(Dumping, "Could not find a container format for {}", path);
+        return false;
+    }
+    format_context.reset(format_context_raw);
+
+    if (!InitVideo() || !InitAudio()) {
+        FreeResources();
+        return false;
+    }
+
+    if (!(format_context->oformat->flags & AVFMT_NOFILE) &&
+        avio_open_dl(&format_context->pb, path.c_str(), AVIO_FLAG_WRITE) < 0) {
+        LOG_ERROR(Dumping, "Could not open {}", path);
+        FreeResources();
+        return false;
+    }
+
+    if (avformat_write_header_dl(format_context.get(), nullptr) < 0) {
+        LOG_ERROR(Dumping, "Could not write the container header");
+        FreeResources();
+        return false;
+    }
+
+    video_ring.clear();
+    video_ring.resize(std::max<u32>(Settings::values.dump_ring_depth, 1));
+    write_index = read_index = queued_frames = 0;
+    frame_acquired = false;
+    audio_samples.clear();
+    next_video_pts = next_audio_pts = 0;
+    stop_requested = false;
+
+    is_dumping = true;
+    encoder_thread = std::thread(&FFmpegBackend::EncoderLoop, this);
+
+    LOG_INFO(Dumping, "Dumping video and audio to {}", path);
+    return true;
+}
+
+bool FFmpegBackend::InitVideo() {
+    const AVCodec* codec = nullptr;
+    if (!Settings::values.dump_video_encoder.empty()) {
+        codec = avcodec_find_encoder_by_name_dl(Settings::values.dump_video_encoder.c_str());
+        if (codec == nullptr) {
+            LOG_WARNING(Dumping, "Video encoder {} not found, using the container's default",
+                        Settings::values.dump_video_encoder);
+        }
+    }
+    if (codec == nullptr) {
+        codec = avcodec_find_encoder_dl(format_context->oformat->video_codec);
+    }
+    if (codec == nullptr) {
+        LOG_ERROR(Dumping, "Could not find a video encoder");
+        return false;
+    }
+
+    if (codec->pix_fmts != nullptr) {
+        const AVPixelFormat* format = codec->pix_fmts;
+        while (*format != AV_PIX_FMT_NONE && *format != AV_PIX_FMT_YUV420P) {
+            ++format;
+        }
+        if (*format == AV_PIX_FMT_NONE) {
+            LOG_ERROR(Dumping, "Video encoder {} does not support yuv420p", codec->name);
+            return false;
+        }
+    }
+
+    video_codec_context.reset(avcodec_alloc_context3_dl(codec));
+    if (!video_codec_context) {
+        LOG_ERROR(Dumping, "Could not allocate the video codec context");
+        return false;
+    }
+
+    video_codec_context->width = layout.width;
+    video_codec_context->height = layout.height;
+    video_codec_context->time_base = {1, static_cast<int>(GPU::SCREEN_REFRESH_RATE)};
+    video_codec_context->pix_fmt = AV_PIX_FMT_YUV420P;
+    video_codec_context->gop_size = 12;
+    if (format_context->oformat->flags & AVFMT_GLOBALHEADER) {
+        video_codec_context->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    }
+
+    if (avcodec_open2_dl(video_codec_context.get(), codec, nullptr) < 0) {
+        LOG_ERROR(Dumping, "Could not open video encoder {}", codec->name);
+        return false;
+    }
+
+    video_stream = avformat_new_stream_dl(format_context.get(), codec);
+    if (video_stream == nullptr ||
+        avcodec_parameters_from_context_dl(video_stream->codecpar, video_codec_context.get()) <
+            0) {
+        LOG_ERROR(Dumping, "Could not create the video stream");
+        return false;
+    }
+    video_stream->time_base = video_codec_context->time_base;
+
+    video_frame.reset(av_frame_alloc_dl());
+    video_frame->format = video_codec_context->pix_fmt;
+    video_frame->width = video_codec_context->width;
+    video_frame->height = video_codec_context->height;
+    if (av_frame_get_buffer_dl(video_frame.get(), 0) < 0) {
+        LOG_ERROR(Dumping, "Could not allocate the video frame");
+        return false;
+    }
+
+    return true;
+}
+
+bool FFmpegBackend::InitAudio() {
+    const AVCodec* codec = nullptr;
+    if (!Settings::values.dump_audio_encoder.empty()) {
+        codec = avcodec_find_encoder_by_name_dl(Settings::values.dump_audio_encoder.c_str());
+        if (codec == nullptr) {
+            LOG_WARNING(Dumping, "Audio encoder {} not found, using the container's default",
+                        Settings::values.dump_audio_encoder);
+        }
+    }
+    if (codec == nullptr) {
+        codec = avcodec_find_encoder_dl(format_context->oformat->audio_codec);
+    }
+    if (codec == nullptr) {
+        LOG_ERROR(Dumping, "Could not find an audio encoder");
+        return false;
+    }
+
+    AVSampleFormat sample_format = AV_SAMPLE_FMT_NONE;
+    if (codec->sample_fmts != nullptr) {
+        for (const AVSampleFormat* format = codec->sample_fmts; *format != AV_SAMPLE_FMT_NONE;
+             ++format) {
+            if (IsSupportedSampleFormat(*format)) {
+                sample_format = *format;
+                break;
+            }
+        }
+    }
+    if (sample_format == AV_SAMPLE_FMT_NONE) {
+        LOG_ERROR(Dumping, "Audio encoder {} has no supported sample format", codec->name);
+        return false;
+    }
+
+    if (codec->supported_samplerates != nullptr) {
+        const int* rate = codec->supported_samplerates;
+        while (*rate != 0 && *rate != AudioCore::native_sample_rate) {
+            ++rate;
+        }
+        if (*rate == 0) {
+            LOG_ERROR(Dumping, "Audio encoder {} does not support a sample rate of {} Hz",
+                      codec->name, AudioCore::native_sample_rate);
+            return false;
+        }
+    }
+
+    audio_codec_context.reset(avcodec_alloc_context3_dl(codec));
+    if (!audio_codec_context) {
+        LOG_ERROR(Dumping, "Could not allocate the audio codec context");
+        return false;
+    }
+
+    audio_codec_context->sample_fmt = sample_format;
+    audio_codec_context->sample_rate = AudioCore::native_sample_rate;
+    audio_codec_context->channel_layout = AV_CH_LAYOUT_STEREO;
+    audio_codec_context->channels = 2;
+    audio_codec_context->time_base = {1, AudioCore::native_sample_rate};
+    if (format_context->oformat->flags & AVFMT_GLOBALHEADER) {
+        audio_codec_context->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    }
+
+    if (avcodec_open2_dl(audio_codec_context.get(), codec, nullptr) < 0) {
+        LOG_ERROR(Dumping, "Could not open audio encoder {}", codec->name);
+        return false;
+    }
+
+    audio_stream = avformat_new_stream_dl(format_context.get(), codec);
+    if (audio_stream == nullptr ||
+        avcodec_parameters_from_context_dl(audio_stream->codecpar, audio_codec_context.get()) <
+            0) {
+        LOG_ERROR(Dumping, "Could not create the audio stream");
+        return false;
+    }
+    audio_stream->time_base = audio_codec_context->time_base;
+
+    audio_frame.reset(av_frame_alloc_dl());
+    audio_frame->format = sample_format;
+    audio_frame->channel_layout = AV_CH_LAYOUT_STEREO;
+    audio_frame->sample_rate = AudioCore::native_sample_rate;
+    audio_frame->nb_samples = (codec->capabilities & AV_CODEC_CAP_VARIABLE_FRAME_SIZE)
+                                  ? AudioCore::samples_per_frame
+                                  : audio_codec_context->frame_size;
+    if (av_frame_get_buffer_dl(audio_frame.get(), 0) < 0) {
+        LOG_ERROR(Dumping, "Could not allocate the audio frame");
+        return false;
+    }
+
+    return true;
+}
+
+VideoFrame* FFmpegBackend::AcquireVideoFrame(u32 width, u32 height) {
+    if (!is_dumping) {
+        return nullptr;
+    }
+
+    std::unique_lock lock{queue_mutex};
+    // Back-pressure: wait for the encoder instead of dropping the frame
+    frame_released.wait(lock, [this] { return queued_frames < video_ring.size() || !is_dumping; });
+    if (!is_dumping) {
+        return nullptr;
+    }
+
+    // The encoder never touches the slot at write_index, so it can be filled without the lock.
+    // StopDumping waits for it to be submitted before draining the ring.
+    frame_acquired = true;
+    VideoFrame& frame = video_ring[write_index];
+    frame.width = width;
+    frame.height = height;
+    frame.stride = width * 4;
+    frame.data.resize(frame.stride * height);
+    return &frame;
+}
+
+void FFmpegBackend::SubmitVideoFrame(VideoFrame* frame) {
+    {
+        std::lock_guard lock{queue_mutex};
+        ASSERT(frame_acquired && frame == &video_ring[write_index]);
+        frame_acquired = false;
+        write_index = (write_index + 1) % video_ring.size();
+        ++queued_frames;
+    }
+    frame_released.notify_all();
+    work_available.notify_one();
+}
+
+void FFmpegBackend::AddAudioFrame(const AudioCore::StereoFrame16& frame) {
+    if (!is_dumping) {
+        return;
+    }
+
+    // Audio is picked up by the encoder whenever it wakes up for a video frame
+    std::lock_guard lock{queue_mutex};
+    for (const auto& sample : frame) {
+        audio_samples.insert(audio_samples.end(), sample.begin(), sample.end());
+    }
+}
+
+void FFmpegBackend::AddAudioSample(const std::array<s16, 2>& sample) {
+    if (!is_dumping) {
+        return;
+    }
+
+    std::lock_guard lock{queue_mutex};
+    audio_samples.insert(audio_samples.end(), sample.begin(), sample.end());
+}
+
+void FFmpegBackend::EncoderLoop() {
+    Common::SetCurrentThreadName("VideoDumper");
+
+    std::vector<s16> pending_audio;
+    bool stop = false;
+    while (!stop) {
+        const VideoFrame* frame = nullptr;
+        {
+            std::unique_lock lock{queue_mutex};
+            work_available.wait(lock, [this] { return queued_frames > 0 || stop_requested; });
+
+            pending_audio.insert(pending_audio.end(), audio_samples.begin(), audio_samples.end());
+            audio_samples.clear();
+
+            if (queued_frames > 0) {
+                frame = &video_ring[read_index];
+            }
+            stop = stop_requested && queued_frames <= 1;
+        }
+
+        EncodeAudio(pending_audio, false);
+
+        if (frame != nullptr) {
+            // The frame is encoded straight from its ring slot, which stays reserved until here
+            EncodeVideoFrame(*frame);
+            {
+                std::lock_guard lock{queue_mutex};
+                read_index = (read_index + 1) % video_ring.size();
+                --queued_frames;
+            }
+            frame_released.notify_all();
+        }
+    }
+
+    EncodeAudio(pending_audio, true);
+    SendFrame(video_codec_context.get(), video_stream, nullptr);
+    SendFrame(audio_codec_context.get(), audio_stream, nullptr);
+}
+
+void FFmpegBackend::EncodeVideoFrame(const VideoFrame& frame) {
+    if (frame.width != layout.width || frame.height != layout.height) {
+        LOG_ERROR(Dumping, "Skipping frame of unexpected size {}x{}", frame.width, frame.height);
+        return;
+    }
+
+    if (av_frame_make_writable_dl(video_frame.get()) < 0) {
+        LOG_ERROR(Dumping, "Could not make the video frame writable");
+        return;
+    }
+
+    ConvertToYUV420(frame, video_frame.get());
+    video_frame->pts = next_video_pts++;
+    SendFrame(video_codec_context.get(), video_stream, video_frame.get());
+}
+
+void FFmpegBackend::EncodeAudio(std::vector<s16>& samples, bool flush) {
+    const std::size_t frame_size = static_cast<std::size_t>(audio_frame->nb_samples);
+    const std::size_t available = samples.size() / 2;
+
+    std::size_t offset = 0;
+    while (available - offset >= frame_size || (flush && offset < available)) {
+        const std::size_t count = std::min(frame_size, available - offset);
+
+        if (av_frame_make_writable_dl(audio_frame.get()) < 0) {
+            LOG_ERROR(Dumping, "Could not make the audio frame writable");
+            break;
+        }
+
+        if (count < frame_size) {
+            // Pad the last frame with silence
+            std::vector<s16> padded(frame_size * 2);
+            std::copy_n(samples.begin() + offset * 2, count * 2, padded.begin());
+            ConvertSamples(padded.data(), static_cast<int>(frame_size), audio_frame.get());
+        } else {
+            ConvertSamples(samples.data() + offset * 2, static_cast<int>(frame_size),
+                           audio_frame.get());
+        }
+
+        audio_frame->pts = next_audio_pts;
+        next_audio_pts += frame_size;
+        SendFrame(audio_codec_context.get(), audio_stream, audio_frame.get());
+
+        offset += count;
+    }
+
+    samples.erase(samples.begin(), samples.begin() + offset * 2);
+}
+
+void FFmpegBackend::SendFrame(AVCodecContext* codec_context, AVStream* stream, AVFrame* frame) {
+    if (avcodec_send_frame_dl(codec_context, frame) < 0) {
+        LOG_ERROR(Dumping, "Could not send a frame to the {} encoder", codec_context->codec->name);
+        return;
+    }
+
+    AVPacket* packet = av_packet_alloc_dl();
+    while (avcodec_receive_packet_dl(codec_context, packet) >= 0) {
+        av_packet_rescale_ts_dl(packet, codec_context->time_base, stream->time_base);
+        packet->stream_index = stream->index;
+        if (av_interleaved_write_frame_dl(format_context.get(), packet) < 0) {
+            LOG_ERROR(Dumping, "Could not write a packet");
+        }
+    }
+    av_packet_free_dl(&packet);
+}
+
+void FFmpegBackend::StopDumping() {
+    if (!is_dumping) {
+        return;
+    }
+
+    // Stop accepting new frames, releasing a renderer waiting for a free slot, and let a frame
+    // that is already being filled be submitted. Then let the encoder drain the ring.
+    {
+        std::unique_lock lock{queue_mutex};
+        is_dumping = false;
+        frame_released.notify_all();
+        frame_released.wait(lock, [this] { return !frame_acquired; });
+        stop_requested = true;
+    }
+    work_available.notify_one();
+    encoder_thread.join();
+
+    av_write_trailer_dl(format_context.get());
+    FreeResources();
+
+    LOG_INFO(Dumping, "Dumping finished");
+}
+
+bool FFmpegBackend::IsDumping() const {
+    return is_dumping;
+}
+
+Layout::FramebufferLayout FFmpegBackend::GetLayout() const {
+    return layout;
+}
+
+void FFmpegBackend::FreeResources() {
+    video_frame.reset();
+    audio_frame.reset();
+    video_codec_context.reset();
+    audio_codec_context.reset();
+    format_context.reset();
+    video_stream = nullptr;
+    audio_stream = nullptr;
+}
+
+} // namespace VideoDumper
@@ -0,0 +1,106 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "common/common_types.h"
+#include "core/dumping/backend.h"
+
+struct AVCodecContext;
+struct AVFormatContext;
+struct AVFrame;
+struct AVStream;
+
+namespace VideoDumper {
+
+/**
+ * Video dumper encoding with FFmpeg on a background thread. Video frames are handed over through
+ * a ring of preallocated buffers whose depth is configurable; when the ring is full, the renderer
+ * blocks until the encoder has caught up instead of dropping frames.
+ */
+class FFmpegBackend : public Backend {
+public:
+    FFmpegBackend();
+    ~FFmpegBackend() override;
+
+    bool StartDumping(const std::string& path) override;
+    VideoFrame* AcquireVideoFrame(u32 width, u32 height) override;
+    void SubmitVideoFrame(VideoFrame* frame) override;
+    void AddAudioFrame(const AudioCore::StereoFrame16& frame) override;
+    void AddAudioSample(const std::array<s16, 2>& sample) override;
+    void StopDumping() override;
+    bool IsDumping() const override;
+    Layout::FramebufferLayout GetLayout() const override;
+
+private:
+    struct AVCodecContextDeleter {
+        void operator()(AVCodecContext* codec_context) const;
+    };
+
+    struct AVFormatContextDeleter {
+        void operator()(AVFormatContext* format_context) const;
+    };
+
+    struct AVFrameDeleter {
+        void operator()(AVFrame* frame) const;
+    };
+
+    bool InitVideo();
+    bool InitAudio();
+
+    /// Entry point of the encoder thread
+    void EncoderLoop();
+
+    void EncodeVideoFrame(const VideoFrame& frame);
+    void EncodeAudio(std::vector<s16>& samples, bool flush);
+
+    /// Sends a frame (or nullptr to flush) to the encoder and writes the resulting packets out
+    void SendFrame(AVCodecContext* codec_context, AVStream* stream, AVFrame* frame);
+
+    void FreeResources();
+
+    Layout::FramebufferLayout layout;
+
+    std::unique_ptr<AVFormatContext, AVFormatContextDeleter> format_context;
+    std::unique_ptr<AVCodecContext, AVCodecContextDeleter> video_codec_context;
+    std::unique_ptr<AVCodecContext, AVCodecContextDeleter> audio_codec_context;
+    std::unique_ptr<AVFrame, AVFrameDeleter> video_frame;
+    std::unique_ptr<AVFrame, AVFrameDeleter> audio_frame;
+    AVStream* video_stream = nullptr;
+    AVStream* audio_stream = nullptr;
+    s64 next_audio_pts = 0;
+    s64 next_video_pts = 0;
+
+    /// Ring of video frames; the renderer writes at write_index, the encoder reads at read_index
+    std::vector<VideoFrame> video_ring;
+    std::size_t write_index = 0;
+    std::size_t read_index = 0;
+    std::size_t queued_frames = 0;
+    /// Whether the renderer holds the slot at write_index, between acquiring and submitting it
+    bool frame_acquired = false;
+
+    /// Interleaved stereo samples waiting to be encoded
+    std::vector<s16> audio_samples;
+
+    bool stop_requested = false;
+    std::atomic_bool is_dumping{false};
+
+    std::mutex queue_mutex;
+    /// Signaled when a video frame was released by the encoder or submitted by the renderer, and
+    /// when dumping stops
+    std::condition_variable frame_released;
+    /// Signaled when there's something new for the encoder
+    std::condition_variable work_available;
+    std::thread encoder_thread;
+};
+
+} // namespace VideoDumper
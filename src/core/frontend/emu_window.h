@@ -12,6 +12,25 @@
 
 namespace Frontend {
 
+/**
+ * Represents a graphics context that can be made current on a thread and presented to. Frontends
+ * can hand out additional contexts sharing objects with the main one, so that other host threads
+ * can use the graphics API.
+ */
+class GraphicsContext {
+public:
+    virtual ~GraphicsContext();
+
+    /// Swap buffers to display the next frame
+    virtual void SwapBuffers() = 0;
+
+    /// Makes the graphics context current for the caller thread
+    virtual void MakeCurrent() = 0;
+
+    /// Releases (dunno if this is the "right" word) the context from the caller thread
+    virtual void DoneCurrent() = 0;
+};
+
 /**
  * Abstraction class used to provide an interface between emulation code and the frontend
  * (e.g. SDL, QGLWidget, GLFW, etc...).
@@ -30,7 +49,7 @@ namespace Frontend {
  * - DO NOT TREAT THIS CLASS AS A GUI TOOLKIT ABSTRACTION LAYER. That's not what it is. Please
  *   re-read the upper points again and think about it if you don't see this.
  */
-class EmuWindow {
+class EmuWindow : public GraphicsContext {
 public:
     /// Data structure to store emuwindow configuration
     struct WindowConfig {
@@ -40,17 +59,17 @@ public:
         std::pair<unsigned, unsigned> min_client_area_size;
     };
 
-    /// Swap buffers to display the next frame
-    virtual void SwapBuffers() = 0;
-
     /// Polls window events
     virtual void PollEvents() = 0;
 
-    /// Makes the graphics context current for the caller thread
-    virtual void MakeCurrent() = 0;
-
-    /// Releases (dunno if this is the "right" word) the GLFW context from the caller thread
-    virtual void DoneCurrent() = 0;
+    /**
+     * Creates a graphics context that shares objects with the main context of this window and
+     * presents to it. Must be called from the thread the main context is current on.
+     * @returns The new context, or nullptr if the frontend doesn't support shared contexts
+     */
+    virtual std::unique_ptr<GraphicsContext> CreateSharedContext() const {
+        return nullptr;
+    }
 
     /**
      * Signal that a touch pressed event has occurred (e.g. mouse click pressed)
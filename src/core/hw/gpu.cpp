@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <array>
 #include <cstring>
 #include <numeric>
 #include <type_traits>
@@ -19,6 +20,7 @@
 #include "core/tracer/recorder.h"
 #include "video_core/command_processor.h"
 #include "video_core/debug_utils/debug_utils.h"
+#include "video_core/gpu_thread.h"
 #include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_base.h"
 #include "video_core/utils.h"
@@ -33,6 +35,10 @@ Memory::MemorySystem* g_memory;
 const u64 frame_ticks = static_cast<u64>(BASE_CLOCK_RATE_ARM11 / SCREEN_REFRESH_RATE);
 /// Event id for CoreTiming
 static Core::TimingEventType* vblank_event;
+/// Event id for forwarding interrupts raised on the GPU thread to the emulation thread
+static Core::TimingEventType* interrupt_event;
+/// Fences of the memory fills queued on the GPU thread that aren't reported as finished yet
+static std::array<u64, 2> memory_fill_fences;
 
 template <typename T>
 inline void Read(T& var, const u32 raw_addr) {
@@ -45,6 +51,17 @@ inline void Read(T& var, const u32 raw_addr) {
         return;
     }
 
+    // Memory fills queued on the GPU thread only report as finished once they have been performed
+    if (VideoCore::g_gpu_thread && (index == GPU_REG_INDEX(memory_fill_config[0].trigger) ||
+                                    index == GPU_REG_INDEX(memory_fill_config[1].trigger))) {
+        const bool is_second_filler = (index != GPU_REG_INDEX(memory_fill_config[0].trigger));
+        u64& fence = memory_fill_fences[is_second_filler];
+        if (fence != 0 && VideoCore::g_gpu_thread->IsFenceSignaled(fence)) {
+            g_regs.memory_fill_config[is_second_filler].finished.Assign(1);
+            fence = 0;
+        }
+    }
+
     var = g_regs[addr / 4];
 }
 
@@ -385,6 +402,62 @@ static void TextureCopy(const Regs::DisplayTransferConfig& config) {
     }
 }
 
+void SignalInterrupt(Service::GSP::InterruptId interrupt_id) {
+    if (VideoCore::g_gpu_thread && VideoCore::g_gpu_thread->IsGPUThread()) {
+        Core::System::GetInstance().CoreTiming().ScheduleEventThreadsafe(
+            0, interrupt_event, static_cast<u64>(interrupt_id));
+        return;
+    }
+
+    Service::GSP::SignalInterrupt(interrupt_id);
+}
+
+void ProcessMemoryFill(const Regs::MemoryFillConfig& config, bool is_second_filler) {
+    MemoryFill(config);
+    LOG_TRACE(HW_GPU, "MemoryFill from {:#010X} to {:#010X}", config.GetStartAddress(),
+              config.GetEndAddress());
+
+    // It seems that it won't signal interrupt if "address_start" is zero.
+    // TODO: hwtest this
+    if (config.GetStartAddress() != 0) {
+        if (!is_second_filler) {
+            GPU::SignalInterrupt(Service::GSP::InterruptId::PSC0);
+        } else {
+            GPU::SignalInterrupt(Service::GSP::InterruptId::PSC1);
+        }
+    }
+}
+
+void ProcessDisplayTransfer(const Regs::DisplayTransferConfig& config) {
+    MICROPROFILE_SCOPE(GPU_DisplayTransfer);
+
+    if (Pica::g_debug_context)
+        Pica::g_debug_context->OnEvent(Pica::DebugContext::Event::IncomingDisplayTransfer,
+                                       nullptr);
+
+    if (config.is_texture_copy) {
+        TextureCopy(config);
+        LOG_TRACE(HW_GPU,
+                  "TextureCopy: {:#X} bytes from {:#010X}({}+{})-> "
+                  "{:#010X}({}+{}), flags {:#010X}",
+                  config.texture_copy.size, config.GetPhysicalInputAddress(),
+                  config.texture_copy.input_width * 16, config.texture_copy.input_gap * 16,
+                  config.GetPhysicalOutputAddress(), config.texture_copy.output_width * 16,
+                  config.texture_copy.output_gap * 16, config.flags);
+    } else {
+        DisplayTransfer(config);
+        LOG_TRACE(HW_GPU,
+                  "DisplayTransfer: {:#010X}({}x{})-> "
+                  "{:#010X}({}x{}), dst format {:x}, flags {:#010X}",
+                  config.GetPhysicalInputAddress(), config.input_width.Value(),
+                  config.input_height.Value(), config.GetPhysicalOutputAddress(),
+                  config.output_width.Value(), config.output_height.Value(),
+                  static_cast<u32>(config.output_format.Value()), config.flags);
+    }
+
+    GPU::SignalInterrupt(Service::GSP::InterruptId::PPF);
+}
+
 template <typename T>
 inline void Write(u32 addr, const T data) {
     addr -= HW::VADDR_GPU;
@@ -407,60 +480,32 @@ inline void Write(u32 addr, const T data) {
         auto& config = g_regs.memory_fill_config[is_second_filler];
 
         if (config.trigger) {
-            MemoryFill(config);
-            LOG_TRACE(HW_GPU, "MemoryFill from {:#010X} to {:#010X}", config.GetStartAddress(),
-                      config.GetEndAddress());
-
-            // It seems that it won't signal interrupt if "address_start" is zero.
-            // TODO: hwtest this
-            if (config.GetStartAddress() != 0) {
-                if (!is_second_filler) {
-                    Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PSC0);
-                } else {
-                    Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PSC1);
-                }
-            }
-
-            // Reset "trigger" flag and set the "finish" flag
+            // Reset "trigger" flag and set the "finish" flag once the fill is done
             // NOTE: This was confirmed to happen on hardware even if "address_start" is zero.
             config.trigger.Assign(0);
-            config.finished.Assign(1);
+            if (VideoCore::g_gpu_thread) {
+                // Read sets the "finish" flag when the GPU thread has performed the fill
+                config.finished.Assign(0);
+                memory_fill_fences[is_second_filler] =
+                    VideoCore::g_gpu_thread->MemoryFill(config, is_second_filler);
+            } else {
+                ProcessMemoryFill(config, is_second_filler);
+                config.finished.Assign(1);
+            }
         }
         break;
     }
 
     case GPU_REG_INDEX(display_transfer_config.trigger): {
-        MICROPROFILE_SCOPE(GPU_DisplayTransfer);
-
         const auto& config = g_regs.display_transfer_config;
         if (config.trigger & 1) {
-
-            if (Pica::g_debug_context)
-                Pica::g_debug_context->OnEvent(Pica::DebugContext::Event::IncomingDisplayTransfer,
-                                               nullptr);
-
-            if (config.is_texture_copy) {
-                TextureCopy(config);
-                LOG_TRACE(HW_GPU,
-                          "TextureCopy: {:#X} bytes from {:#010X}({}+{})-> "
-                          "{:#010X}({}+{}), flags {:#010X}",
-                          config.texture_copy.size, config.GetPhysicalInputAddress(),
-                          config.texture_copy.input_width * 16, config.texture_copy.input_gap * 16,
-                          config.GetPhysicalOutputAddress(), config.texture_copy.output_width * 16,
-                          config.texture_copy.output_gap * 16, config.flags);
+            if (VideoCore::g_gpu_thread) {
+                VideoCore::g_gpu_thread->DisplayTransfer(config);
             } else {
-                DisplayTransfer(config);
-                LOG_TRACE(HW_GPU,
-                          "DisplayTransfer: {:#010X}({}x{})-> "
-                          "{:#010X}({}x{}), dst format {:x}, flags {:#010X}",
-                          config.GetPhysicalInputAddress(), config.input_width.Value(),
-                          config.input_height.Value(), config.GetPhysicalOutputAddress(),
-                          config.output_width.Value(), config.output_height.Value(),
-                          static_cast<u32>(config.output_format.Value()), config.flags);
+                ProcessDisplayTransfer(config);
             }
 
             g_regs.display_transfer_config.trigger = 0;
-            Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PPF);
         }
         break;
     }
@@ -478,7 +523,11 @@ inline void Write(u32 addr, const T data) {
                                                                 config.GetPhysicalAddress());
             }
 
-            Pica::CommandProcessor::ProcessCommandList(buffer, config.size);
+            if (VideoCore::g_gpu_thread) {
+                VideoCore::g_gpu_thread->SubmitList(buffer, config.size);
+            } else {
+                Pica::CommandProcessor::ProcessCommandList(buffer, config.size);
+            }
 
             g_regs.command_processor_config.trigger = 0;
         }
@@ -512,7 +561,11 @@ template void Write<u8>(u32 addr, const u8 data);
 
 /// Update hardware
 static void VBlankCallback(u64 userdata, s64 cycles_late) {
-    VideoCore::g_renderer->SwapBuffers();
+    if (VideoCore::g_gpu_thread) {
+        VideoCore::g_gpu_thread->SwapBuffers();
+    } else {
+        VideoCore::g_renderer->SwapBuffers();
+    }
 
     // Signal to GSP that GPU interrupt has occurred
     // TODO(yuriks): hwtest to determine if PDC0 is for the Top screen and PDC1 for the Sub
@@ -526,10 +579,16 @@ static void VBlankCallback(u64 userdata, s64 cycles_late) {
     Core::System::GetInstance().CoreTiming().ScheduleEvent(frame_ticks - cycles_late, vblank_event);
 }
 
+/// Signals an interrupt that was raised on the GPU thread
+static void InterruptCallback(u64 userdata, s64 cycles_late) {
+    Service::GSP::SignalInterrupt(static_cast<Service::GSP::InterruptId>(userdata));
+}
+
 /// Initialize hardware
 void Init(Memory::MemorySystem& memory) {
     g_memory = &memory;
     memset(&g_regs, 0, sizeof(g_regs));
+    memory_fill_fences = {};
 
     auto& framebuffer_top = g_regs.framebuffer_config[0];
     auto& framebuffer_sub = g_regs.framebuffer_config[1];
@@ -559,6 +618,7 @@ void Init(Memory::MemorySystem& memory) {
 
     Core::Timing& timing = Core::System::GetInstance().CoreTiming();
     vblank_event = timing.RegisterEvent("GPU::VBlankCallback", VBlankCallback);
+    interrupt_event = timing.RegisterEvent("GPU::InterruptCallback", InterruptCallback);
     timing.ScheduleEvent(frame_ticks, vblank_event);
 
     LOG_DEBUG(HW_GPU, "initialized OK");
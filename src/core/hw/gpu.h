@@ -15,6 +15,10 @@ namespace Memory {
 class MemorySystem;
 }
 
+namespace Service::GSP {
+enum class InterruptId : u8;
+}
+
 namespace GPU {
 
 constexpr float SCREEN_REFRESH_RATE = 60;
@@ -329,6 +333,20 @@ void Read(T& var, const u32 addr);
 template <typename T>
 void Write(u32 addr, const T data);
 
+/**
+ * Signals a GSP interrupt. When called from the GPU thread, the interrupt is forwarded to the
+ * emulation thread through a thread-safe CoreTiming event, since the HLE kernel state must only be
+ * touched from there.
+ * @param interrupt_id ID of interrupt that is being signalled
+ */
+void SignalInterrupt(Service::GSP::InterruptId interrupt_id);
+
+/// Performs a PSC memory fill and signals the corresponding PSC interrupt
+void ProcessMemoryFill(const Regs::MemoryFillConfig& config, bool is_second_filler);
+
+/// Performs a PPF display transfer or texture copy and signals the PPF interrupt
+void ProcessDisplayTransfer(const Regs::DisplayTransferConfig& config);
+
 /// Initialize hardware
 void Init(Memory::MemorySystem& memory);
 
@@ -104,8 +104,17 @@ static void ReceiveData(Memory::MemorySystem& memory, u8* output, ConversionBuff
 /// transfer.
 static void SendData(Memory::MemorySystem& memory, const u32* input, ConversionBuffer& buf,
                      int amount_of_data, OutputFormat output_format, u8 alpha) {
-
-    u8* output = memory.GetPointer(buf.address);
+    std::size_t bytes_per_pixel = 2;
+    if (output_format == OutputFormat::RGBA8) {
+        bytes_per_pixel = 4;
+    } else if (output_format == OutputFormat::RGB8) {
+        bytes_per_pixel = 3;
+    }
+    // Transfer units are always written whole, each followed by a gap
+    const std::size_t transfer_unit = std::max<std::size_t>(buf.transfer_unit, 1);
+    const std::size_t num_units =
+        (amount_of_data * bytes_per_pixel + transfer_unit - 1) / transfer_unit;
+    u8* output = memory.GetPointerForWrite(buf.address, num_units * (transfer_unit + buf.gap));
 
     while (amount_of_data > 0) {
         u8* unit_end = output + buf.transfer_unit;
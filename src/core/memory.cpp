@@ -2,56 +2,150 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstring>
+#include <mutex>
+#include <new>
+#include <utility>
 #include "audio_core/dsp_interface.h"
+#include "common/alignment.h"
 #include "common/assert.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "common/swap.h"
 #include "core/arm/arm_interface.h"
 #include "core/core.h"
+#include "core/dirty_page_tracker.h"
 #include "core/hle/kernel/memory.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/lock.h"
 #include "core/memory.h"
+#include "video_core/gpu_thread.h"
 #include "video_core/renderer_base.h"
 #include "video_core/video_core.h"
 
 namespace Memory {
 
+PageTable::PageTable() {
+    // calloc leaves large allocations to zero-filled pages that are only committed once written
+    pointers.reset(static_cast<PointerArray*>(std::calloc(1, sizeof(PointerArray))));
+    if (!pointers)
+        throw std::bad_alloc();
+}
+
+PageTable::PageTable(const PageTable& other) : PageTable() {
+    special_regions = other.special_regions;
+    for (std::size_t block = 0; block < NUM_ATTRIBUTE_BLOCKS; ++block) {
+        if (!other.attribute_blocks[block])
+            continue;
+
+        attribute_blocks[block] = std::make_unique<AttributeBlock>(*other.attribute_blocks[block]);
+        const std::size_t first_page = block * PAGES_PER_ATTRIBUTE_BLOCK;
+        std::copy_n(other.pointers->begin() + first_page, PAGES_PER_ATTRIBUTE_BLOCK,
+                    pointers->begin() + first_page);
+        if (other.tracked_pointer_blocks[block]) {
+            tracked_pointer_blocks[block] =
+                std::make_unique<TrackedPointerBlock>(*other.tracked_pointer_blocks[block]);
+        }
+    }
+}
+
+PageTable::~PageTable() = default;
+
+void PageTable::Clear() {
+    // Pages outside of the attribute blocks never had a pointer
+    for (std::size_t block = 0; block < NUM_ATTRIBUTE_BLOCKS; ++block) {
+        if (!attribute_blocks[block])
+            continue;
+
+        attribute_blocks[block].reset();
+        tracked_pointer_blocks[block].reset();
+        const std::size_t first_page = block * PAGES_PER_ATTRIBUTE_BLOCK;
+        std::fill_n(pointers->begin() + first_page, PAGES_PER_ATTRIBUTE_BLOCK, nullptr);
+    }
+}
+
+void PageTable::ProtectPage(std::size_t page) {
+    DEBUG_ASSERT(GetAttribute(page) == PageType::Memory);
+    auto& block = tracked_pointer_blocks[page / PAGES_PER_ATTRIBUTE_BLOCK];
+    if (!block) {
+        block = std::make_unique<TrackedPointerBlock>();
+    }
+    (*block)[page % PAGES_PER_ATTRIBUTE_BLOCK] = (*pointers)[page];
+    SetPage(page, nullptr, PageType::WriteTrackedMemory);
+}
+
+void PageTable::UnprotectPage(std::size_t page) {
+    DEBUG_ASSERT(GetAttribute(page) == PageType::WriteTrackedMemory);
+    SetPage(page, GetTrackedPointer(page), PageType::Memory);
+}
+
+/// A physical memory region the rasterizer can cache, as mapped 1:1 in every process
+struct RasterizerCacheableRegion {
+    PAddr paddr;
+    u32 size;
+    VAddr vaddr;
+};
+
+/// Both linear heaps alias FCRAM, so FCRAM pages can have two virtual addresses
+constexpr std::array<RasterizerCacheableRegion, 3> rasterizer_cacheable_regions{{
+    {VRAM_PADDR, VRAM_SIZE, VRAM_VADDR},
+    {FCRAM_PADDR, FCRAM_SIZE, LINEAR_HEAP_VADDR},
+    {FCRAM_PADDR, FCRAM_N3DS_SIZE, NEW_LINEAR_HEAP_VADDR},
+}};
+
+/// Tracks which physical pages of VRAM and FCRAM are cached by the rasterizer, one bit per page
 class RasterizerCacheMarker {
 public:
-    void Mark(VAddr addr, bool cached) {
-        bool* p = At(addr);
-        if (p)
-            *p = cached;
+    /// Marks the given number of pages starting at a page-aligned physical address
+    void Mark(PAddr paddr, u32 num_pages, bool cached) {
+        if (paddr >= VRAM_PADDR && paddr < VRAM_PADDR_END) {
+            SetBits(vram, (paddr - VRAM_PADDR) / PAGE_SIZE, num_pages, cached);
+        } else if (paddr >= FCRAM_PADDR && paddr < FCRAM_N3DS_PADDR_END) {
+            SetBits(fcram, (paddr - FCRAM_PADDR) / PAGE_SIZE, num_pages, cached);
+        }
     }
 
-    bool IsCached(VAddr addr) {
-        bool* p = At(addr);
-        if (p)
-            return *p;
+    bool IsCached(VAddr addr) const {
+        for (const auto& region : rasterizer_cacheable_regions) {
+            if (addr >= region.vaddr && addr - region.vaddr < region.size) {
+                const PAddr paddr = region.paddr + (addr - region.vaddr);
+                if (region.paddr == VRAM_PADDR) {
+                    return TestBit(vram, (paddr - VRAM_PADDR) / PAGE_SIZE);
+                }
+                return TestBit(fcram, (paddr - FCRAM_PADDR) / PAGE_SIZE);
+            }
+        }
         return false;
     }
 
 private:
-    bool* At(VAddr addr) {
-        if (addr >= VRAM_VADDR && addr < VRAM_VADDR_END) {
-            return &vram[(addr - VRAM_VADDR) / PAGE_SIZE];
-        }
-        if (addr >= LINEAR_HEAP_VADDR && addr < LINEAR_HEAP_VADDR_END) {
-            return &linear_heap[(addr - LINEAR_HEAP_VADDR) / PAGE_SIZE];
-        }
-        if (addr >= NEW_LINEAR_HEAP_VADDR && addr < NEW_LINEAR_HEAP_VADDR_END) {
-            return &new_linear_heap[(addr - NEW_LINEAR_HEAP_VADDR) / PAGE_SIZE];
+    template <std::size_t N>
+    static bool TestBit(const std::array<u64, N>& bits, std::size_t index) {
+        return ((bits[index / 64] >> (index % 64)) & 1) != 0;
+    }
+
+    template <std::size_t N>
+    static void SetBits(std::array<u64, N>& bits, std::size_t first, std::size_t count,
+                        bool value) {
+        while (count > 0) {
+            const std::size_t shift = first % 64;
+            const std::size_t length = std::min<std::size_t>(64 - shift, count);
+            const u64 mask = (length == 64 ? ~0ULL : (1ULL << length) - 1) << shift;
+            if (value) {
+                bits[first / 64] |= mask;
+            } else {
+                bits[first / 64] &= ~mask;
+            }
+            first += length;
+            count -= length;
         }
-        return nullptr;
     }
 
-    std::array<bool, VRAM_SIZE / PAGE_SIZE> vram{};
-    std::array<bool, LINEAR_HEAP_SIZE / PAGE_SIZE> linear_heap{};
-    std::array<bool, NEW_LINEAR_HEAP_SIZE / PAGE_SIZE> new_linear_heap{};
+    std::array<u64, VRAM_SIZE / PAGE_SIZE / 64> vram{};
+    std::array<u64, FCRAM_N3DS_SIZE / PAGE_SIZE / 64> fcram{};
 };
 
 class MemorySystem::Impl {
@@ -66,8 +160,78 @@ public:
     RasterizerCacheMarker cache_marker;
     std::vector<PageTable*> page_table_list;
 
+    struct PendingMark {
+        PAddr start;
+        u32 size;
+        bool cached;
+    };
+    /// Marks requested by the GPU thread. The page tables are only patched on the emulation thread,
+    /// which reads them without synchronization, so these wait for ApplyPendingRasterizerMarks.
+    std::vector<PendingMark> pending_marks;
+    std::mutex pending_marks_mutex;
+    std::atomic_bool has_pending_marks{false};
+
+    /// Only allocated while dirty page tracking is enabled, so that the slow paths reporting
+    /// writes to it only pay for a null check otherwise
+    std::unique_ptr<DirtyPageTracker> dirty_page_tracker;
+    /// Pages of the registered page tables that were written since the tracker started its current
+    /// epoch. They are write-protected again once it starts the next one.
+    std::vector<std::pair<PageTable*, u32>> unprotected_pages;
+
     ARM_Interface* cpu = nullptr;
     AudioCore::DspInterface* dsp = nullptr;
+
+    /// Returns whether the host memory is part of the memory the dirty page tracker covers
+    bool IsTrackedMemory(const u8* pointer) const {
+        return (pointer >= fcram.get() && pointer < fcram.get() + FCRAM_N3DS_SIZE) ||
+               (pointer >= vram.get() && pointer < vram.get() + VRAM_SIZE);
+    }
+
+    /// Write-protects the page if it is a `Memory` page backed by FCRAM or VRAM
+    void ProtectPage(PageTable& page_table, u32 page) {
+        if (page_table.GetAttribute(page) == PageType::Memory &&
+            IsTrackedMemory(page_table.GetPointer(page))) {
+            page_table.ProtectPage(page);
+        }
+    }
+
+    /**
+     * Reports a write to a write-protected page and lifts the protection until the next epoch, so
+     * that further writes take the fast paths again.
+     * @returns the memory pointer of the page
+     */
+    u8* UnprotectPageForWrite(PageTable& page_table, u32 page) {
+        u8* pointer = page_table.GetTrackedPointer(page);
+        page_table.UnprotectPage(page);
+        if (dirty_page_tracker) {
+            dirty_page_tracker->MarkDirty(pointer, PAGE_SIZE);
+            unprotected_pages.emplace_back(&page_table, page);
+        }
+        return pointer;
+    }
+
+    /// Write-protects the pages written during the epoch that the tracker just ended
+    void ReprotectPages() {
+        for (const auto& [page_table, page] : unprotected_pages) {
+            ProtectPage(*page_table, page);
+        }
+        unprotected_pages.clear();
+    }
+
+    /// Calls the function with every page of the registered page tables
+    template <typename Func>
+    void ForEachRegisteredPage(Func&& func) {
+        for (PageTable* page_table : page_table_list) {
+            for (u32 page = 0; page < PAGE_TABLE_NUM_ENTRIES;
+                 page += PageTable::PAGES_PER_ATTRIBUTE_BLOCK) {
+                if (!page_table->HasAttributeBlock(page))
+                    continue;
+                for (u32 i = 0; i < PageTable::PAGES_PER_ATTRIBUTE_BLOCK; ++i) {
+                    func(*page_table, page + i);
+                }
+            }
+        }
+    }
 };
 
 MemorySystem::MemorySystem() : impl(std::make_unique<Impl>()) {}
@@ -95,17 +259,32 @@ void MemorySystem::MapPages(PageTable& page_table, u32 base, u32 size, u8* memor
     RasterizerFlushVirtualRegion(base << PAGE_BITS, size * PAGE_SIZE,
                                  FlushMode::FlushAndInvalidate);
 
+    // New pages are write-protected right away while the tracker records writes. Page tables that
+    // aren't registered are never protected, as the tracker can't reach them to lift it.
+    const bool protect =
+        impl->dirty_page_tracker && type == PageType::Memory &&
+        std::find(impl->page_table_list.begin(), impl->page_table_list.end(), &page_table) !=
+            impl->page_table_list.end();
+
     u32 end = base + size;
     while (base != end) {
         ASSERT_MSG(base < PAGE_TABLE_NUM_ENTRIES, "out of range mapping at {:08X}", base);
 
-        page_table.attributes[base] = type;
-        page_table.pointers[base] = memory;
+        if (type == PageType::Unmapped && !page_table.HasAttributeBlock(base)) {
+            // Nothing is mapped up to the end of the attribute block
+            base = std::min(
+                end, Common::AlignUp<u32>(base + 1, PageTable::PAGES_PER_ATTRIBUTE_BLOCK));
+            continue;
+        }
 
         // If the memory to map is already rasterizer-cached, mark the page
         if (type == PageType::Memory && impl->cache_marker.IsCached(base * PAGE_SIZE)) {
-            page_table.attributes[base] = PageType::RasterizerCachedMemory;
-            page_table.pointers[base] = nullptr;
+            page_table.SetPage(base, nullptr, PageType::RasterizerCachedMemory);
+        } else {
+            page_table.SetPage(base, memory, type);
+            if (protect) {
+                impl->ProtectPage(page_table, base);
+            }
         }
 
         base += 1;
@@ -155,6 +334,10 @@ void MemorySystem::RegisterPageTable(PageTable* page_table) {
 void MemorySystem::UnregisterPageTable(PageTable* page_table) {
     impl->page_table_list.erase(
         std::find(impl->page_table_list.begin(), impl->page_table_list.end(), page_table));
+    impl->unprotected_pages.erase(
+        std::remove_if(impl->unprotected_pages.begin(), impl->unprotected_pages.end(),
+                       [&](const auto& entry) { return entry.first == page_table; }),
+        impl->unprotected_pages.end());
 }
 
 /**
@@ -175,7 +358,7 @@ T ReadMMIO(MMIORegionPointer mmio_handler, VAddr addr);
 
 template <typename T>
 T MemorySystem::Read(const VAddr vaddr) {
-    const u8* page_pointer = impl->current_page_table->pointers[vaddr >> PAGE_BITS];
+    const u8* page_pointer = impl->current_page_table->GetPointer(vaddr >> PAGE_BITS);
     if (page_pointer) {
         // NOTE: Avoid adding any extra logic to this fast-path block
         T value;
@@ -183,7 +366,7 @@ T MemorySystem::Read(const VAddr vaddr) {
         return value;
     }
 
-    PageType type = impl->current_page_table->attributes[vaddr >> PAGE_BITS];
+    PageType type = impl->current_page_table->GetAttribute(vaddr >> PAGE_BITS);
     switch (type) {
     case PageType::Unmapped:
         LOG_ERROR(HW_Memory, "unmapped Read{} @ 0x{:08X}", sizeof(T) * 8, vaddr);
@@ -198,6 +381,12 @@ T MemorySystem::Read(const VAddr vaddr) {
         std::memcpy(&value, GetPointerForRasterizerCache(vaddr), sizeof(T));
         return value;
     }
+    case PageType::WriteTrackedMemory: {
+        const u8* pointer = impl->current_page_table->GetTrackedPointer(vaddr >> PAGE_BITS);
+        T value;
+        std::memcpy(&value, &pointer[vaddr & PAGE_MASK], sizeof(T));
+        return value;
+    }
     case PageType::Special:
         return ReadMMIO<T>(GetMMIOHandler(*impl->current_page_table, vaddr), vaddr);
     default:
@@ -210,14 +399,14 @@ void WriteMMIO(MMIORegionPointer mmio_handler, VAddr addr, const T data);
 
 template <typename T>
 void MemorySystem::Write(const VAddr vaddr, const T data) {
-    u8* page_pointer = impl->current_page_table->pointers[vaddr >> PAGE_BITS];
+    u8* page_pointer = impl->current_page_table->GetPointer(vaddr >> PAGE_BITS);
     if (page_pointer) {
         // NOTE: Avoid adding any extra logic to this fast-path block
         std::memcpy(&page_pointer[vaddr & PAGE_MASK], &data, sizeof(T));
         return;
     }
 
-    PageType type = impl->current_page_table->attributes[vaddr >> PAGE_BITS];
+    PageType type = impl->current_page_table->GetAttribute(vaddr >> PAGE_BITS);
     switch (type) {
     case PageType::Unmapped:
         LOG_ERROR(HW_Memory, "unmapped Write{} 0x{:08X} @ 0x{:08X}", sizeof(data) * 8, (u32)data,
@@ -228,7 +417,16 @@ void MemorySystem::Write(const VAddr vaddr, const T data) {
         break;
     case PageType::RasterizerCachedMemory: {
         RasterizerFlushVirtualRegion(vaddr, sizeof(T), FlushMode::Invalidate);
-        std::memcpy(GetPointerForRasterizerCache(vaddr), &data, sizeof(T));
+        u8* pointer = GetPointerForRasterizerCache(vaddr);
+        std::memcpy(pointer, &data, sizeof(T));
+        if (impl->dirty_page_tracker) {
+            impl->dirty_page_tracker->MarkDirty(pointer, sizeof(T));
+        }
+        break;
+    }
+    case PageType::WriteTrackedMemory: {
+        u8* pointer = impl->UnprotectPageForWrite(*impl->current_page_table, vaddr >> PAGE_BITS);
+        std::memcpy(&pointer[vaddr & PAGE_MASK], &data, sizeof(T));
         break;
     }
     case PageType::Special:
@@ -242,14 +440,15 @@ void MemorySystem::Write(const VAddr vaddr, const T data) {
 bool IsValidVirtualAddress(const Kernel::Process& process, const VAddr vaddr) {
     auto& page_table = process.vm_manager.page_table;
 
-    const u8* page_pointer = page_table.pointers[vaddr >> PAGE_BITS];
+    const u8* page_pointer = page_table.GetPointer(vaddr >> PAGE_BITS);
     if (page_pointer)
         return true;
 
-    if (page_table.attributes[vaddr >> PAGE_BITS] == PageType::RasterizerCachedMemory)
+    const PageType type = page_table.GetAttribute(vaddr >> PAGE_BITS);
+    if (type == PageType::RasterizerCachedMemory || type == PageType::WriteTrackedMemory)
         return true;
 
-    if (page_table.attributes[vaddr >> PAGE_BITS] != PageType::Special)
+    if (type != PageType::Special)
         return false;
 
     MMIORegionPointer mmio_region = GetMMIOHandler(page_table, vaddr);
@@ -265,20 +464,48 @@ bool MemorySystem::IsValidPhysicalAddress(const PAddr paddr) {
 }
 
 u8* MemorySystem::GetPointer(const VAddr vaddr) {
-    u8* page_pointer = impl->current_page_table->pointers[vaddr >> PAGE_BITS];
+    u8* page_pointer = impl->current_page_table->GetPointer(vaddr >> PAGE_BITS);
     if (page_pointer) {
         return page_pointer + (vaddr & PAGE_MASK);
     }
 
-    if (impl->current_page_table->attributes[vaddr >> PAGE_BITS] ==
-        PageType::RasterizerCachedMemory) {
+    switch (impl->current_page_table->GetAttribute(vaddr >> PAGE_BITS)) {
+    case PageType::RasterizerCachedMemory:
         return GetPointerForRasterizerCache(vaddr);
+    case PageType::WriteTrackedMemory:
+        // The caller may write through the pointer, so the page is reported as written
+        return impl->UnprotectPageForWrite(*impl->current_page_table, vaddr >> PAGE_BITS) +
+               (vaddr & PAGE_MASK);
+    default:
+        break;
     }
 
     LOG_ERROR(HW_Memory, "unknown GetPointer @ 0x{:08x}", vaddr);
     return nullptr;
 }
 
+u8* MemorySystem::GetPointerForWrite(const VAddr vaddr, const std::size_t size) {
+    auto& page_table = *impl->current_page_table;
+    const std::size_t end_page = (vaddr + size + PAGE_MASK) >> PAGE_BITS;
+    for (u32 page = vaddr >> PAGE_BITS; page < end_page; ++page) {
+        switch (page_table.GetAttribute(page)) {
+        case PageType::WriteTrackedMemory:
+            impl->UnprotectPageForWrite(page_table, page);
+            break;
+        case PageType::RasterizerCachedMemory:
+            if (impl->dirty_page_tracker) {
+                impl->dirty_page_tracker->MarkDirty(
+                    GetPointerForRasterizerCache(static_cast<VAddr>(page << PAGE_BITS)),
+                    PAGE_SIZE);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    return GetPointer(vaddr);
+}
+
 std::string MemorySystem::ReadCString(VAddr vaddr, std::size_t max_length) {
     std::string string;
     string.reserve(max_length);
@@ -341,70 +568,117 @@ u8* MemorySystem::GetPhysicalPointer(PAddr address) {
     return target_pointer;
 }
 
-/// For a rasterizer-accessible PAddr, gets a list of all possible VAddr
-static std::vector<VAddr> PhysicalToVirtualAddressForRasterizer(PAddr addr) {
-    if (addr >= VRAM_PADDR && addr < VRAM_PADDR_END) {
-        return {addr - VRAM_PADDR + VRAM_VADDR};
+void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached) {
+    if (start == 0) {
+        return;
+    }
+
+    if (VideoCore::g_gpu_thread && VideoCore::g_gpu_thread->IsGPUThread()) {
+        std::lock_guard lock{impl->pending_marks_mutex};
+        impl->pending_marks.push_back({start, size, cached});
+        impl->has_pending_marks = true;
+        return;
+    }
+
+    ApplyRasterizerMark(start, size, cached);
+}
+
+void MemorySystem::ApplyPendingRasterizerMarks() {
+    if (!impl->has_pending_marks) {
+        return;
     }
-    if (addr >= FCRAM_PADDR && addr < FCRAM_PADDR_END) {
-        return {addr - FCRAM_PADDR + LINEAR_HEAP_VADDR, addr - FCRAM_PADDR + NEW_LINEAR_HEAP_VADDR};
+
+    std::vector<Impl::PendingMark> marks;
+    {
+        std::lock_guard lock{impl->pending_marks_mutex};
+        marks.swap(impl->pending_marks);
+        impl->has_pending_marks = false;
     }
-    if (addr >= FCRAM_PADDR_END && addr < FCRAM_N3DS_PADDR_END) {
-        return {addr - FCRAM_PADDR + NEW_LINEAR_HEAP_VADDR};
+
+    // Marks of the same pages must be applied in the order they were made
+    for (const auto& mark : marks) {
+        ApplyRasterizerMark(mark.start, mark.size, mark.cached);
     }
+}
+
+void MemorySystem::ApplyRasterizerMark(PAddr start, u32 size, bool cached) {
+
+    const u32 first_page = start >> PAGE_BITS;
+    const u32 num_pages = ((start + size - 1) >> PAGE_BITS) - first_page + 1;
+
+    // Returns the first page and the number of pages of the region that overlap the range
+    const auto get_overlap = [&](PAddr region_paddr, u32 region_size) -> std::pair<u32, u32> {
+        const u32 region_first_page = region_paddr >> PAGE_BITS;
+        const u32 overlap_first = std::max(first_page, region_first_page);
+        const u32 overlap_end =
+            std::min(first_page + num_pages, region_first_page + (region_size >> PAGE_BITS));
+        return {overlap_first, overlap_end > overlap_first ? overlap_end - overlap_first : 0};
+    };
+
     // While the physical <-> virtual mapping is 1:1 for the regions supported by the cache,
     // some games (like Pokemon Super Mystery Dungeon) will try to use textures that go beyond
     // the end address of VRAM, causing the Virtual->Physical translation to fail when flushing
     // parts of the texture.
-    LOG_ERROR(HW_Memory, "Trying to use invalid physical address for rasterizer: {:08X}", addr);
-    return {};
-}
-
-void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached) {
-    if (start == 0) {
-        return;
+    const u32 valid_pages = get_overlap(VRAM_PADDR, VRAM_SIZE).second +
+                            get_overlap(FCRAM_PADDR, FCRAM_N3DS_SIZE).second;
+    if (valid_pages != num_pages) {
+        LOG_ERROR(HW_Memory, "Trying to use invalid physical address for rasterizer: {:08X}-{:08X}",
+                  start, start + size);
     }
 
-    u32 num_pages = ((start + size - 1) >> PAGE_BITS) - (start >> PAGE_BITS) + 1;
-    PAddr paddr = start;
+    struct VirtualRun {
+        u32 first_page;
+        u32 num_pages;
+    };
+    std::array<VirtualRun, rasterizer_cacheable_regions.size()> runs;
+    std::size_t num_runs = 0;
+
+    for (const auto& region : rasterizer_cacheable_regions) {
+        const auto [overlap_first, overlap_pages] = get_overlap(region.paddr, region.size);
+        if (overlap_pages == 0)
+            continue;
+
+        impl->cache_marker.Mark(overlap_first << PAGE_BITS, overlap_pages, cached);
+        runs[num_runs++] = {(region.vaddr >> PAGE_BITS) + overlap_first -
+                                (region.paddr >> PAGE_BITS),
+                            overlap_pages};
+    }
 
-    for (unsigned i = 0; i < num_pages; ++i, paddr += PAGE_SIZE) {
-        for (VAddr vaddr : PhysicalToVirtualAddressForRasterizer(paddr)) {
-            impl->cache_marker.Mark(vaddr, cached);
-            for (PageTable* page_table : impl->page_table_list) {
-                PageType& page_type = page_table->attributes[vaddr >> PAGE_BITS];
+    // Patch the page tables one after the other, each over every alias of the range
+    for (PageTable* page_table : impl->page_table_list) {
+        for (std::size_t i = 0; i < num_runs; ++i) {
+            const u32 end_page = runs[i].first_page + runs[i].num_pages;
+            u32 page = runs[i].first_page;
+            while (page < end_page) {
+                if (!page_table->HasAttributeBlock(page)) {
+                    // It is not necessary for a process to have this region mapped into its
+                    // address space, for example, a system module need not have a VRAM mapping.
+                    page = Common::AlignUp<u32>(page + 1, PageTable::PAGES_PER_ATTRIBUTE_BLOCK);
+                    continue;
+                }
 
-                if (cached) {
+                switch (page_table->GetAttribute(page)) {
+                case PageType::Unmapped:
+                    break;
+                case PageType::Memory:
+                case PageType::WriteTrackedMemory:
                     // Switch page type to cached if now cached
-                    switch (page_type) {
-                    case PageType::Unmapped:
-                        // It is not necessary for a process to have this region mapped into its
-                        // address space, for example, a system module need not have a VRAM mapping.
-                        break;
-                    case PageType::Memory:
-                        page_type = PageType::RasterizerCachedMemory;
-                        page_table->pointers[vaddr >> PAGE_BITS] = nullptr;
-                        break;
-                    default:
-                        UNREACHABLE();
-                    }
-                } else {
+                    ASSERT(cached);
+                    page_table->SetPage(page, nullptr, PageType::RasterizerCachedMemory);
+                    break;
+                case PageType::RasterizerCachedMemory:
                     // Switch page type to uncached if now uncached
-                    switch (page_type) {
-                    case PageType::Unmapped:
-                        // It is not necessary for a process to have this region mapped into its
-                        // address space, for example, a system module need not have a VRAM mapping.
-                        break;
-                    case PageType::RasterizerCachedMemory: {
-                        page_type = PageType::Memory;
-                        page_table->pointers[vaddr >> PAGE_BITS] =
-                            GetPointerForRasterizerCache(vaddr & ~PAGE_MASK);
-                        break;
-                    }
-                    default:
-                        UNREACHABLE();
+                    ASSERT(!cached);
+                    page_table->SetPage(page, GetPointerForRasterizerCache(page << PAGE_BITS),
+                                        PageType::Memory);
+                    if (impl->dirty_page_tracker) {
+                        page_table->ProtectPage(page);
                     }
+                    break;
+                default:
+                    UNREACHABLE();
                 }
+                ++page;
             }
         }
     }
@@ -415,6 +689,11 @@ void RasterizerFlushRegion(PAddr start, u32 size) {
         return;
     }
 
+    if (VideoCore::g_gpu_thread) {
+        VideoCore::g_gpu_thread->FlushRegion(start, size);
+        return;
+    }
+
     VideoCore::g_renderer->Rasterizer()->FlushRegion(start, size);
 }
 
@@ -423,6 +702,11 @@ void RasterizerInvalidateRegion(PAddr start, u32 size) {
         return;
     }
 
+    if (VideoCore::g_gpu_thread) {
+        VideoCore::g_gpu_thread->InvalidateRegion(start, size);
+        return;
+    }
+
     VideoCore::g_renderer->Rasterizer()->InvalidateRegion(start, size);
 }
 
@@ -433,6 +717,11 @@ void RasterizerFlushAndInvalidateRegion(PAddr start, u32 size) {
         return;
     }
 
+    if (VideoCore::g_gpu_thread) {
+        VideoCore::g_gpu_thread->FlushAndInvalidateRegion(start, size);
+        return;
+    }
+
     VideoCore::g_renderer->Rasterizer()->FlushAndInvalidateRegion(start, size);
 }
 
@@ -456,16 +745,15 @@ void RasterizerFlushVirtualRegion(VAddr start, u32 size, FlushMode mode) {
         PAddr physical_start = paddr_region_start + (overlap_start - region_start);
         u32 overlap_size = overlap_end - overlap_start;
 
-        auto* rasterizer = VideoCore::g_renderer->Rasterizer();
         switch (mode) {
         case FlushMode::Flush:
-            rasterizer->FlushRegion(physical_start, overlap_size);
+            RasterizerFlushRegion(physical_start, overlap_size);
             break;
         case FlushMode::Invalidate:
-            rasterizer->InvalidateRegion(physical_start, overlap_size);
+            RasterizerInvalidateRegion(physical_start, overlap_size);
             break;
         case FlushMode::FlushAndInvalidate:
-            rasterizer->FlushAndInvalidateRegion(physical_start, overlap_size);
+            RasterizerFlushAndInvalidateRegion(physical_start, overlap_size);
             break;
         }
     };
@@ -491,19 +779,70 @@ u64 MemorySystem::Read64(const VAddr addr) {
     return Read<u64_le>(addr);
 }
 
-void MemorySystem::ReadBlock(const Kernel::Process& process, const VAddr src_addr,
-                             void* dest_buffer, const std::size_t size) {
-    auto& page_table = process.vm_manager.page_table;
+/**
+ * Splits a block of the address space of a page table into spans of pages that can be accessed
+ * together: consecutive pages of the same type whose host memory is contiguous, or single pages of
+ * IO regions. The visitor is called for each span with its address, its size, its page type and,
+ * for memory pages, the host pointer to its start.
+ */
+template <typename Visitor>
+void MemorySystem::WalkBlock(const PageTable& page_table, const VAddr start_addr,
+                             const std::size_t size, Visitor&& visitor) {
+    // Write-protected pages are accessed like any memory page, the visitors report their writes
+    const auto get_type = [&](std::size_t page_index) {
+        const PageType type = page_table.GetAttribute(page_index);
+        return type == PageType::WriteTrackedMemory ? PageType::Memory : type;
+    };
+    const auto get_host_pointer = [&](std::size_t page_index, PageType type) -> u8* {
+        switch (type) {
+        case PageType::Memory:
+            if (page_table.GetAttribute(page_index) == PageType::WriteTrackedMemory)
+                return page_table.GetTrackedPointer(page_index);
+            DEBUG_ASSERT(page_table.GetPointer(page_index));
+            return page_table.GetPointer(page_index);
+        case PageType::RasterizerCachedMemory:
+            return GetPointerForRasterizerCache(static_cast<VAddr>(page_index << PAGE_BITS));
+        default:
+            return nullptr;
+        }
+    };
 
     std::size_t remaining_size = size;
-    std::size_t page_index = src_addr >> PAGE_BITS;
-    std::size_t page_offset = src_addr & PAGE_MASK;
+    std::size_t page_index = start_addr >> PAGE_BITS;
+    std::size_t page_offset = start_addr & PAGE_MASK;
 
     while (remaining_size > 0) {
-        const std::size_t copy_amount = std::min(PAGE_SIZE - page_offset, remaining_size);
-        const VAddr current_vaddr = static_cast<VAddr>((page_index << PAGE_BITS) + page_offset);
+        const VAddr span_vaddr = static_cast<VAddr>((page_index << PAGE_BITS) + page_offset);
+        const PageType type = get_type(page_index);
+        u8* const span_pointer = get_host_pointer(page_index, type);
+        std::size_t span_size = std::min(PAGE_SIZE - page_offset, remaining_size);
+        ++page_index;
+
+        while (type != PageType::Special && span_size < remaining_size &&
+               get_type(page_index) == type) {
+            if (span_pointer != nullptr &&
+                get_host_pointer(page_index, type) != span_pointer + page_offset + span_size) {
+                break;
+            }
+            span_size += std::min<std::size_t>(PAGE_SIZE, remaining_size - span_size);
+            ++page_index;
+        }
+
+        visitor(span_vaddr, span_size, type,
+                span_pointer != nullptr ? span_pointer + page_offset : nullptr);
+
+        page_offset = 0;
+        remaining_size -= span_size;
+    }
+}
+
+void MemorySystem::ReadBlock(const Kernel::Process& process, const VAddr src_addr,
+                             void* dest_buffer, const std::size_t size) {
+    auto& page_table = process.vm_manager.page_table;
 
-        switch (page_table.attributes[page_index]) {
+    const auto visit_span = [&](VAddr current_vaddr, std::size_t copy_amount, PageType type,
+                                u8* src_ptr) {
+        switch (type) {
         case PageType::Unmapped: {
             LOG_ERROR(HW_Memory,
                       "unmapped ReadBlock @ 0x{:08X} (start address = 0x{:08X}, size = {})",
@@ -512,9 +851,6 @@ void MemorySystem::ReadBlock(const Kernel::Process& process, const VAddr src_add
             break;
         }
         case PageType::Memory: {
-            DEBUG_ASSERT(page_table.pointers[page_index]);
-
-            const u8* src_ptr = page_table.pointers[page_index] + page_offset;
             std::memcpy(dest_buffer, src_ptr, copy_amount);
             break;
         }
@@ -527,18 +863,17 @@ void MemorySystem::ReadBlock(const Kernel::Process& process, const VAddr src_add
         case PageType::RasterizerCachedMemory: {
             RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
                                          FlushMode::Flush);
-            std::memcpy(dest_buffer, GetPointerForRasterizerCache(current_vaddr), copy_amount);
+            std::memcpy(dest_buffer, src_ptr, copy_amount);
             break;
         }
         default:
             UNREACHABLE();
         }
 
-        page_index++;
-        page_offset = 0;
         dest_buffer = static_cast<u8*>(dest_buffer) + copy_amount;
-        remaining_size -= copy_amount;
-    }
+    };
+
+    WalkBlock(page_table, src_addr, size, visit_span);
 }
 
 void MemorySystem::Write8(const VAddr addr, const u8 data) {
@@ -560,15 +895,10 @@ void MemorySystem::Write64(const VAddr addr, const u64 data) {
 void MemorySystem::WriteBlock(const Kernel::Process& process, const VAddr dest_addr,
                               const void* src_buffer, const std::size_t size) {
     auto& page_table = process.vm_manager.page_table;
-    std::size_t remaining_size = size;
-    std::size_t page_index = dest_addr >> PAGE_BITS;
-    std::size_t page_offset = dest_addr & PAGE_MASK;
-
-    while (remaining_size > 0) {
-        const std::size_t copy_amount = std::min(PAGE_SIZE - page_offset, remaining_size);
-        const VAddr current_vaddr = static_cast<VAddr>((page_index << PAGE_BITS) + page_offset);
 
-        switch (page_table.attributes[page_index]) {
+    const auto visit_span = [&](VAddr current_vaddr, std::size_t copy_amount, PageType type,
+                                u8* dest_ptr) {
+        switch (type) {
         case PageType::Unmapped: {
             LOG_ERROR(HW_Memory,
                       "unmapped WriteBlock @ 0x{:08X} (start address = 0x{:08X}, size = {})",
@@ -576,10 +906,10 @@ void MemorySystem::WriteBlock(const Kernel::Process& process, const VAddr dest_a
             break;
         }
         case PageType::Memory: {
-            DEBUG_ASSERT(page_table.pointers[page_index]);
-
-            u8* dest_ptr = page_table.pointers[page_index] + page_offset;
             std::memcpy(dest_ptr, src_buffer, copy_amount);
+            if (impl->dirty_page_tracker) {
+                impl->dirty_page_tracker->MarkDirty(dest_ptr, copy_amount);
+            }
             break;
         }
         case PageType::Special: {
@@ -591,34 +921,31 @@ void MemorySystem::WriteBlock(const Kernel::Process& process, const VAddr dest_a
         case PageType::RasterizerCachedMemory: {
             RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
                                          FlushMode::Invalidate);
-            std::memcpy(GetPointerForRasterizerCache(current_vaddr), src_buffer, copy_amount);
+            std::memcpy(dest_ptr, src_buffer, copy_amount);
+            if (impl->dirty_page_tracker) {
+                impl->dirty_page_tracker->MarkDirty(dest_ptr, copy_amount);
+            }
             break;
         }
         default:
             UNREACHABLE();
         }
 
-        page_index++;
-        page_offset = 0;
         src_buffer = static_cast<const u8*>(src_buffer) + copy_amount;
-        remaining_size -= copy_amount;
-    }
+    };
+
+    WalkBlock(page_table, dest_addr, size, visit_span);
 }
 
 void MemorySystem::ZeroBlock(const Kernel::Process& process, const VAddr dest_addr,
                              const std::size_t size) {
     auto& page_table = process.vm_manager.page_table;
-    std::size_t remaining_size = size;
-    std::size_t page_index = dest_addr >> PAGE_BITS;
-    std::size_t page_offset = dest_addr & PAGE_MASK;
 
     static const std::array<u8, PAGE_SIZE> zeros = {};
 
-    while (remaining_size > 0) {
-        const std::size_t copy_amount = std::min(PAGE_SIZE - page_offset, remaining_size);
-        const VAddr current_vaddr = static_cast<VAddr>((page_index << PAGE_BITS) + page_offset);
-
-        switch (page_table.attributes[page_index]) {
+    const auto visit_span = [&](VAddr current_vaddr, std::size_t copy_amount, PageType type,
+                                u8* dest_ptr) {
+        switch (type) {
         case PageType::Unmapped: {
             LOG_ERROR(HW_Memory,
                       "unmapped ZeroBlock @ 0x{:08X} (start address = 0x{:08X}, size = {})",
@@ -626,13 +953,14 @@ void MemorySystem::ZeroBlock(const Kernel::Process& process, const VAddr dest_ad
             break;
         }
         case PageType::Memory: {
-            DEBUG_ASSERT(page_table.pointers[page_index]);
-
-            u8* dest_ptr = page_table.pointers[page_index] + page_offset;
             std::memset(dest_ptr, 0, copy_amount);
+            if (impl->dirty_page_tracker) {
+                impl->dirty_page_tracker->MarkDirty(dest_ptr, copy_amount);
+            }
             break;
         }
         case PageType::Special: {
+            // IO spans never exceed a page
             MMIORegionPointer handler = GetMMIOHandler(page_table, current_vaddr);
             DEBUG_ASSERT(handler);
             handler->WriteBlock(current_vaddr, zeros.data(), copy_amount);
@@ -641,17 +969,18 @@ void MemorySystem::ZeroBlock(const Kernel::Process& process, const VAddr dest_ad
         case PageType::RasterizerCachedMemory: {
             RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
                                          FlushMode::Invalidate);
-            std::memset(GetPointerForRasterizerCache(current_vaddr), 0, copy_amount);
+            std::memset(dest_ptr, 0, copy_amount);
+            if (impl->dirty_page_tracker) {
+                impl->dirty_page_tracker->MarkDirty(dest_ptr, copy_amount);
+            }
             break;
         }
         default:
             UNREACHABLE();
         }
+    };
 
-        page_index++;
-        page_offset = 0;
-        remaining_size -= copy_amount;
-    }
+    WalkBlock(page_table, dest_addr, size, visit_span);
 }
 
 void MemorySystem::CopyBlock(const Kernel::Process& process, VAddr dest_addr, VAddr src_addr,
@@ -662,16 +991,22 @@ void MemorySystem::CopyBlock(const Kernel::Process& process, VAddr dest_addr, VA
 void MemorySystem::CopyBlock(const Kernel::Process& dest_process,
                              const Kernel::Process& src_process, VAddr dest_addr, VAddr src_addr,
                              std::size_t size) {
-    auto& page_table = src_process.vm_manager.page_table;
-    std::size_t remaining_size = size;
-    std::size_t page_index = src_addr >> PAGE_BITS;
-    std::size_t page_offset = src_addr & PAGE_MASK;
+    // Spans are copied front to back, so a destination overlapping the source would overwrite the
+    // data of later spans before they are read, and memcpy within a span would be undefined. Such
+    // copies go through a buffer instead, which gives them the semantics of memmove.
+    if (&dest_process == &src_process && dest_addr < src_addr + size &&
+        src_addr < dest_addr + size) {
+        std::vector<u8> buffer(size);
+        ReadBlock(src_process, src_addr, buffer.data(), size);
+        WriteBlock(dest_process, dest_addr, buffer.data(), size);
+        return;
+    }
 
-    while (remaining_size > 0) {
-        const std::size_t copy_amount = std::min(PAGE_SIZE - page_offset, remaining_size);
-        const VAddr current_vaddr = static_cast<VAddr>((page_index << PAGE_BITS) + page_offset);
+    auto& page_table = src_process.vm_manager.page_table;
 
-        switch (page_table.attributes[page_index]) {
+    const auto visit_span = [&](VAddr current_vaddr, std::size_t copy_amount, PageType type,
+                                u8* src_ptr) {
+        switch (type) {
         case PageType::Unmapped: {
             LOG_ERROR(HW_Memory,
                       "unmapped CopyBlock @ 0x{:08X} (start address = 0x{:08X}, size = {})",
@@ -680,8 +1015,6 @@ void MemorySystem::CopyBlock(const Kernel::Process& dest_process,
             break;
         }
         case PageType::Memory: {
-            DEBUG_ASSERT(page_table.pointers[page_index]);
-            const u8* src_ptr = page_table.pointers[page_index] + page_offset;
             WriteBlock(dest_process, dest_addr, src_ptr, copy_amount);
             break;
         }
@@ -696,20 +1029,17 @@ void MemorySystem::CopyBlock(const Kernel::Process& dest_process,
         case PageType::RasterizerCachedMemory: {
             RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
                                          FlushMode::Flush);
-            WriteBlock(dest_process, dest_addr, GetPointerForRasterizerCache(current_vaddr),
-                       copy_amount);
+            WriteBlock(dest_process, dest_addr, src_ptr, copy_amount);
             break;
         }
         default:
             UNREACHABLE();
         }
 
-        page_index++;
-        page_offset = 0;
         dest_addr += static_cast<VAddr>(copy_amount);
-        src_addr += static_cast<VAddr>(copy_amount);
-        remaining_size -= copy_amount;
-    }
+    };
+
+    WalkBlock(page_table, src_addr, size, visit_span);
 }
 
 template <>
@@ -766,4 +1096,30 @@ void MemorySystem::SetDSP(AudioCore::DspInterface& dsp) {
     impl->dsp = &dsp;
 }
 
+void MemorySystem::SetDirtyPageTracking(bool enabled) {
+    if (enabled == (impl->dirty_page_tracker != nullptr)) {
+        return;
+    }
+
+    if (!enabled) {
+        impl->dirty_page_tracker.reset();
+        impl->unprotected_pages.clear();
+        impl->ForEachRegisteredPage([](PageTable& page_table, u32 page) {
+            if (page_table.GetAttribute(page) == PageType::WriteTrackedMemory) {
+                page_table.UnprotectPage(page);
+            }
+        });
+        return;
+    }
+
+    impl->dirty_page_tracker = std::make_unique<DirtyPageTracker>(
+        impl->fcram.get(), impl->vram.get(), [this] { impl->ReprotectPages(); });
+    impl->ForEachRegisteredPage(
+        [this](PageTable& page_table, u32 page) { impl->ProtectPage(page_table, page); });
+}
+
+DirtyPageTracker* MemorySystem::GetDirtyPageTracker() const {
+    return impl->dirty_page_tracker.get();
+}
+
 } // namespace Memory
@@ -6,6 +6,7 @@
 
 #include <array>
 #include <cstddef>
+#include <cstdlib>
 #include <memory>
 #include <string>
 #include <vector>
@@ -24,6 +25,8 @@ class DspInterface;
 
 namespace Memory {
 
+class DirtyPageTracker;
+
 // Are defined in a system header
 #undef PAGE_SIZE
 #undef PAGE_MASK
@@ -36,7 +39,7 @@ const u32 PAGE_MASK = PAGE_SIZE - 1;
 const int PAGE_BITS = 12;
 const std::size_t PAGE_TABLE_NUM_ENTRIES = 1 << (32 - PAGE_BITS);
 
-enum class PageType {
+enum class PageType : u8 {
     /// Page is unmapped and should cause an access error.
     Unmapped,
     /// Page is mapped to regular memory. This is the only type you can get pointers to.
@@ -46,6 +49,9 @@ enum class PageType {
     RasterizerCachedMemory,
     /// Page is mapped to a I/O region. Writing and reading to this page is handled by functions.
     Special,
+    /// Page is mapped to regular memory, but its pointer is withheld so that the next write to it
+    /// can be reported to the dirty page tracker
+    WriteTrackedMemory,
 };
 
 struct SpecialRegion {
@@ -59,25 +65,98 @@ struct SpecialRegion {
  * mimics the way a real CPU page table works, but instead is optimized for minimal decoding and
  * fetching requirements when accessing. In the usual case of an access to regular memory, it only
  * requires an indexed fetch and a check for NULL.
+ *
+ * The page attributes are kept in second-level tables that are only allocated for the parts of the
+ * address space that get mapped, pages without one are unmapped. The pointer array stays flat, as
+ * the JIT indexes it directly, but it is allocated zeroed and only written for mapped pages, so the
+ * host only commits the parts of it that cover mapped regions.
  */
 struct PageTable {
-    /**
-     * Array of memory pointers backing each page. An entry can only be non-null if the
-     * corresponding entry in the `attributes` array is of type `Memory`.
-     */
-    std::array<u8*, PAGE_TABLE_NUM_ENTRIES> pointers;
+    using PointerArray = std::array<u8*, PAGE_TABLE_NUM_ENTRIES>;
+
+    /// Number of pages sharing a second-level attribute table (4 MiB of address space)
+    static constexpr std::size_t PAGES_PER_ATTRIBUTE_BLOCK = 1024;
+
+    PageTable();
+    /// Copies the mappings of another page table, which only touches the regions it has mapped
+    PageTable(const PageTable& other);
+    PageTable& operator=(const PageTable&) = delete;
+    ~PageTable();
+
+    /// Returns the memory pointer backing the page. It can only be non-null if the page is of type
+    /// `Memory`.
+    u8* GetPointer(std::size_t page) const {
+        return (*pointers)[page];
+    }
+
+    PageType GetAttribute(std::size_t page) const {
+        const auto& block = attribute_blocks[page / PAGES_PER_ATTRIBUTE_BLOCK];
+        return block ? (*block)[page % PAGES_PER_ATTRIBUTE_BLOCK] : PageType::Unmapped;
+    }
+
+    /// Sets the memory pointer and the attribute of the page. The pointer must be null unless the
+    /// attribute is `Memory`.
+    void SetPage(std::size_t page, u8* pointer, PageType type) {
+        auto& block = attribute_blocks[page / PAGES_PER_ATTRIBUTE_BLOCK];
+        if (!block) {
+            if (type == PageType::Unmapped)
+                return;
+            block = std::make_unique<AttributeBlock>();
+            block->fill(PageType::Unmapped);
+        }
+        (*block)[page % PAGES_PER_ATTRIBUTE_BLOCK] = type;
+        (*pointers)[page] = pointer;
+    }
+
+    /// Write-protects a `Memory` page: its pointer is put aside, so that accesses fall to the slow
+    /// paths, and it becomes `WriteTrackedMemory`.
+    void ProtectPage(std::size_t page);
+
+    /// Gives a `WriteTrackedMemory` page its pointer back and makes it `Memory` again
+    void UnprotectPage(std::size_t page);
+
+    /// Returns the memory pointer put aside by ProtectPage
+    u8* GetTrackedPointer(std::size_t page) const {
+        return (*tracked_pointer_blocks[page / PAGES_PER_ATTRIBUTE_BLOCK])
+            [page % PAGES_PER_ATTRIBUTE_BLOCK];
+    }
+
+    /// Returns whether anything has been mapped in the attribute block containing the page. If
+    /// not, all of its pages are unmapped.
+    bool HasAttributeBlock(std::size_t page) const {
+        return attribute_blocks[page / PAGES_PER_ATTRIBUTE_BLOCK] != nullptr;
+    }
+
+    /// Marks every page as unmapped and frees the second-level tables
+    void Clear();
+
+    /// Returns the flat pointer array, for the JIT
+    PointerArray& GetPointerArray() {
+        return *pointers;
+    }
 
     /**
-     * Contains MMIO handlers that back memory regions whose entries in the `attribute` array is of
-     * type `Special`.
+     * Contains MMIO handlers that back memory regions whose attribute is of type `Special`.
      */
     std::vector<SpecialRegion> special_regions;
 
-    /**
-     * Array of fine grained page attributes. If it is set to any value other than `Memory`, then
-     * the corresponding entry in `pointers` MUST be set to null.
-     */
-    std::array<PageType, PAGE_TABLE_NUM_ENTRIES> attributes;
+private:
+    static constexpr std::size_t NUM_ATTRIBUTE_BLOCKS =
+        PAGE_TABLE_NUM_ENTRIES / PAGES_PER_ATTRIBUTE_BLOCK;
+
+    using AttributeBlock = std::array<PageType, PAGES_PER_ATTRIBUTE_BLOCK>;
+    using TrackedPointerBlock = std::array<u8*, PAGES_PER_ATTRIBUTE_BLOCK>;
+
+    struct FreeDeleter {
+        void operator()(void* pointer) const {
+            std::free(pointer);
+        }
+    };
+
+    std::unique_ptr<PointerArray, FreeDeleter> pointers;
+    std::array<std::unique_ptr<AttributeBlock>, NUM_ATTRIBUTE_BLOCKS> attribute_blocks;
+    /// Pointers of the write-protected pages, only allocated for the blocks that ever had one
+    std::array<std::unique_ptr<TrackedPointerBlock>, NUM_ATTRIBUTE_BLOCKS> tracked_pointer_blocks;
 };
 
 /// Physical memory regions as seen from the ARM11
@@ -277,6 +356,12 @@ public:
 
     u8* GetPointer(VAddr vaddr);
 
+    /**
+     * Gets a pointer to write a region through, which must be contiguous in host memory. Every
+     * page of the region is reported as written, unlike GetPointer which only reports the first.
+     */
+    u8* GetPointerForWrite(VAddr vaddr, std::size_t size);
+
     bool IsValidPhysicalAddress(PAddr paddr);
 
     /// Gets offset in FCRAM from a pointer inside FCRAM range
@@ -286,10 +371,17 @@ public:
     u8* GetFCRAMPointer(u32 offset);
 
     /**
-     * Mark each page touching the region as cached.
+     * Mark each page touching the region as cached. When called from the GPU thread, the page
+     * tables are only patched once the emulation thread calls ApplyPendingRasterizerMarks.
      */
     void RasterizerMarkRegionCached(PAddr start, u32 size, bool cached);
 
+    /**
+     * Applies the marks made by the GPU thread since the last call. Must be called from the
+     * emulation thread, at a point where it isn't accessing emulated memory.
+     */
+    void ApplyPendingRasterizerMarks();
+
     /// Registers page table for rasterizer cache marking
     void RegisterPageTable(PageTable* page_table);
 
@@ -298,6 +390,19 @@ public:
 
     void SetDSP(AudioCore::DspInterface& dsp);
 
+    /**
+     * Starts or stops recording which pages of FCRAM and VRAM are written. Stopping discards the
+     * recorded writes. See DirtyPageTracker for which writes are seen.
+     *
+     * While recording, the pages of the registered page tables that map FCRAM or VRAM are
+     * write-protected at the start of every epoch of the tracker, so that the first write to each
+     * one, including those of the CPU cores, takes the slow path and gets reported.
+     */
+    void SetDirtyPageTracking(bool enabled);
+
+    /// Returns the tracker of written pages, or nullptr if dirty page tracking is disabled
+    DirtyPageTracker* GetDirtyPageTracker() const;
+
 private:
     template <typename T>
     T Read(const VAddr vaddr);
@@ -313,8 +418,15 @@ private:
      */
     u8* GetPointerForRasterizerCache(VAddr addr);
 
+    /// Patches the page tables and cache marker for a rasterizer cache mark
+    void ApplyRasterizerMark(PAddr start, u32 size, bool cached);
+
     void MapPages(PageTable& page_table, u32 base, u32 size, u8* memory, PageType type);
 
+    template <typename Visitor>
+    void WalkBlock(const PageTable& page_table, VAddr start_addr, std::size_t size,
+                   Visitor&& visitor);
+
     class Impl;
 
     std::unique_ptr<Impl> impl;
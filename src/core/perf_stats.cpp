@@ -40,6 +40,25 @@ void PerfStats::EndGameFrame() {
     game_frames += 1;
 }
 
+void PerfStats::AddPresentedFrame(Clock::duration latency) {
+    std::lock_guard lock{object_mutex};
+
+    accumulated_presentation_latency += latency;
+    presented_frames += 1;
+}
+
+void PerfStats::AddDroppedFrame() {
+    std::lock_guard lock{object_mutex};
+
+    dropped_frames += 1;
+}
+
+void PerfStats::AddDuplicatedFrame() {
+    std::lock_guard lock{object_mutex};
+
+    duplicated_frames += 1;
+}
+
 PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_us) {
     std::lock_guard lock(object_mutex);
 
@@ -55,6 +74,13 @@ PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_
     results.frametime = duration_cast<DoubleSecs>(accumulated_frametime).count() /
                         static_cast<double>(system_frames);
     results.emulation_speed = system_us_per_second.count() / 1'000'000.0;
+    if (presented_frames != 0) {
+        results.presentation_latency =
+            duration_cast<DoubleSecs>(accumulated_presentation_latency).count() /
+            static_cast<double>(presented_frames);
+    }
+    results.dropped_frames = dropped_frames;
+    results.duplicated_frames = duplicated_frames;
 
     // Reset counters
     reset_point = now;
@@ -62,6 +88,10 @@ PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_
     accumulated_frametime = Clock::duration::zero();
     system_frames = 0;
     game_frames = 0;
+    accumulated_presentation_latency = Clock::duration::zero();
+    presented_frames = 0;
+    dropped_frames = 0;
+    duplicated_frames = 0;
 
     return results;
 }
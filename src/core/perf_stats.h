@@ -29,12 +29,23 @@ public:
         double frametime;
         /// Ratio of walltime / emulated time elapsed
         double emulation_speed;
+        /// Average walltime between a frame being rendered and presented, in seconds
+        double presentation_latency;
+        /// Rendered frames that were replaced by a newer one before being presented
+        u32 dropped_frames;
+        /// Presentations that repeated the previous frame because no new frame was ready
+        u32 duplicated_frames;
     };
 
     void BeginSystemFrame();
     void EndSystemFrame();
     void EndGameFrame();
 
+    /// Records a frame presented by the presentation thread, with its render-to-present latency
+    void AddPresentedFrame(Clock::duration latency);
+    void AddDroppedFrame();
+    void AddDuplicatedFrame();
+
     Results GetAndResetStats(std::chrono::microseconds current_system_time_us);
 
     /**
@@ -57,6 +68,14 @@ private:
     u32 system_frames = 0;
     /// Cumulative number of game frames (GSP frame submissions) since last reset
     u32 game_frames = 0;
+    /// Cumulative render-to-present latency of frames presented since last reset
+    Clock::duration accumulated_presentation_latency = Clock::duration::zero();
+    /// Cumulative number of frames presented by the presentation thread since last reset
+    u32 presented_frames = 0;
+    /// Cumulative number of frames dropped by the presentation mailbox since last reset
+    u32 dropped_frames = 0;
+    /// Cumulative number of repeated presentations since last reset
+    u32 duplicated_frames = 0;
 
     /// Point when the previous system frame ended
     Clock::time_point previous_frame_end = reset_point;
@@ -23,7 +23,8 @@ void Apply() {
     GDBStub::SetServerPort(values.gdbstub_port);
     GDBStub::ToggleServer(values.use_gdbstub);
 
-    VideoCore::g_hw_renderer_enabled = values.use_hw_renderer;
+    VideoCore::g_hw_renderer_enabled =
+        values.use_hw_renderer && values.renderer_backend == RendererBackend::OpenGL;
     VideoCore::g_shader_jit_enabled = values.use_shader_jit;
     VideoCore::g_hw_shader_enabled = values.use_hw_shader;
     VideoCore::g_hw_shader_accurate_gs = values.shaders_accurate_gs;
@@ -70,14 +71,18 @@ void LogSetting(const std::string& name, const T& value) {
 void LogSettings() {
     LOG_INFO(Config, "Citra Configuration:");
     LogSetting("Core_UseCpuJit", Settings::values.use_cpu_jit);
+    LogSetting("Core_DyncomCacheSize", Settings::values.dyncom_cache_size);
+    LogSetting("Renderer_RendererBackend", static_cast<int>(Settings::values.renderer_backend));
     LogSetting("Renderer_UseGLES", Settings::values.use_gles);
     LogSetting("Renderer_UseHwRenderer", Settings::values.use_hw_renderer);
     LogSetting("Renderer_UseHwShader", Settings::values.use_hw_shader);
     LogSetting("Renderer_ShadersAccurateGs", Settings::values.shaders_accurate_gs);
     LogSetting("Renderer_ShadersAccurateMul", Settings::values.shaders_accurate_mul);
     LogSetting("Renderer_UseShaderJit", Settings::values.use_shader_jit);
+    LogSetting("Renderer_UseGpuThread", Settings::values.use_gpu_thread);
     LogSetting("Renderer_UseResolutionFactor", Settings::values.resolution_factor);
     LogSetting("Renderer_VsyncEnabled", Settings::values.vsync_enabled);
+    LogSetting("Renderer_UsePresentThread", Settings::values.use_present_thread);
     LogSetting("Renderer_UseFrameLimit", Settings::values.use_frame_limit);
     LogSetting("Renderer_FrameLimit", Settings::values.frame_limit);
     LogSetting("Layout_Toggle3d", Settings::values.toggle_3d);
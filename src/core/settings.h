@@ -19,6 +19,14 @@ enum class InitClock {
     FixedTime = 1,
 };
 
+enum class RendererBackend {
+    OpenGL = 0,
+    /// Draws nothing and needs no window, for measuring emulation throughput
+    Null = 1,
+    /// Like Null, but still runs the software rasterizer into emulated memory
+    NullSoftware = 2,
+};
+
 enum class LayoutOption {
     Default,
     SingleScreen,
@@ -126,6 +134,7 @@ struct Values {
 
     // Core
     bool use_cpu_jit;
+    u32 dyncom_cache_size; ///< Size limit of the interpreter's translation cache in MiB
 
     // Data Storage
     bool use_virtual_sd;
@@ -136,14 +145,17 @@ struct Values {
     u64 init_time;
 
     // Renderer
+    RendererBackend renderer_backend;
     bool use_gles;
     bool use_hw_renderer;
     bool use_hw_shader;
     bool shaders_accurate_gs;
     bool shaders_accurate_mul;
     bool use_shader_jit;
+    bool use_gpu_thread;
     u16 resolution_factor;
     bool vsync_enabled;
+    bool use_present_thread;
     bool use_frame_limit;
     u16 frame_limit;
 
@@ -187,6 +199,11 @@ struct Values {
     std::string log_filter;
     std::unordered_map<std::string, bool> lle_modules;
 
+    // Video Dumping
+    std::string dump_video_encoder;
+    std::string dump_audio_encoder;
+    u32 dump_ring_depth;
+
     // WebService
     bool enable_telemetry;
     std::string web_api_url;
@@ -0,0 +1,130 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <random>
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include "core/arm/dyncom/arm_dyncom.h"
+#include "core/arm/skyeye_common/vfp/vfp.h"
+#include "tests/core/arm/arm_test_common.h"
+
+namespace ArmTests {
+
+namespace {
+
+struct VfpInstruction {
+    const char* name;
+    u32 encoding;
+    bool is_double;
+};
+
+constexpr std::array<VfpInstruction, 8> instructions{{
+    {"vadd.f32 s2, s4, s6", 0xEE321A03, false},
+    {"vsub.f32 s2, s4, s6", 0xEE321A43, false},
+    {"vmul.f32 s2, s4, s6", 0xEE221A03, false},
+    {"vdiv.f32 s2, s4, s6", 0xEE821A03, false},
+    {"vadd.f64 d1, d2, d3", 0xEE321B03, true},
+    {"vsub.f64 d1, d2, d3", 0xEE321B43, true},
+    {"vmul.f64 d1, d2, d3", 0xEE221B03, true},
+    {"vdiv.f64 d1, d2, d3", 0xEE821B03, true},
+}};
+
+// From the default mode to the round towards zero, flush-to-zero and default NaN mode games use
+constexpr std::array<u32, 6> fpscr_modes{
+    {0x00000000, 0x01000000, 0x02000000, 0x00C00000, 0x03C00000, 0x03C00010}};
+
+/// Generates operands that mostly have nearby exponents, so that the results are normal numbers
+/// the fast path can handle, mixed with arbitrary encodings that exercise the fallbacks.
+class OperandGenerator {
+public:
+    u64 Next(bool is_double) {
+        const u64 bits = rng();
+        switch (rng() % 4) {
+        case 0:
+            return is_double ? bits : bits & 0xFFFFFFFF;
+        case 1:
+            return is_double ? WithExponent(bits, rng() % 2048) : WithExponent32(bits, rng() % 256);
+        default:
+            return is_double ? WithExponent(bits, 1000 + rng() % 48)
+                             : WithExponent32(bits, 112 + rng() % 32);
+        }
+    }
+
+private:
+    static u64 WithExponent(u64 bits, u64 exponent) {
+        return (bits & 0x800FFFFFFFFFFFFFULL) | (exponent << 52);
+    }
+
+    static u64 WithExponent32(u64 bits, u64 exponent) {
+        return (bits & 0x807FFFFF) | (exponent << 23);
+    }
+
+    std::mt19937_64 rng{0x3D5};
+};
+
+} // Anonymous namespace
+
+TEST_CASE("ARM_DynCom (vfp): host fast path matches the software implementation",
+          "[arm_dyncom]") {
+    TestEnvironment test_env(false);
+    for (std::size_t i = 0; i < instructions.size(); ++i) {
+        test_env.SetMemory32(static_cast<VAddr>(i * 4), instructions[i].encoding);
+    }
+
+    ARM_DynCom dyncom(nullptr, test_env.GetMemory(), USER32MODE);
+    OperandGenerator operands;
+    std::mt19937 rng{0x3D5};
+
+    struct Result {
+        u64 value;
+        u32 fpscr;
+    };
+
+    const auto execute = [&](std::size_t index, u32 fpscr, u64 a, u64 b, bool fast_path) {
+        VFPSetHostFastPath(fast_path);
+        dyncom.SetPC(static_cast<u32>(index * 4));
+        dyncom.SetVFPSystemReg(VFP_FPSCR, fpscr);
+        dyncom.SetVFPReg(2, 0);
+        dyncom.SetVFPReg(3, 0);
+        if (instructions[index].is_double) {
+            dyncom.SetVFPReg(4, static_cast<u32>(a));
+            dyncom.SetVFPReg(5, static_cast<u32>(a >> 32));
+            dyncom.SetVFPReg(6, static_cast<u32>(b));
+            dyncom.SetVFPReg(7, static_cast<u32>(b >> 32));
+        } else {
+            dyncom.SetVFPReg(4, static_cast<u32>(a));
+            dyncom.SetVFPReg(6, static_cast<u32>(b));
+        }
+        dyncom.Step();
+        const u64 value = static_cast<u64>(dyncom.GetVFPReg(3)) << 32 | dyncom.GetVFPReg(2);
+        return Result{value, dyncom.GetVFPSystemReg(VFP_FPSCR)};
+    };
+
+    for (int iteration = 0; iteration < 200000; ++iteration) {
+        const std::size_t index = rng() % instructions.size();
+        const bool is_double = instructions[index].is_double;
+        const u32 fpscr = fpscr_modes[rng() % fpscr_modes.size()];
+        const u64 a = operands.Next(is_double);
+        u64 b = operands.Next(is_double);
+        // Equal and opposite operands give exact results and cancellations
+        if (rng() % 8 == 0) {
+            b = a ^ (rng() % 2 == 0 ? 0 : (is_double ? 0x8000000000000000ULL : 0x80000000));
+        }
+
+        const Result soft = execute(index, fpscr, a, b, false);
+        const Result host = execute(index, fpscr, a, b, true);
+        if (soft.value != host.value || soft.fpscr != host.fpscr) {
+            INFO(instructions[index].name);
+            INFO(fmt::format("fpscr {:08x}, a {:x}, b {:x}", fpscr, a, b));
+            INFO(fmt::format("soft path {:x} (fpscr {:08x})", soft.value, soft.fpscr));
+            INFO(fmt::format("fast path {:x} (fpscr {:08x})", host.value, host.fpscr));
+            FAIL();
+        }
+    }
+
+    VFPSetHostFastPath(true);
+}
+
+} // namespace ArmTests
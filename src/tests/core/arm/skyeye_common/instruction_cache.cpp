@@ -0,0 +1,78 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+#include "core/arm/skyeye_common/instruction_cache.h"
+
+TEST_CASE("InstructionCache: lookup", "[arm_dyncom]") {
+    InstructionCache cache;
+    REQUIRE(cache.Find(0x00100000) == InstructionCache::INVALID_OFFSET);
+
+    cache.Insert(0x00100000, 0);
+    cache.Insert(0x00100002, 16);
+    cache.Insert(0xFFFFFFFE, 32);
+
+    REQUIRE(cache.Find(0x00100000) == 0);
+    REQUIRE(cache.Find(0x00100002) == 16);
+    REQUIRE(cache.Find(0x00100004) == InstructionCache::INVALID_OFFSET);
+    REQUIRE(cache.Find(0xFFFFFFFE) == 32);
+}
+
+TEST_CASE("InstructionCache: invalidation", "[arm_dyncom]") {
+    InstructionCache cache;
+    cache.Insert(0x00100000, 0);
+    cache.Insert(0x00101000, 16);
+    cache.Insert(0x00102FFC, 32);
+    cache.Insert(0xFFFFF000, 48);
+
+    SECTION("only the overlapping pages are dropped") {
+        cache.InvalidateRange(0x00101FFC, 8);
+        REQUIRE(cache.Find(0x00100000) == 0);
+        REQUIRE(cache.Find(0x00101000) == InstructionCache::INVALID_OFFSET);
+        REQUIRE(cache.Find(0x00102FFC) == InstructionCache::INVALID_OFFSET);
+        REQUIRE(cache.Find(0xFFFFF000) == 48);
+
+        cache.Insert(0x00101000, 64);
+        REQUIRE(cache.Find(0x00101000) == 64);
+    }
+
+    SECTION("ranges reaching the end of the address space") {
+        cache.InvalidateRange(0xFFFFFFFC, 0x100);
+        REQUIRE(cache.Find(0xFFFFF000) == InstructionCache::INVALID_OFFSET);
+        REQUIRE(cache.Find(0x00100000) == 0);
+    }
+
+    SECTION("clear") {
+        cache.Clear();
+        REQUIRE(cache.Find(0x00100000) == InstructionCache::INVALID_OFFSET);
+        REQUIRE(cache.Find(0x00101000) == InstructionCache::INVALID_OFFSET);
+        REQUIRE(cache.Find(0xFFFFF000) == InstructionCache::INVALID_OFFSET);
+    }
+}
+
+TEST_CASE("InstructionCache: translation buffer", "[arm_dyncom]") {
+    constexpr std::size_t chunk_size = InstructionCache::CHUNK_SIZE;
+    constexpr std::size_t capacity =
+        InstructionCache::MAX_BLOCK_TRANSLATION_SIZE + chunk_size + chunk_size / 2;
+    InstructionCache cache(capacity);
+    REQUIRE(cache.GetTranslationSize() == 0);
+
+    // Growing the buffer keeps the translations made so far
+    *static_cast<u32*>(cache.Allocate(sizeof(u32))) = 0x12345678;
+    cache.Allocate(chunk_size);
+    REQUIRE(*static_cast<u32*>(cache.GetTranslation(0)) == 0x12345678);
+    REQUIRE(cache.GetTranslationSize() == sizeof(u32) + chunk_size);
+
+    cache.Insert(0x00100000, 0);
+    cache.ReserveBlock();
+    REQUIRE(cache.GetFlushCount() == 0);
+    REQUIRE(cache.Find(0x00100000) == 0);
+
+    // Reaching the capacity flushes everything
+    cache.Allocate(chunk_size / 2);
+    cache.ReserveBlock();
+    REQUIRE(cache.GetFlushCount() == 1);
+    REQUIRE(cache.GetTranslationSize() == 0);
+    REQUIRE(cache.Find(0x00100000) == InstructionCache::INVALID_OFFSET);
+}
@@ -4,9 +4,15 @@
 
 #include <catch2/catch.hpp>
 
+#include <algorithm>
 #include <array>
 #include <bitset>
+#include <chrono>
+#include <map>
+#include <random>
 #include <string>
+#include <utility>
+#include <vector>
 #include "common/file_util.h"
 #include "core/core.h"
 #include "core/core_timing.h"
@@ -226,3 +232,102 @@ TEST_CASE("CoreTiming[ChainScheduling]", "[core]") {
     REQUIRE(0 == reschedules);
     REQUIRE(MAX_SLICE_LENGTH == timing.GetDowncount());
 }
+
+TEST_CASE("CoreTiming[Unschedule]", "[core]") {
+    Core::Timing timing;
+
+    std::vector<std::pair<int, u64>> fired;
+    Core::TimingEventType* cb_a = timing.RegisterEvent(
+        "callbackA", [&fired](u64 userdata, s64) { fired.emplace_back(0, userdata); });
+    Core::TimingEventType* cb_b = timing.RegisterEvent(
+        "callbackB", [&fired](u64 userdata, s64) { fired.emplace_back(1, userdata); });
+
+    // Enter slice 0
+    timing.Advance();
+
+    // Reference model of the queue, ordered by time and then by scheduling order
+    std::map<std::pair<s64, int>, std::pair<int, u64>> expected;
+    std::mt19937 rng(1234);
+    int order = 0;
+    for (int i = 0; i < 2000; ++i) {
+        const int type = rng() % 2;
+        const u64 userdata = rng() % 16;
+        switch (rng() % 3) {
+        case 0:
+        case 1: {
+            // Few distinct times, so that many events share a slot
+            const s64 cycles_into_future = 100 * (rng() % 8);
+            timing.ScheduleEvent(cycles_into_future, type == 0 ? cb_a : cb_b, userdata);
+            expected.emplace(std::make_pair(timing.GetTicks() + cycles_into_future, order++),
+                             std::make_pair(type, userdata));
+            break;
+        }
+        case 2:
+            timing.UnscheduleEvent(type == 0 ? cb_a : cb_b, userdata);
+            for (auto it = expected.begin(); it != expected.end();) {
+                if (it->second == std::make_pair(type, userdata)) {
+                    it = expected.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            break;
+        }
+
+        if (i % 100 == 99) {
+            fired.clear();
+            timing.AddTicks(timing.GetDowncount());
+            timing.Advance();
+
+            std::vector<std::pair<int, u64>> expected_fired;
+            while (!expected.empty() &&
+                   expected.begin()->first.first <= static_cast<s64>(timing.GetTicks())) {
+                expected_fired.push_back(expected.begin()->second);
+                expected.erase(expected.begin());
+            }
+            REQUIRE(fired == expected_fired);
+        }
+    }
+
+    timing.RemoveEvent(cb_a);
+    timing.RemoveEvent(cb_b);
+    fired.clear();
+    timing.AddTicks(timing.GetDowncount());
+    timing.Advance();
+    REQUIRE(fired.empty());
+    REQUIRE(MAX_SLICE_LENGTH == timing.GetDowncount());
+}
+
+// Not run by default, select it with the "[benchmark]" tag
+TEST_CASE("CoreTiming[UnscheduleBenchmark]", "[core][.benchmark]") {
+    Core::Timing timing;
+
+    // Mimics thread wakeups: many events of one type, told apart by their userdata
+    constexpr u64 num_events = 10000;
+    constexpr int num_rounds = 20;
+    Core::TimingEventType* cb_a = timing.RegisterEvent("callbackA", [](u64, s64) {});
+
+    // Enter slice 0
+    timing.Advance();
+
+    std::vector<u64> userdatas(num_events);
+    for (u64 i = 0; i < num_events; ++i) {
+        userdatas[i] = i;
+        timing.ScheduleEvent(1000 + i * 7 % 5000, cb_a, i);
+    }
+
+    std::mt19937 rng(1234);
+    const auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < num_rounds; ++round) {
+        std::shuffle(userdatas.begin(), userdatas.end(), rng);
+        for (const u64 userdata : userdatas) {
+            timing.UnscheduleEvent(cb_a, userdata);
+            timing.ScheduleEvent(1000 + userdata * 7 % 5000, cb_a, userdata);
+        }
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+
+    WARN("Rescheduled " << num_events * num_rounds << " events among " << num_events << " in "
+                        << elapsed.count() << " us");
+}
@@ -2,9 +2,15 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <array>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
 #include <catch2/catch.hpp>
 #include "core/core.h"
 #include "core/core_timing.h"
+#include "core/dirty_page_tracker.h"
 #include "core/hle/kernel/memory.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/shared_page.h"
@@ -54,3 +60,301 @@ TEST_CASE("Memory::IsValidVirtualAddress", "[core][memory]") {
         CHECK(Memory::IsValidVirtualAddress(*process, Memory::CONFIG_MEMORY_VADDR) == false);
     }
 }
+
+TEST_CASE("Memory::PageTable", "[core][memory]") {
+    auto page_table = std::make_unique<Memory::PageTable>();
+    std::array<u8, Memory::PAGE_SIZE> backing{};
+    constexpr std::size_t page = Memory::HEAP_VADDR >> Memory::PAGE_BITS;
+
+    SECTION("pages are unmapped until set") {
+        CHECK(page_table->GetAttribute(page) == Memory::PageType::Unmapped);
+        CHECK(page_table->GetPointer(page) == nullptr);
+        CHECK_FALSE(page_table->HasAttributeBlock(page));
+    }
+
+    SECTION("unmapping doesn't allocate attribute blocks") {
+        page_table->SetPage(page, nullptr, Memory::PageType::Unmapped);
+        CHECK_FALSE(page_table->HasAttributeBlock(page));
+    }
+
+    SECTION("mapped pages keep their pointer and attribute") {
+        page_table->SetPage(page, backing.data(), Memory::PageType::Memory);
+        page_table->SetPage(page + 1, nullptr, Memory::PageType::Special);
+        CHECK(page_table->GetAttribute(page) == Memory::PageType::Memory);
+        CHECK(page_table->GetPointer(page) == backing.data());
+        CHECK(page_table->GetPointerArray()[page] == backing.data());
+        CHECK(page_table->GetAttribute(page + 1) == Memory::PageType::Special);
+        CHECK(page_table->GetAttribute(page + 2) == Memory::PageType::Unmapped);
+    }
+
+    SECTION("clones copy the mappings") {
+        page_table->SetPage(page, backing.data(), Memory::PageType::Memory);
+        const auto clone = std::make_unique<Memory::PageTable>(*page_table);
+        page_table->SetPage(page, nullptr, Memory::PageType::Unmapped);
+        CHECK(clone->GetAttribute(page) == Memory::PageType::Memory);
+        CHECK(clone->GetPointer(page) == backing.data());
+        CHECK_FALSE(clone->HasAttributeBlock(0));
+    }
+
+    SECTION("clearing unmaps every page") {
+        page_table->SetPage(page, backing.data(), Memory::PageType::Memory);
+        page_table->Clear();
+        CHECK(page_table->GetAttribute(page) == Memory::PageType::Unmapped);
+        CHECK(page_table->GetPointer(page) == nullptr);
+        CHECK_FALSE(page_table->HasAttributeBlock(page));
+    }
+}
+
+TEST_CASE("Memory::MemorySystem block operations", "[core][memory]") {
+    Core::Timing timing;
+    Memory::MemorySystem memory;
+    Kernel::KernelSystem kernel(memory, timing, [] {}, 0);
+    auto process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+    auto& page_table = process->vm_manager.page_table;
+
+    // Two contiguous pages followed by one backed by unrelated host memory
+    std::vector<u8> contiguous(2 * Memory::PAGE_SIZE);
+    std::vector<u8> separate(Memory::PAGE_SIZE);
+    constexpr VAddr base = Memory::HEAP_VADDR;
+    memory.MapMemoryRegion(page_table, base, 2 * Memory::PAGE_SIZE, contiguous.data());
+    memory.MapMemoryRegion(page_table, base + 2 * Memory::PAGE_SIZE, Memory::PAGE_SIZE,
+                           separate.data());
+
+    std::vector<u8> data(3 * Memory::PAGE_SIZE - 0x20);
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<u8>(i * 7);
+    }
+
+    SECTION("writes and reads cross page and span boundaries") {
+        memory.WriteBlock(*process, base + 0x10, data.data(), data.size());
+        CHECK(contiguous[0x10] == data[0]);
+        CHECK(separate[0] == data[2 * Memory::PAGE_SIZE - 0x10]);
+
+        std::vector<u8> read_back(data.size());
+        memory.ReadBlock(*process, base + 0x10, read_back.data(), read_back.size());
+        CHECK(read_back == data);
+    }
+
+    SECTION("zeroing and copying cross span boundaries") {
+        memory.WriteBlock(*process, base + 0x10, data.data(), data.size());
+        memory.CopyBlock(*process, base, base + Memory::PAGE_SIZE + 0x10, Memory::PAGE_SIZE);
+        CHECK(contiguous[0] == data[Memory::PAGE_SIZE]);
+        CHECK(contiguous[Memory::PAGE_SIZE - 1] == data[2 * Memory::PAGE_SIZE - 1]);
+
+        memory.ZeroBlock(*process, base + 0x100, 2 * Memory::PAGE_SIZE);
+        CHECK(contiguous[0xFF] != 0);
+        CHECK(contiguous[0x100] == 0);
+        CHECK(separate[0xFF] == 0);
+        CHECK(separate[0x100] != 0);
+    }
+
+    SECTION("overlapping copies behave like memmove") {
+        memory.WriteBlock(*process, base, data.data(), data.size());
+        std::vector<u8> expected = data;
+        std::vector<u8> read_back(data.size());
+
+        // Forwards across the span boundary, then backwards
+        memory.CopyBlock(*process, base + 0x810, base, 2 * Memory::PAGE_SIZE);
+        std::memmove(expected.data() + 0x810, expected.data(), 2 * Memory::PAGE_SIZE);
+        memory.ReadBlock(*process, base, read_back.data(), read_back.size());
+        CHECK(read_back == expected);
+
+        memory.CopyBlock(*process, base + 0x4, base + 0x800, 2 * Memory::PAGE_SIZE);
+        std::memmove(expected.data() + 0x4, expected.data() + 0x800, 2 * Memory::PAGE_SIZE);
+        memory.ReadBlock(*process, base, read_back.data(), read_back.size());
+        CHECK(read_back == expected);
+    }
+
+    SECTION("unmapped pages read as zeroes") {
+        std::vector<u8> read_back(2 * Memory::PAGE_SIZE, 0xFF);
+        memory.ReadBlock(*process, base + 2 * Memory::PAGE_SIZE, read_back.data(),
+                         read_back.size());
+        CHECK(read_back[Memory::PAGE_SIZE - 1] == separate[Memory::PAGE_SIZE - 1]);
+        CHECK(read_back[Memory::PAGE_SIZE] == 0);
+    }
+}
+
+TEST_CASE("Memory::MemorySystem::RasterizerMarkRegionCached", "[core][memory]") {
+    Core::Timing timing;
+    Memory::MemorySystem memory;
+    Kernel::KernelSystem kernel(memory, timing, [] {}, 0);
+    auto process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+    auto& page_table = process->vm_manager.page_table;
+
+    constexpr std::size_t linear_page = Memory::LINEAR_HEAP_VADDR >> Memory::PAGE_BITS;
+    constexpr std::size_t new_linear_page = Memory::NEW_LINEAR_HEAP_VADDR >> Memory::PAGE_BITS;
+    memory.MapMemoryRegion(page_table, Memory::LINEAR_HEAP_VADDR, 2 * Memory::PAGE_SIZE,
+                           memory.GetFCRAMPointer(0));
+
+    SECTION("marking switches every alias of the pages") {
+        memory.RasterizerMarkRegionCached(Memory::FCRAM_PADDR + 0x10, Memory::PAGE_SIZE, true);
+        CHECK(page_table.GetAttribute(linear_page) == Memory::PageType::RasterizerCachedMemory);
+        CHECK(page_table.GetAttribute(linear_page + 1) ==
+              Memory::PageType::RasterizerCachedMemory);
+        CHECK(page_table.GetPointer(linear_page) == nullptr);
+        // The New 3DS linear heap isn't mapped in this process
+        CHECK(page_table.GetAttribute(new_linear_page) == Memory::PageType::Unmapped);
+
+        memory.RasterizerMarkRegionCached(Memory::FCRAM_PADDR, 2 * Memory::PAGE_SIZE, false);
+        CHECK(page_table.GetAttribute(linear_page) == Memory::PageType::Memory);
+        CHECK(page_table.GetPointer(linear_page) == memory.GetFCRAMPointer(0));
+        CHECK(page_table.GetPointer(linear_page + 1) ==
+              memory.GetFCRAMPointer(Memory::PAGE_SIZE));
+    }
+
+    SECTION("pages mapped over cached memory start out cached") {
+        memory.RasterizerMarkRegionCached(Memory::FCRAM_PADDR, Memory::PAGE_SIZE, true);
+        memory.MapMemoryRegion(page_table, Memory::NEW_LINEAR_HEAP_VADDR, 2 * Memory::PAGE_SIZE,
+                               memory.GetFCRAMPointer(0));
+        CHECK(page_table.GetAttribute(new_linear_page) == Memory::PageType::RasterizerCachedMemory);
+        CHECK(page_table.GetAttribute(new_linear_page + 1) == Memory::PageType::Memory);
+        memory.RasterizerMarkRegionCached(Memory::FCRAM_PADDR, Memory::PAGE_SIZE, false);
+    }
+}
+
+using Run = std::pair<PAddr, u32>;
+
+TEST_CASE("Memory::DirtyPageTracker", "[core][memory]") {
+    // Borrow the memory of a memory system rather than allocating the whole of FCRAM again
+    Memory::MemorySystem memory;
+    const u8* fcram = memory.GetFCRAMPointer(0);
+    const u8* vram = memory.GetPhysicalPointer(Memory::VRAM_PADDR);
+    int num_epochs = 0;
+    Memory::DirtyPageTracker tracker(fcram, vram, [&] { ++num_epochs; });
+
+    std::vector<Run> runs;
+    const auto collect = [&](Memory::DirtyPageTracker::Cursor& cursor) {
+        runs.clear();
+        tracker.Collect(cursor, [&](PAddr addr, u32 size) { runs.emplace_back(addr, size); });
+    };
+
+    tracker.MarkDirty(fcram, 1);
+    auto first = tracker.CreateCursor();
+    CHECK(!tracker.IsDirty(first, Memory::FCRAM_PADDR));
+    CHECK(num_epochs == 1);
+
+    SECTION("writes are merged into runs of contiguous pages") {
+        tracker.MarkDirty(fcram + Memory::PAGE_SIZE - 1, 2);
+        tracker.MarkDirty(Memory::FCRAM_PADDR + 2 * Memory::PAGE_SIZE, 1);
+        tracker.MarkDirty(vram + Memory::VRAM_SIZE - 1, 1);
+        tracker.MarkDirty(Memory::FCRAM_PADDR + 100 * Memory::PAGE_SIZE, 2 * Memory::PAGE_SIZE);
+        CHECK(tracker.IsDirty(first, Memory::FCRAM_PADDR));
+
+        collect(first);
+        REQUIRE(runs.size() == 3);
+        CHECK(runs[0] == Run(Memory::VRAM_PADDR_END - Memory::PAGE_SIZE, Memory::PAGE_SIZE));
+        CHECK(runs[1] == Run(Memory::FCRAM_PADDR, 3 * Memory::PAGE_SIZE));
+        CHECK(runs[2] == Run(Memory::FCRAM_PADDR + 100 * Memory::PAGE_SIZE, 2 * Memory::PAGE_SIZE));
+
+        collect(first);
+        CHECK(runs.empty());
+        CHECK(num_epochs == 3);
+    }
+
+    SECTION("consumers advance independently") {
+        tracker.MarkDirty(Memory::VRAM_PADDR, 4);
+        auto second = tracker.CreateCursor();
+        tracker.MarkDirty(Memory::FCRAM_PADDR, 4);
+
+        collect(second);
+        REQUIRE(runs.size() == 1);
+        CHECK(runs[0].first == Memory::FCRAM_PADDR);
+
+        tracker.MarkDirty(Memory::FCRAM_PADDR + Memory::PAGE_SIZE, 4);
+        collect(first);
+        REQUIRE(runs.size() == 2);
+        CHECK(runs[0] == Run(Memory::VRAM_PADDR, Memory::PAGE_SIZE));
+        CHECK(runs[1] == Run(Memory::FCRAM_PADDR, 2 * Memory::PAGE_SIZE));
+
+        collect(second);
+        REQUIRE(runs.size() == 1);
+        CHECK(runs[0].first == Memory::FCRAM_PADDR + Memory::PAGE_SIZE);
+    }
+
+    SECTION("memory outside of FCRAM and VRAM is ignored") {
+        u8 other[4];
+        tracker.MarkDirty(other, sizeof(other));
+        tracker.MarkDirty(Memory::IO_AREA_PADDR, 4);
+        collect(first);
+        CHECK(runs.empty());
+    }
+}
+
+TEST_CASE("Memory::MemorySystem dirty page tracking", "[core][memory]") {
+    Core::Timing timing;
+    Memory::MemorySystem memory;
+    Kernel::KernelSystem kernel(memory, timing, [] {}, 0);
+    auto process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+    auto& page_table = process->vm_manager.page_table;
+
+    constexpr u32 fcram_offset = 0x10 * Memory::PAGE_SIZE;
+    memory.MapMemoryRegion(page_table, Memory::HEAP_VADDR, 4 * Memory::PAGE_SIZE,
+                           memory.GetFCRAMPointer(fcram_offset));
+
+    CHECK(memory.GetDirtyPageTracker() == nullptr);
+    memory.SetDirtyPageTracking(true);
+    REQUIRE(memory.GetDirtyPageTracker() != nullptr);
+    auto& tracker = *memory.GetDirtyPageTracker();
+    auto cursor = tracker.CreateCursor();
+
+    const std::array<u8, 0x20> data{};
+    memory.WriteBlock(*process, Memory::HEAP_VADDR + Memory::PAGE_SIZE - 0x10, data.data(),
+                      data.size());
+    memory.ZeroBlock(*process, Memory::HEAP_VADDR + 3 * Memory::PAGE_SIZE, 4);
+
+    std::vector<Run> runs;
+    tracker.Collect(cursor, [&](PAddr addr, u32 size) { runs.emplace_back(addr, size); });
+    REQUIRE(runs.size() == 2);
+    CHECK(runs[0] == Run(Memory::FCRAM_PADDR + fcram_offset, 2 * Memory::PAGE_SIZE));
+    CHECK(runs[1] == Run(Memory::FCRAM_PADDR + fcram_offset + 3 * Memory::PAGE_SIZE,
+                         Memory::PAGE_SIZE));
+
+    SECTION("single writes to plain memory pages are seen in every epoch") {
+        memory.SetCurrentPageTable(&page_table);
+        constexpr std::size_t page = (Memory::HEAP_VADDR >> Memory::PAGE_BITS) + 2;
+        constexpr VAddr vaddr = Memory::HEAP_VADDR + 2 * Memory::PAGE_SIZE + 4;
+        CHECK(page_table.GetAttribute(page) == Memory::PageType::WriteTrackedMemory);
+        CHECK(page_table.GetPointer(page) == nullptr);
+
+        for (u32 value : {0x12345678U, 0x9ABCDEF0U}) {
+            memory.Write32(vaddr, value);
+            memory.Write32(vaddr + 4, value);
+            CHECK(memory.Read32(vaddr) == value);
+            // The first write lifts the protection until the next epoch
+            CHECK(page_table.GetAttribute(page) == Memory::PageType::Memory);
+
+            runs.clear();
+            tracker.Collect(cursor, [&](PAddr addr, u32 size) { runs.emplace_back(addr, size); });
+            REQUIRE(runs.size() == 1);
+            CHECK(runs[0] == Run(Memory::FCRAM_PADDR + fcram_offset + 2 * Memory::PAGE_SIZE,
+                                 Memory::PAGE_SIZE));
+            CHECK(page_table.GetAttribute(page) == Memory::PageType::WriteTrackedMemory);
+        }
+    }
+
+    SECTION("pointers for writing report every page they span") {
+        memory.SetCurrentPageTable(&page_table);
+        u8* pointer = memory.GetPointerForWrite(Memory::HEAP_VADDR + Memory::PAGE_SIZE - 4,
+                                                Memory::PAGE_SIZE + 8);
+        CHECK(pointer == memory.GetFCRAMPointer(fcram_offset + Memory::PAGE_SIZE - 4));
+
+        runs.clear();
+        tracker.Collect(cursor, [&](PAddr addr, u32 size) { runs.emplace_back(addr, size); });
+        REQUIRE(runs.size() == 1);
+        CHECK(runs[0] == Run(Memory::FCRAM_PADDR + fcram_offset, 3 * Memory::PAGE_SIZE));
+    }
+
+    SECTION("pages mapped while tracking start out protected") {
+        memory.MapMemoryRegion(page_table, Memory::HEAP_VADDR + 8 * Memory::PAGE_SIZE,
+                               Memory::PAGE_SIZE, memory.GetFCRAMPointer(0));
+        CHECK(page_table.GetAttribute((Memory::HEAP_VADDR >> Memory::PAGE_BITS) + 8) ==
+              Memory::PageType::WriteTrackedMemory);
+    }
+
+    memory.SetDirtyPageTracking(false);
+    CHECK(memory.GetDirtyPageTracker() == nullptr);
+    CHECK(page_table.GetAttribute(Memory::HEAP_VADDR >> Memory::PAGE_BITS) ==
+          Memory::PageType::Memory);
+    CHECK(page_table.GetPointer(Memory::HEAP_VADDR >> Memory::PAGE_BITS) ==
+          memory.GetFCRAMPointer(fcram_offset));
+}
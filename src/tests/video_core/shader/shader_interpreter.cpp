@@ -0,0 +1,361 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <catch2/catch.hpp>
+#include <nihstro/inline_assembly.h>
+#include "video_core/shader/shader_interpreter.h"
+
+using float24 = Pica::float24;
+using InterpreterEngine = Pica::Shader::InterpreterEngine;
+using ShaderSetup = Pica::Shader::ShaderSetup;
+
+using DestRegister = nihstro::DestRegister;
+using OpCode = nihstro::OpCode;
+using SourceRegister = nihstro::SourceRegister;
+
+class ShaderTest {
+public:
+    explicit ShaderTest(std::initializer_list<nihstro::InlineAsm> code)
+        : setup(std::make_unique<ShaderSetup>()) {
+        const auto shbin = nihstro::InlineAsm::CompileToRawBinary(code);
+
+        setup->program_code.fill(0);
+        setup->swizzle_data.fill(0);
+        std::transform(shbin.program.begin(), shbin.program.end(), setup->program_code.begin(),
+                       [](const auto& x) { return x.hex; });
+        std::transform(shbin.swizzle_table.begin(), shbin.swizzle_table.end(),
+                       setup->swizzle_data.begin(), [](const auto& x) { return x.hex; });
+
+        engine.SetupBatch(*setup, 0);
+    }
+
+    float Run(float input0, float input1 = 0.f) {
+        Pica::Shader::UnitState shader_unit;
+
+        shader_unit.registers.input[0].x = float24::FromFloat32(input0);
+        shader_unit.registers.input[1].x = float24::FromFloat32(input1);
+        engine.Run(*setup, shader_unit);
+        return shader_unit.registers.output[0].x.ToFloat32();
+    }
+
+private:
+    std::unique_ptr<ShaderSetup> setup;
+    InterpreterEngine engine;
+};
+
+TEST_CASE("Decoded ADD and MUL", "[video_core][shader][shader_interpreter]") {
+    const auto sh_input0 = SourceRegister::MakeInput(0);
+    const auto sh_input1 = SourceRegister::MakeInput(1);
+    const auto sh_output = DestRegister::MakeOutput(0);
+
+    auto add = ShaderTest({
+        // clang-format off
+        {OpCode::Id::ADD, sh_output, sh_input0, sh_input1},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+
+    REQUIRE(add.Run(1.f, 2.f) == Approx(3.f));
+    REQUIRE(add.Run(-4.f, 1.5f) == Approx(-2.5f));
+
+    auto mul = ShaderTest({
+        // clang-format off
+        {OpCode::Id::MUL, sh_output, sh_input0, sh_input1},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+
+    REQUIRE(mul.Run(3.f, 2.f) == Approx(6.f));
+    // PICA multiplication yields 0 instead of NaN for 0 * inf
+    REQUIRE(mul.Run(0.f, INFINITY) == 0.f);
+}
+
+TEST_CASE("Decoded MAX and MIN", "[video_core][shader][shader_interpreter]") {
+    const auto sh_input0 = SourceRegister::MakeInput(0);
+    const auto sh_input1 = SourceRegister::MakeInput(1);
+    const auto sh_output = DestRegister::MakeOutput(0);
+
+    auto max = ShaderTest({
+        // clang-format off
+        {OpCode::Id::MAX, sh_output, sh_input0, sh_input1},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+
+    REQUIRE(max.Run(1.f, 2.f) == 2.f);
+    REQUIRE(std::isnan(max.Run(0.f, NAN)));
+    REQUIRE(max.Run(NAN, 0.f) == 0.f);
+
+    auto min = ShaderTest({
+        // clang-format off
+        {OpCode::Id::MIN, sh_output, sh_input0, sh_input1},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+
+    REQUIRE(min.Run(1.f, 2.f) == 1.f);
+    REQUIRE(std::isnan(min.Run(0.f, NAN)));
+    REQUIRE(min.Run(NAN, 0.f) == 0.f);
+}
+
+TEST_CASE("Decoded LG2 and EX2", "[video_core][shader][shader_interpreter]") {
+    const auto sh_input = SourceRegister::MakeInput(0);
+    const auto sh_output = DestRegister::MakeOutput(0);
+
+    auto lg2 = ShaderTest({
+        // clang-format off
+        {OpCode::Id::LG2, sh_output, sh_input},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+
+    REQUIRE(std::isnan(lg2.Run(-1.f)));
+    REQUIRE(std::isinf(lg2.Run(0.f)));
+    REQUIRE(lg2.Run(64.f) == Approx(6.f));
+
+    auto ex2 = ShaderTest({
+        // clang-format off
+        {OpCode::Id::EX2, sh_output, sh_input},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+
+    REQUIRE(ex2.Run(0.f) == Approx(1.f));
+    REQUIRE(ex2.Run(6.f) == Approx(64.f));
+}
+
+/// Encodes an instruction with up to two sources in the common format. The first source is
+/// addressed relative to the given address register (1: a0.x, 2: a0.y, 3: aL), if any.
+static u32 EncodeCommon(OpCode::Id opcode, u32 dest, u32 src1, u32 src2, u32 operand_desc_id,
+                        u32 address_register = 0) {
+    return (static_cast<u32>(opcode) << 26) | (dest << 21) | (address_register << 19) |
+           (src1 << 12) | (src2 << 7) | operand_desc_id;
+}
+
+/// Encodes an instruction in the inverted format, where the second source is the wide one and is
+/// addressed relative to the given address register
+static u32 EncodeInverted(OpCode::Id opcode, u32 dest, u32 src1, u32 src2, u32 operand_desc_id,
+                          u32 address_register = 0) {
+    return (static_cast<u32>(opcode) << 26) | (dest << 21) | (address_register << 19) |
+           (src1 << 14) | (src2 << 7) | operand_desc_id;
+}
+
+/// Encodes a CMP instruction with the compare operations for the x and y components
+static u32 EncodeCompare(u32 op_x, u32 op_y, u32 src1, u32 src2, u32 operand_desc_id) {
+    return (static_cast<u32>(OpCode::Id::CMP) << 26) | (op_x << 24) | (op_y << 21) |
+           (src1 << 12) | (src2 << 7) | operand_desc_id;
+}
+
+/// Encodes a flow control instruction, which the inline assembler doesn't support
+static u32 EncodeFlowControl(OpCode::Id opcode, u32 dest_offset, u32 num_instructions,
+                             u32 uniform_id = 0) {
+    return (static_cast<u32>(opcode) << 26) | (uniform_id << 22) | (dest_offset << 10) |
+           num_instructions;
+}
+
+/// Encodes a flow control instruction depending on the conditional code
+static u32 EncodeConditionalFlowControl(OpCode::Id opcode, bool refx, bool refy,
+                                        nihstro::Instruction::FlowControlType::Op op,
+                                        u32 dest_offset, u32 num_instructions) {
+    return (static_cast<u32>(opcode) << 26) | (refx << 25) | (refy << 24) |
+           (static_cast<u32>(op) << 22) | (dest_offset << 10) | num_instructions;
+}
+
+/**
+ * Encodes an operand descriptor
+ * @param dest_mask Enabled destination components, e.g. "xz"
+ * @param swizzles Swizzles of the sources, e.g. "wzyx", prefixed with '-' to negate the source
+ */
+static u32 EncodeOperandDescriptor(const char* dest_mask,
+                                   std::initializer_list<const char*> swizzles) {
+    const auto component = [](char c) -> u32 { return c == 'w' ? 3 : c - 'x'; };
+
+    u32 descriptor = 0;
+    for (const char* c = dest_mask; *c != '\0'; ++c) {
+        descriptor |= 8 >> component(*c);
+    }
+
+    u32 shift = 4;
+    for (const char* swizzle : swizzles) {
+        if (*swizzle == '-') {
+            descriptor |= 1 << shift;
+            ++swizzle;
+        }
+        for (u32 i = 0; i < 4; ++i) {
+            descriptor |= component(swizzle[i]) << (shift + 1 + (3 - i) * 2);
+        }
+        shift += 9;
+    }
+    return descriptor;
+}
+
+/// Compares two results bit for bit, NaNs only need to match in kind
+static bool IsIdentical(float24 a, float24 b) {
+    const float x = a.ToFloat32();
+    const float y = b.ToFloat32();
+    if (std::isnan(x) || std::isnan(y)) {
+        return std::isnan(x) && std::isnan(y);
+    }
+    return std::memcmp(&x, &y, sizeof(float)) == 0;
+}
+
+TEST_CASE("Decoded programs match the undecoded interpreter",
+          "[video_core][shader][shader_interpreter]") {
+    using Op = nihstro::Instruction::FlowControlType::Op;
+    using CompareOp = nihstro::Instruction::Common::CompareOpType;
+
+    // Register indices as encoded in the instructions
+    constexpr u32 v0 = 0x00, v1 = 0x01, v2 = 0x02;
+    constexpr u32 r0 = 0x10, r1 = 0x11, r2 = 0x12;
+    constexpr u32 c0 = 0x20, c1 = 0x21, c2 = 0x22;
+    constexpr u32 o0 = 0x00, o1 = 0x01, o2 = 0x02;
+    constexpr u32 a0_x = 1, a0_y = 2, aL = 3;
+
+    auto setup = std::make_unique<ShaderSetup>();
+    setup->program_code.fill(0);
+    setup->swizzle_data.fill(0);
+
+    auto& swizzle_data = setup->swizzle_data;
+    swizzle_data[0] = EncodeOperandDescriptor("xyzw", {"xyzw", "xyzw"});
+    swizzle_data[1] = EncodeOperandDescriptor("xy", {"xyzw"});
+    swizzle_data[2] = EncodeOperandDescriptor("xyzw", {"-wzyx"});
+    swizzle_data[3] = EncodeOperandDescriptor("xyzw", {"xyzw", "yxwz"});
+    swizzle_data[4] = EncodeOperandDescriptor("xyzw", {"xyzw", "-zzzz"});
+    swizzle_data[5] = EncodeOperandDescriptor("xz", {"xyzw", "xyzw"});
+    swizzle_data[6] = EncodeOperandDescriptor("xy", {"xyzw", "xyzw"});
+    swizzle_data[7] = EncodeOperandDescriptor("w", {"xyzw", "-xyzw"});
+    swizzle_data[8] = EncodeOperandDescriptor("yzw", {"-yyxx", "wxzy"});
+
+    auto& code = setup->program_code;
+    // clang-format off
+    code[0] = EncodeCommon(OpCode::Id::MOVA, 0, v2, 0, 1);
+    code[1] = EncodeCommon(OpCode::Id::MOV, r0, c1, 0, 2, a0_x);
+    code[2] = EncodeCompare(CompareOp::GreaterThan, CompareOp::LessThan, v0, v1, 0);
+    code[3] = EncodeConditionalFlowControl(OpCode::Id::IFC, true, true, Op::And, 5, 1);
+    code[4] = EncodeCommon(OpCode::Id::ADD, r0, r0, v0, 0);  // if x > and y <
+    code[5] = EncodeCommon(OpCode::Id::MUL, r0, r0, v1, 3);  // else
+    code[6] = EncodeFlowControl(OpCode::Id::LOOP, 7, 0, 0);
+    code[7] = EncodeCommon(OpCode::Id::ADD, r1, c0, r1, 0, aL);
+    code[8] = EncodeCommon(OpCode::Id::MAX, r0, r0, r1, 4);
+    code[9] = EncodeFlowControl(OpCode::Id::CALLU, 18, 2, 0);
+    code[10] = EncodeConditionalFlowControl(OpCode::Id::JMPC, false, false, Op::JustX, 12, 0);
+    code[11] = EncodeCommon(OpCode::Id::DP4, r0, r0, v1, 5);
+    code[12] = EncodeFlowControl(OpCode::Id::CALL, 18, 2);
+    code[13] = EncodeInverted(OpCode::Id::SLTI, r2, v0, c2, 8, a0_y);
+    code[14] = EncodeCommon(OpCode::Id::MOV, o0, r0, 0, 0);
+    code[15] = EncodeCommon(OpCode::Id::MOV, o1, r1, 0, 0);
+    code[16] = EncodeCommon(OpCode::Id::MOV, o2, r2, 0, 0);
+    code[17] = EncodeFlowControl(OpCode::Id::END, 0, 0);
+    code[18] = EncodeCommon(OpCode::Id::SGE, r1, r0, v0, 6);  // subroutine
+    code[19] = EncodeCommon(OpCode::Id::ADD, r0, r0, r1, 7);
+    // clang-format on
+
+    for (unsigned i = 0; i < 8; ++i) {
+        const float value = 0.75f * i - 1.5f;
+        setup->uniforms.f[i] = Common::MakeVec(float24::FromFloat32(value),
+                                               float24::FromFloat32(-value * 2.f),
+                                               float24::FromFloat32(value + 0.25f),
+                                               float24::FromFloat32(1.f / (value + 0.1f)));
+    }
+
+    const std::array<float, 7> values = {0.f, -0.f, 1.f, -2.5f, 3.75f, INFINITY, NAN};
+    const std::array<Common::Vec4<u8>, 3> loop_params = {Common::MakeVec<u8>(0, 0, 1, 0),
+                                                         Common::MakeVec<u8>(2, 0, 1, 0),
+                                                         Common::MakeVec<u8>(1, 1, 2, 0)};
+
+    InterpreterEngine engine;
+    for (const bool b0 : {false, true}) {
+        for (const auto& loop_param : loop_params) {
+            setup->uniforms.b[0] = b0;
+            setup->uniforms.i[0] = loop_param;
+            engine.SetupBatch(*setup, 0);
+
+            for (std::size_t i = 0; i < values.size(); ++i) {
+                for (std::size_t j = 0; j < values.size(); ++j) {
+                    Pica::Shader::UnitState decoded_unit;
+                    std::memset(&decoded_unit.registers, 0, sizeof(decoded_unit.registers));
+                    for (std::size_t comp = 0; comp < 4; ++comp) {
+                        decoded_unit.registers.input[0][comp] =
+                            float24::FromFloat32(values[(i + comp) % values.size()]);
+                        decoded_unit.registers.input[1][comp] =
+                            float24::FromFloat32(values[(j + comp * 2) % values.size()]);
+                    }
+                    // Address register offsets, kept within the float uniforms
+                    decoded_unit.registers.input[2] = Common::MakeVec(
+                        float24::FromFloat32(static_cast<float>(i % 3)),
+                        float24::FromFloat32(static_cast<float>(j % 2)), float24::Zero(),
+                        float24::Zero());
+                    Pica::Shader::UnitState reference_unit = decoded_unit;
+
+                    engine.Run(*setup, decoded_unit);
+                    engine.RunUndecoded(*setup, reference_unit);
+
+                    INFO("b0 " << b0 << ", loop " << static_cast<int>(loop_param.x) << ", inputs "
+                               << i << ", " << j);
+                    for (std::size_t reg = 0; reg < 3; ++reg) {
+                        for (std::size_t comp = 0; comp < 4; ++comp) {
+                            REQUIRE(IsIdentical(decoded_unit.registers.output[reg][comp],
+                                                reference_unit.registers.output[reg][comp]));
+                        }
+                    }
+                    for (std::size_t reg = 0; reg < 3; ++reg) {
+                        REQUIRE(decoded_unit.address_registers[reg] ==
+                                reference_unit.address_registers[reg]);
+                    }
+                    REQUIRE(decoded_unit.conditional_code[0] == reference_unit.conditional_code[0]);
+                    REQUIRE(decoded_unit.conditional_code[1] == reference_unit.conditional_code[1]);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Decoded programs of the current draw stay valid while the cache evicts",
+          "[video_core][shader][shader_interpreter]") {
+    constexpr u32 v0 = 0x00;
+    constexpr u32 o0 = 0x00;
+
+    // Stand-ins for the vertex and geometry shader setups, which point into the same cache
+    auto vs_setup = std::make_unique<ShaderSetup>();
+    auto gs_setup = std::make_unique<ShaderSetup>();
+    for (auto* setup : {vs_setup.get(), gs_setup.get()}) {
+        setup->program_code.fill(0);
+        setup->swizzle_data.fill(0);
+        setup->swizzle_data[0] = EncodeOperandDescriptor("xyzw", {"xyzw", "xyzw"});
+        for (unsigned i = 0; i < 96; ++i) {
+            setup->uniforms.f[i] = Common::Vec4<float24>::AssignToAll(
+                float24::FromFloat32(static_cast<float>(i)));
+        }
+    }
+
+    InterpreterEngine engine;
+    // Every draw sets up two new programs, so older programs keep getting evicted
+    for (u32 draw = 0; draw < 95; ++draw) {
+        vs_setup->program_code[0] = EncodeCommon(OpCode::Id::MOV, o0, 0x20 + draw, 0, 0);
+        vs_setup->program_code[1] = EncodeFlowControl(OpCode::Id::END, 0, 0);
+        vs_setup->MarkProgramCodeDirty();
+        gs_setup->program_code[0] =
+            EncodeCommon(OpCode::Id::ADD, o0, 0x20 + draw + 1, v0, 0);
+        gs_setup->program_code[1] = EncodeFlowControl(OpCode::Id::END, 0, 0);
+        gs_setup->MarkProgramCodeDirty();
+
+        engine.SetupBatch(*vs_setup, 0);
+        engine.SetupBatch(*gs_setup, 0);
+
+        Pica::Shader::UnitState vs_unit;
+        Pica::Shader::UnitState gs_unit;
+        std::memset(&gs_unit.registers, 0, sizeof(gs_unit.registers));
+        gs_unit.registers.input[0].x = float24::FromFloat32(0.5f);
+        engine.Run(*vs_setup, vs_unit);
+        engine.Run(*gs_setup, gs_unit);
+
+        REQUIRE(vs_unit.registers.output[0].x.ToFloat32() == static_cast<float>(draw));
+        REQUIRE(gs_unit.registers.output[0].x.ToFloat32() == static_cast<float>(draw + 1) + 0.5f);
+    }
+}
@@ -3,32 +3,47 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstring>
+#include <limits>
 #include <memory>
+#include <vector>
 #include <catch2/catch.hpp>
 #include <nihstro/inline_assembly.h>
+#include "common/vector_math.h"
+#include "video_core/shader/shader_interpreter.h"
 #include "video_core/shader/shader_jit_x64_compiler.h"
 
 using float24 = Pica::float24;
 using JitShader = Pica::Shader::JitShader;
+using ShaderSetup = Pica::Shader::ShaderSetup;
 
 using DestRegister = nihstro::DestRegister;
 using OpCode = nihstro::OpCode;
 using SourceRegister = nihstro::SourceRegister;
 
-static std::unique_ptr<JitShader> CompileShader(std::initializer_list<nihstro::InlineAsm> code) {
+static std::unique_ptr<ShaderSetup> AssembleShader(std::initializer_list<nihstro::InlineAsm> code) {
     const auto shbin = nihstro::InlineAsm::CompileToRawBinary(code);
 
-    std::array<u32, Pica::Shader::MAX_PROGRAM_CODE_LENGTH> program_code{};
-    std::array<u32, Pica::Shader::MAX_SWIZZLE_DATA_LENGTH> swizzle_data{};
+    auto setup = std::make_unique<ShaderSetup>();
+    setup->program_code.fill(0);
+    setup->swizzle_data.fill(0);
 
-    std::transform(shbin.program.begin(), shbin.program.end(), program_code.begin(),
-                   [](const auto& x) { return x.hex; });
-    std::transform(shbin.swizzle_table.begin(), shbin.swizzle_table.end(), swizzle_data.begin(),
+    std::transform(shbin.program.begin(), shbin.program.end(), setup->program_code.begin(),
                    [](const auto& x) { return x.hex; });
+    std::transform(shbin.swizzle_table.begin(), shbin.swizzle_table.end(),
+                   setup->swizzle_data.begin(), [](const auto& x) { return x.hex; });
+
+    return setup;
+}
 
-    auto shader = std::make_unique<JitShader>();
-    shader->Compile(&program_code, &swizzle_data);
+static std::unique_ptr<JitShader> CompileShader(std::initializer_list<nihstro::InlineAsm> code,
+                                                bool use_avx = false) {
+    const auto setup = AssembleShader(code);
+
+    auto shader = std::make_unique<JitShader>(use_avx);
+    shader->Compile(&setup->program_code, &setup->swizzle_data);
 
     return shader;
 }
@@ -89,3 +104,205 @@ TEST_CASE("EX2", "[video_core][shader][shader_jit]") {
     REQUIRE(shader.Run(79.7262742773f) == Approx(1.e24f));
     REQUIRE(std::isinf(shader.Run(800.f)));
 }
+
+/// Code tiers of the JIT supported by the host
+static std::vector<bool> GetSupportedTiers() {
+    std::vector<bool> tiers{false};
+    if (JitShader::IsAVXTierSupported()) {
+        tiers.push_back(true);
+    }
+    return tiers;
+}
+
+/// Compares the JIT output with the interpreter output bit for bit. NaNs only need to match in
+/// kind, as their payload isn't representable in the PICA's 24-bit floats.
+static bool IsEquivalent(float jit, float reference) {
+    if (std::isnan(jit) || std::isnan(reference)) {
+        return std::isnan(jit) && std::isnan(reference);
+    }
+    u32 jit_bits;
+    u32 reference_bits;
+    std::memcpy(&jit_bits, &jit, sizeof(float));
+    std::memcpy(&reference_bits, &reference, sizeof(float));
+    return jit_bits == reference_bits;
+}
+
+TEST_CASE("JIT tiers match the interpreter", "[video_core][shader][shader_jit]") {
+    const auto sh_input0 = SourceRegister::MakeInput(0);
+    const auto sh_input1 = SourceRegister::MakeInput(1);
+    const auto sh_input2 = SourceRegister::MakeInput(2);
+    const auto sh_output = DestRegister::MakeOutput(0);
+
+    const std::initializer_list<nihstro::InlineAsm> programs[] = {
+        // clang-format off
+        {{OpCode::Id::ADD, sh_output, sh_input0, sh_input1}, {OpCode::Id::END}},
+        {{OpCode::Id::MUL, sh_output, sh_input0, sh_input1}, {OpCode::Id::END}},
+        {{OpCode::Id::MAD, sh_output, sh_input0, sh_input1, sh_input2}, {OpCode::Id::END}},
+        {{OpCode::Id::DP3, sh_output, sh_input0, sh_input1}, {OpCode::Id::END}},
+        {{OpCode::Id::DP4, sh_output, sh_input0, sh_input1}, {OpCode::Id::END}},
+        {{OpCode::Id::DPH, sh_output, sh_input0, sh_input1}, {OpCode::Id::END}},
+        {{OpCode::Id::MAX, sh_output, sh_input0, sh_input1}, {OpCode::Id::END}},
+        {{OpCode::Id::MIN, sh_output, sh_input0, sh_input1}, {OpCode::Id::END}},
+        {{OpCode::Id::SGE, sh_output, sh_input0, sh_input1}, {OpCode::Id::END}},
+        {{OpCode::Id::SLT, sh_output, sh_input0, sh_input1}, {OpCode::Id::END}},
+        {{OpCode::Id::FLR, sh_output, sh_input0}, {OpCode::Id::END}},
+        {{OpCode::Id::MOV, sh_output, sh_input2}, {OpCode::Id::END}},
+        // clang-format on
+    };
+
+    const float inf = std::numeric_limits<float>::infinity();
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    // Inexact products and sums of very different magnitudes expose any difference in rounding
+    const std::array<float, 11> values = {0.f,  -0.f,  1.f, -2.5f, 3.75f, 1.e-3f,
+                                          0.1f, 1.e8f, inf, -inf,  nan};
+
+    Pica::Shader::InterpreterEngine interpreter;
+
+    for (const auto& program : programs) {
+        auto setup = AssembleShader(program);
+        interpreter.SetupBatch(*setup, 0);
+
+        for (const bool use_avx : GetSupportedTiers()) {
+            const auto shader = CompileShader(program, use_avx);
+
+            for (std::size_t i = 0; i < values.size(); ++i) {
+                for (std::size_t j = 0; j < values.size(); ++j) {
+                    Pica::Shader::UnitState jit_unit;
+                    for (std::size_t reg = 0; reg < 3; ++reg) {
+                        for (std::size_t comp = 0; comp < 4; ++comp) {
+                            const float value = values[(i * (reg + 1) + j * comp + reg) %
+                                                       values.size()];
+                            jit_unit.registers.input[reg][comp] = float24::FromFloat32(value);
+                        }
+                    }
+                    Pica::Shader::UnitState interpreter_unit = jit_unit;
+
+                    shader->Run(*setup, jit_unit, 0);
+                    interpreter.Run(*setup, interpreter_unit);
+
+                    for (std::size_t comp = 0; comp < 4; ++comp) {
+                        const float jit = jit_unit.registers.output[0][comp].ToFloat32();
+                        const float reference =
+                            interpreter_unit.registers.output[0][comp].ToFloat32();
+                        INFO("tier " << (use_avx ? "AVX2" : "SSE") << ", inputs " << i
+                                     << ", " << j << ", component " << comp);
+                        REQUIRE(IsEquivalent(jit, reference));
+                    }
+                }
+            }
+        }
+    }
+}
+
+/// Encodes a flow control instruction, which the inline assembler doesn't support
+static u32 EncodeFlowControl(OpCode::Id opcode, u32 dest_offset, u32 num_instructions,
+                             u32 uniform_id = 0) {
+    return (static_cast<u32>(opcode) << 26) | (uniform_id << 22) | (dest_offset << 10) |
+           num_instructions;
+}
+
+/**
+ * Runs a program through the interpreter, the generic JIT and the JIT specialized for the uniform
+ * values, for every combination of the bool uniforms b0 and b1 and two loop parameters in i0.
+ */
+static void CheckSpecializedTier(ShaderSetup& setup, const std::vector<unsigned>& entry_points) {
+    const std::array<Common::Vec4<u8>, 2> loop_params = {Common::MakeVec<u8>(0, 0, 0, 0),
+                                                         Common::MakeVec<u8>(3, 2, 1, 0)};
+    const std::array<float, 4> values = {0.f, 1.f, -2.5f, 3.75f};
+
+    Pica::Shader::InterpreterEngine interpreter;
+
+    for (const bool use_avx : GetSupportedTiers()) {
+        auto generic = std::make_unique<JitShader>(use_avx);
+        generic->Compile(&setup.program_code, &setup.swizzle_data);
+
+        for (unsigned uniforms = 0; uniforms < 8; ++uniforms) {
+            setup.uniforms.b[0] = (uniforms & 1) != 0;
+            setup.uniforms.b[1] = (uniforms & 2) != 0;
+            setup.uniforms.i[0] = loop_params[uniforms >> 2];
+
+            for (const unsigned entry_point : entry_points) {
+                auto specialized = std::make_unique<JitShader>(use_avx);
+                specialized->Compile(&setup.program_code, &setup.swizzle_data, &setup.uniforms,
+                                     entry_point);
+                interpreter.SetupBatch(setup, entry_point);
+
+                for (const float a : values) {
+                    for (const float b : values) {
+                        Pica::Shader::UnitState generic_unit;
+                        for (std::size_t comp = 0; comp < 4; ++comp) {
+                            generic_unit.registers.input[0][comp] = float24::FromFloat32(a);
+                            generic_unit.registers.input[1][comp] = float24::FromFloat32(b);
+                        }
+                        Pica::Shader::UnitState specialized_unit = generic_unit;
+                        Pica::Shader::UnitState interpreter_unit = generic_unit;
+
+                        generic->Run(setup, generic_unit, entry_point);
+                        specialized->Run(setup, specialized_unit, entry_point);
+                        interpreter.Run(setup, interpreter_unit);
+
+                        const float reference =
+                            interpreter_unit.registers.output[0].x.ToFloat32();
+                        INFO("tier " << (use_avx ? "AVX2" : "SSE") << ", uniforms "
+                                     << uniforms << ", entry point " << entry_point
+                                     << ", inputs " << a << ", " << b);
+                        REQUIRE(IsEquivalent(generic_unit.registers.output[0].x.ToFloat32(),
+                                             reference));
+                        REQUIRE(IsEquivalent(specialized_unit.registers.output[0].x.ToFloat32(),
+                                             reference));
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Specialized JIT matches the generic JIT and the interpreter",
+          "[video_core][shader][shader_jit]") {
+    const auto sh_input0 = SourceRegister::MakeInput(0);
+    const auto sh_input1 = SourceRegister::MakeInput(1);
+    const auto sh_temp = SourceRegister::MakeTemporary(0);
+    const auto sh_temp_dest = DestRegister::MakeTemporary(0);
+    const auto sh_output = DestRegister::MakeOutput(0);
+
+    SECTION("IFU, JMPU and LOOP folding, with a CALL into a dead IFU arm") {
+        auto setup = AssembleShader({
+            // clang-format off
+            /* 0 */ {OpCode::Id::MOV, sh_temp_dest, sh_input0},
+            /* 1 */ {OpCode::Id::NOP}, // IFU b0: 2-3 if set, 4-5 otherwise
+            /* 2 */ {OpCode::Id::NOP}, // CALL 4-5
+            /* 3 */ {OpCode::Id::NOP},
+            /* 4 */ {OpCode::Id::ADD, sh_temp_dest, sh_temp, sh_input1},
+            /* 5 */ {OpCode::Id::MUL, sh_temp_dest, sh_temp, sh_input1},
+            /* 6 */ {OpCode::Id::NOP}, // JMPU b1 to 8
+            /* 7 */ {OpCode::Id::ADD, sh_temp_dest, sh_temp, sh_input0},
+            /* 8 */ {OpCode::Id::NOP}, // LOOP i0 over 9
+            /* 9 */ {OpCode::Id::ADD, sh_temp_dest, sh_temp, sh_input1},
+            /* 10 */ {OpCode::Id::MOV, sh_output, sh_temp},
+            /* 11 */ {OpCode::Id::END},
+            // clang-format on
+        });
+        setup->program_code[1] = EncodeFlowControl(OpCode::Id::IFU, 4, 2, 0);
+        setup->program_code[2] = EncodeFlowControl(OpCode::Id::CALL, 4, 2);
+        setup->program_code[6] = EncodeFlowControl(OpCode::Id::JMPU, 8, 0, 1);
+        setup->program_code[8] = EncodeFlowControl(OpCode::Id::LOOP, 9, 0, 0);
+
+        CheckSpecializedTier(*setup, {0});
+    }
+
+    SECTION("entry point in a dead IFU arm") {
+        auto setup = AssembleShader({
+            // clang-format off
+            /* 0 */ {OpCode::Id::NOP}, // IFU b0: 1 if set, 2-3 otherwise
+            /* 1 */ {OpCode::Id::MOV, sh_temp_dest, sh_input0},
+            /* 2 */ {OpCode::Id::MOV, sh_temp_dest, sh_input1},
+            /* 3 */ {OpCode::Id::ADD, sh_temp_dest, sh_temp, sh_input0},
+            /* 4 */ {OpCode::Id::MOV, sh_output, sh_temp},
+            /* 5 */ {OpCode::Id::END},
+            // clang-format on
+        });
+        setup->program_code[0] = EncodeFlowControl(OpCode::Id::IFU, 2, 2, 0);
+
+        CheckSpecializedTier(*setup, {0, 2});
+    }
+}
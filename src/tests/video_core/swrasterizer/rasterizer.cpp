@@ -0,0 +1,145 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/color.h"
+#include "core/memory.h"
+#include "video_core/pica_state.h"
+#include "video_core/regs_framebuffer.h"
+#include "video_core/swrasterizer/framebuffer.h"
+#include "video_core/swrasterizer/rasterizer.h"
+#include "video_core/video_core.h"
+
+using float24 = Pica::float24;
+using CompareFunc = Pica::FramebufferRegs::CompareFunc;
+
+constexpr u32 FRAMEBUFFER_SIZE = 64;
+constexpr u32 DEPTH_BUFFER_OFFSET = 0;
+constexpr u32 COLOR_BUFFER_OFFSET = FRAMEBUFFER_SIZE * FRAMEBUFFER_SIZE * 4;
+
+/// Raw float24 values of the viewport depth mappings
+constexpr u32 FLOAT24_ZERO = 0x000000;
+constexpr u32 FLOAT24_ONE = 0x3F0000;
+constexpr u32 FLOAT24_MINUS_ONE = 0xBF0000;
+
+/// Configures a D24S8 depth buffer and a depth test that writes the passing fragments
+static void SetupDepthTest(CompareFunc func, bool reversed_depth) {
+    auto& regs = Pica::g_state.regs;
+    std::memset(&regs, 0, sizeof(regs));
+
+    auto& framebuffer = regs.framebuffer.framebuffer;
+    framebuffer.allow_depth_stencil_write.Assign(1);
+    framebuffer.depth_format.Assign(Pica::FramebufferRegs::DepthFormat::D24S8);
+    framebuffer.color_format.Assign(Pica::FramebufferRegs::ColorFormat::RGBA8);
+    framebuffer.depth_buffer_address.Assign((Memory::FCRAM_PADDR + DEPTH_BUFFER_OFFSET) / 8);
+    framebuffer.color_buffer_address.Assign((Memory::FCRAM_PADDR + COLOR_BUFFER_OFFSET) / 8);
+    framebuffer.width.Assign(FRAMEBUFFER_SIZE);
+    framebuffer.height.Assign(FRAMEBUFFER_SIZE - 1);
+
+    auto& output_merger = regs.framebuffer.output_merger;
+    output_merger.depth_test_enable.Assign(1);
+    output_merger.depth_test_func.Assign(func);
+    output_merger.depth_write_enable.Assign(1);
+
+    regs.rasterizer.depthmap_enable.Assign(Pica::RasterizerRegs::DepthBuffering::ZBuffering);
+    regs.rasterizer.viewport_depth_range.Assign(reversed_depth ? FLOAT24_MINUS_ONE : FLOAT24_ONE);
+    regs.rasterizer.viewport_depth_near_plane.Assign(reversed_depth ? FLOAT24_ONE : FLOAT24_ZERO);
+    regs.lighting.disable.Assign(1);
+}
+
+/**
+ * Configures a stencil test that leaves the stencil buffer untouched but still has a depth fail
+ * action, which keeps the rasterizer from skipping occluded tiles.
+ */
+static void DisableDepthTiles() {
+    auto& stencil_test = Pica::g_state.regs.framebuffer.output_merger.stencil_test;
+    stencil_test.enable.Assign(1);
+    stencil_test.func.Assign(CompareFunc::Always);
+    stencil_test.write_mask.Assign(0);
+    stencil_test.action_depth_fail.Assign(Pica::FramebufferRegs::StencilAction::Replace);
+}
+
+/// Fills every 8x8 tile of the depth buffer, which is contiguous in memory, with depths close to
+/// a level picked for the tile, so that the tiles have narrow depth ranges
+static void FillDepthBuffer(Memory::MemorySystem& memory, std::mt19937& random) {
+    u8* depth_buffer = memory.GetFCRAMPointer(DEPTH_BUFFER_OFFSET);
+    constexpr u32 pixels_per_tile = 64;
+    std::uniform_int_distribution<u32> level(1, 3);
+    std::uniform_int_distribution<u32> noise(0, 1);
+    for (u32 tile = 0; tile < FRAMEBUFFER_SIZE * FRAMEBUFFER_SIZE / pixels_per_tile; ++tile) {
+        const u32 tile_depth = level(random) * 0x400000;
+        for (u32 pixel = 0; pixel < pixels_per_tile; ++pixel) {
+            Color::EncodeD24S8(tile_depth + noise(random), 0,
+                               depth_buffer + (tile * pixels_per_tile + pixel) * 4);
+        }
+    }
+}
+
+/// Returns a vertex at the given screen position
+static Pica::Rasterizer::Vertex MakeVertex(float x, float y, float z) {
+    Pica::Shader::OutputVertex output{};
+    output.pos.w = float24::FromFloat32(1.0f);
+    Pica::Rasterizer::Vertex vertex(output);
+    vertex.screenpos = Common::MakeVec(float24::FromFloat32(x), float24::FromFloat32(y),
+                                       float24::FromFloat32(z));
+    return vertex;
+}
+
+/// Draws random triangles whose depths lie close to the levels of the depth buffer, within the
+/// rounding of the interpolation, and returns the resulting depth buffer
+static std::vector<u8> DrawTriangles(Memory::MemorySystem& memory, u32 seed, bool reversed_depth) {
+    std::mt19937 random(seed);
+    FillDepthBuffer(memory, random);
+
+    std::uniform_real_distribution<float> position(0.0f, static_cast<float>(FRAMEBUFFER_SIZE));
+    std::uniform_int_distribution<u32> level(1, 3);
+    std::uniform_real_distribution<float> noise(-1.5e-7f, 1.5e-7f);
+    const auto random_depth = [&] {
+        const float depth = level(random) * 0.25f + noise(random);
+        return reversed_depth ? 1.0f - depth : depth;
+    };
+
+    Pica::Rasterizer::DepthTileCache depth_tiles;
+    for (int i = 0; i < 200; ++i) {
+        const float z = random_depth();
+        // Triangles are mostly flat, but some of them cross a level
+        const float z2 = i % 4 == 0 ? random_depth() : z + noise(random);
+        Pica::Rasterizer::ProcessTriangle(MakeVertex(position(random), position(random), z),
+                                          MakeVertex(position(random), position(random), z),
+                                          MakeVertex(position(random), position(random), z2),
+                                          depth_tiles);
+    }
+
+    const u8* depth_buffer = memory.GetFCRAMPointer(DEPTH_BUFFER_OFFSET);
+    return std::vector<u8>(depth_buffer, depth_buffer + FRAMEBUFFER_SIZE * FRAMEBUFFER_SIZE * 4);
+}
+
+TEST_CASE("Skipping occluded depth tiles matches testing every fragment",
+          "[video_core][swrasterizer]") {
+    Memory::MemorySystem memory;
+    VideoCore::g_memory = &memory;
+
+    for (const CompareFunc func : {CompareFunc::LessThan, CompareFunc::LessThanOrEqual,
+                                   CompareFunc::GreaterThan, CompareFunc::GreaterThanOrEqual}) {
+        for (const bool reversed_depth : {false, true}) {
+            for (u32 seed = 0; seed < 8; ++seed) {
+                INFO("func " << static_cast<u32>(func) << ", reversed " << reversed_depth
+                             << ", seed " << seed);
+
+                SetupDepthTest(func, reversed_depth);
+                const std::vector<u8> skipped = DrawTriangles(memory, seed, reversed_depth);
+
+                DisableDepthTiles();
+                const std::vector<u8> expected = DrawTriangles(memory, seed, reversed_depth);
+
+                REQUIRE(skipped == expected);
+            }
+        }
+    }
+
+    VideoCore::g_memory = nullptr;
+}
@@ -0,0 +1,146 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <catch2/catch.hpp>
+#include "core/memory.h"
+#include "video_core/debug_utils/debug_utils.h"
+#include "video_core/pica_state.h"
+#include "video_core/regs_pipeline.h"
+#include "video_core/shader/shader.h"
+#include "video_core/vertex_loader.h"
+#include "video_core/video_core.h"
+
+using float24 = Pica::float24;
+using Format = Pica::PipelineRegs::VertexAttributeFormat;
+using VertexLoader = Pica::VertexLoader;
+
+/// Compares two loaded attributes bit for bit, NaNs only need to match in kind
+static bool IsIdentical(const Pica::Shader::AttributeBuffer& a,
+                        const Pica::Shader::AttributeBuffer& b, int num_attributes) {
+    for (int i = 0; i < num_attributes; ++i) {
+        for (std::size_t comp = 0; comp < 4; ++comp) {
+            const float x = a.attr[i][comp].ToFloat32();
+            const float y = b.attr[i][comp].ToFloat32();
+            if (std::isnan(x) || std::isnan(y)) {
+                if (std::isnan(x) != std::isnan(y)) {
+                    return false;
+                }
+            } else if (std::memcmp(&x, &y, sizeof(float)) != 0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/// Loads the same vertices with a compiled and an interpreted loader and compares the results
+static void CompareLoaders(const Pica::PipelineRegs& regs, int num_vertices) {
+    VideoCore::g_shader_jit_enabled = false;
+    VertexLoader interpreted(regs);
+    VideoCore::g_shader_jit_enabled = true;
+    VertexLoader compiled(regs);
+
+    Pica::DebugUtils::MemoryAccessTracker memory_accesses;
+    const u32 base_address = regs.vertex_attributes.GetPhysicalBaseAddress();
+    for (int vertex = 0; vertex < num_vertices; ++vertex) {
+        Pica::Shader::AttributeBuffer expected{};
+        Pica::Shader::AttributeBuffer result{};
+        interpreted.LoadVertex<false>(base_address, vertex, vertex, expected, memory_accesses);
+        compiled.LoadVertex<false>(base_address, vertex, vertex, result, memory_accesses);
+
+        INFO("vertex " << vertex);
+        REQUIRE(IsIdentical(expected, result, interpreted.GetNumTotalAttributes()));
+    }
+}
+
+TEST_CASE("VertexLoaderJit matches VertexLoader", "[video_core][vertex_loader]") {
+    Memory::MemorySystem memory;
+    VideoCore::g_memory = &memory;
+
+    // Random vertex data, which covers negative, denormal and NaN values for every format
+    constexpr u32 data_size = 0x10000;
+    std::mt19937 random(0x3DC);
+    u8* data = memory.GetFCRAMPointer(0);
+    for (u32 i = 0; i < data_size; ++i) {
+        data[i] = static_cast<u8>(random());
+    }
+
+    for (int i = 0; i < 16; ++i) {
+        Pica::g_state.input_default_attributes.attr[i] =
+            Common::Vec4<float24>::AssignToAll(float24::FromFloat32(static_cast<float>(i)));
+    }
+
+    const bool restore_jit = VideoCore::g_shader_jit_enabled;
+
+    SECTION("single attribute, every format, element count and stride") {
+        for (const Format format : {Format::BYTE, Format::UBYTE, Format::SHORT, Format::FLOAT}) {
+            for (u32 elements = 1; elements <= 4; ++elements) {
+                Pica::PipelineRegs regs{};
+                auto& attributes = regs.vertex_attributes;
+                attributes.base_address.Assign(Memory::FCRAM_PADDR / 16);
+                attributes.format0.Assign(format);
+                attributes.size0.Assign(elements - 1);
+                attributes.max_attribute_index.Assign(0);
+
+                const u32 size = attributes.GetStride(0);
+                // Tightly packed, unaligned and padded strides
+                for (const u32 stride : {size, size + 1, size + 3, size + 16, 255u}) {
+                    INFO("format " << static_cast<u32>(format) << ", elements " << elements
+                                   << ", stride " << stride);
+                    auto& loader = attributes.attribute_loaders[0];
+                    loader.data_offset.Assign(stride % 7);
+                    loader.comp0.Assign(0);
+                    loader.byte_count.Assign(stride);
+                    loader.component_count.Assign(1);
+                    CompareLoaders(regs, 64);
+                }
+            }
+        }
+    }
+
+    SECTION("several loaders with interleaved, padded and default attributes") {
+        Pica::PipelineRegs regs{};
+        auto& attributes = regs.vertex_attributes;
+        attributes.base_address.Assign(Memory::FCRAM_PADDR / 16 + 1);
+        attributes.format0.Assign(Format::FLOAT);
+        attributes.size0.Assign(2);
+        attributes.format1.Assign(Format::UBYTE);
+        attributes.size1.Assign(3);
+        attributes.format2.Assign(Format::SHORT);
+        attributes.size2.Assign(1);
+        attributes.format4.Assign(Format::BYTE);
+        attributes.size4.Assign(2);
+        attributes.format5.Assign(Format::SHORT);
+        attributes.size5.Assign(2);
+        // Attributes 3 and 6 come from the default attributes, attribute 7 isn't loaded at all
+        attributes.attribute_mask.Assign((1 << 3) | (1 << 6));
+        attributes.max_attribute_index.Assign(7);
+
+        // Position, color with a 4-byte padding and texture coordinate interleaved
+        auto& loader0 = attributes.attribute_loaders[0];
+        loader0.data_offset.Assign(0x10);
+        loader0.comp0.Assign(0);
+        loader0.comp1.Assign(1);
+        loader0.comp2.Assign(12);
+        loader0.comp3.Assign(2);
+        loader0.byte_count.Assign(24);
+        loader0.component_count.Assign(4);
+
+        // Two attributes with an odd stride from a separate array
+        auto& loader1 = attributes.attribute_loaders[1];
+        loader1.data_offset.Assign(0x2003);
+        loader1.comp0.Assign(4);
+        loader1.comp1.Assign(5);
+        loader1.byte_count.Assign(11);
+        loader1.component_count.Assign(2);
+
+        CompareLoaders(regs, 256);
+    }
+
+    VideoCore::g_shader_jit_enabled = restore_jit;
+    VideoCore::g_memory = nullptr;
+}
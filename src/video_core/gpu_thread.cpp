@@ -0,0 +1,187 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/assert.h"
+#include "common/microprofile.h"
+#include "common/thread.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/frontend/emu_window.h"
+#include "core/memory.h"
+#include "video_core/command_processor.h"
+#include "video_core/gpu_thread.h"
+#include "video_core/rasterizer_interface.h"
+#include "video_core/renderer_base.h"
+#include "video_core/video_core.h"
+
+namespace VideoCore::GPUThread {
+
+MICROPROFILE_DEFINE(GPU_ThreadWait, "GPU", "Wait for GPU thread", MP_RGB(128, 128, 192));
+
+void SynchState::WaitForSynchronization(u64 fence) {
+    if (signaled_fence >= fence) {
+        return;
+    }
+
+    MICROPROFILE_SCOPE(GPU_ThreadWait);
+    std::unique_lock lock{synchronization_mutex};
+    synchronization_condition.wait(lock, [this, fence] { return signaled_fence >= fence; });
+}
+
+void SynchState::SignalFence(u64 fence) {
+    {
+        std::lock_guard lock{synchronization_mutex};
+        signaled_fence = fence;
+    }
+    synchronization_condition.notify_all();
+}
+
+void SynchState::NotifyCommandsPushed() {
+    {
+        // The queue itself is lock-free, taking the mutex here only orders the push against the
+        // emptiness check in WaitForCommands so that the wake-up can't be lost.
+        std::lock_guard lock{commands_mutex};
+    }
+    commands_condition.notify_one();
+}
+
+void SynchState::WaitForCommands() {
+    std::unique_lock lock{commands_mutex};
+    commands_condition.wait(lock, [this] { return !queue.Empty() || !is_running; });
+}
+
+ThreadManager::ThreadManager(RendererBase& renderer, Frontend::EmuWindow& emu_window)
+    : renderer{renderer}, emu_window{emu_window} {
+    // The renderer has been initialized on this thread, hand the context over to the GPU thread
+    emu_window.DoneCurrent();
+    thread = std::thread(&ThreadManager::RunThread, this);
+    thread_id = thread.get_id();
+}
+
+ThreadManager::~ThreadManager() {
+    WaitIdle();
+
+    state.is_running = false;
+    state.NotifyCommandsPushed();
+    thread.join();
+
+    // Take the context back so that the renderer can be destroyed on this thread
+    emu_window.MakeCurrent();
+}
+
+void ThreadManager::RunThread() {
+    Common::SetCurrentThreadName("GPU");
+    MicroProfileOnThreadCreate("GpuThread");
+
+    emu_window.MakeCurrent();
+
+    while (state.is_running) {
+        CommandDataContainer next;
+        if (!state.queue.Pop(next)) {
+            state.WaitForCommands();
+            continue;
+        }
+
+        ExecuteCommand(&next.data);
+        state.SignalFence(next.fence);
+    }
+
+    emu_window.DoneCurrent();
+
+#if MICROPROFILE_ENABLED
+    MicroProfileOnThreadExit();
+#endif
+}
+
+void ThreadManager::ExecuteCommand(CommandData* command) {
+    auto* rasterizer = renderer.Rasterizer();
+
+    if (const auto submit_list = std::get_if<SubmitListCommand>(command)) {
+        Pica::CommandProcessor::ProcessCommandList(
+            submit_list->list.data(), static_cast<u32>(submit_list->list.size() * sizeof(u32)));
+    } else if (const auto memory_fill = std::get_if<MemoryFillCommand>(command)) {
+        GPU::ProcessMemoryFill(memory_fill->config, memory_fill->is_second_filler);
+    } else if (const auto display_transfer = std::get_if<DisplayTransferCommand>(command)) {
+        GPU::ProcessDisplayTransfer(display_transfer->config);
+    } else if (std::holds_alternative<SwapBuffersCommand>(*command)) {
+        renderer.SwapBuffers();
+    } else if (const auto flush = std::get_if<FlushRegionCommand>(command)) {
+        rasterizer->FlushRegion(flush->addr, flush->size);
+    } else if (const auto invalidate = std::get_if<InvalidateRegionCommand>(command)) {
+        rasterizer->InvalidateRegion(invalidate->addr, invalidate->size);
+    } else if (const auto flush_and_invalidate =
+                   std::get_if<FlushAndInvalidateRegionCommand>(command)) {
+        rasterizer->FlushAndInvalidateRegion(flush_and_invalidate->addr,
+                                             flush_and_invalidate->size);
+    } else {
+        UNREACHABLE();
+    }
+}
+
+u64 ThreadManager::PushCommand(CommandData&& command_data) {
+    const u64 fence = ++state.last_fence;
+    state.queue.Push(CommandDataContainer(std::move(command_data), fence));
+    state.NotifyCommandsPushed();
+    return fence;
+}
+
+void ThreadManager::SubmitList(const u32* list, u32 size) {
+    PushCommand(SubmitListCommand{std::vector<u32>(list, list + size / sizeof(u32))});
+}
+
+u64 ThreadManager::MemoryFill(const GPU::Regs::MemoryFillConfig& config, bool is_second_filler) {
+    return PushCommand(MemoryFillCommand{config, is_second_filler});
+}
+
+void ThreadManager::DisplayTransfer(const GPU::Regs::DisplayTransferConfig& config) {
+    PushCommand(DisplayTransferCommand{config});
+}
+
+void ThreadManager::SwapBuffers() {
+    auto& system = Core::System::GetInstance();
+    system.perf_stats.EndSystemFrame();
+
+    // SDL requires events to be pumped on the thread that created the window
+    emu_window.PollEvents();
+
+    // Let the emulation thread run at most one frame ahead of the GPU thread
+    const u64 fence = PushCommand(SwapBuffersCommand{});
+    state.WaitForSynchronization(last_swap_fence);
+    last_swap_fence = fence;
+    VideoCore::g_memory->ApplyPendingRasterizerMarks();
+
+    system.frame_limiter.DoFrameLimiting(system.CoreTiming().GetGlobalTimeUs());
+    system.perf_stats.BeginSystemFrame();
+}
+
+void ThreadManager::FlushRegion(PAddr addr, u32 size) {
+    if (IsGPUThread()) {
+        renderer.Rasterizer()->FlushRegion(addr, size);
+        return;
+    }
+    state.WaitForSynchronization(PushCommand(FlushRegionCommand{addr, size}));
+}
+
+void ThreadManager::InvalidateRegion(PAddr addr, u32 size) {
+    if (IsGPUThread()) {
+        renderer.Rasterizer()->InvalidateRegion(addr, size);
+        return;
+    }
+    state.WaitForSynchronization(PushCommand(InvalidateRegionCommand{addr, size}));
+}
+
+void ThreadManager::FlushAndInvalidateRegion(PAddr addr, u32 size) {
+    if (IsGPUThread()) {
+        renderer.Rasterizer()->FlushAndInvalidateRegion(addr, size);
+        return;
+    }
+    state.WaitForSynchronization(PushCommand(FlushAndInvalidateRegionCommand{addr, size}));
+}
+
+void ThreadManager::WaitIdle() {
+    state.WaitForSynchronization(state.last_fence);
+    VideoCore::g_memory->ApplyPendingRasterizerMarks();
+}
+
+} // namespace VideoCore::GPUThread
@@ -0,0 +1,176 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <variant>
+#include <vector>
+#include "common/common_types.h"
+#include "common/threadsafe_queue.h"
+#include "core/hw/gpu.h"
+
+namespace Frontend {
+class EmuWindow;
+}
+
+class RendererBase;
+
+namespace VideoCore::GPUThread {
+
+/// Command to process a PICA command list. The list is copied, as the emulated CPU may reuse its
+/// buffer before the GPU thread gets to it.
+struct SubmitListCommand final {
+    std::vector<u32> list;
+};
+
+/// Command to perform a PSC memory fill
+struct MemoryFillCommand final {
+    GPU::Regs::MemoryFillConfig config;
+    bool is_second_filler;
+};
+
+/// Command to perform a PPF display transfer or texture copy
+struct DisplayTransferCommand final {
+    GPU::Regs::DisplayTransferConfig config;
+};
+
+/// Command to draw the screens and present them to the render window
+struct SwapBuffersCommand final {};
+
+/// Command to write back rasterizer cached surfaces touching a region to emulated memory
+struct FlushRegionCommand final {
+    PAddr addr;
+    u32 size;
+};
+
+/// Command to drop rasterizer cached surfaces touching a region
+struct InvalidateRegionCommand final {
+    PAddr addr;
+    u32 size;
+};
+
+/// Command to write back and then drop rasterizer cached surfaces touching a region
+struct FlushAndInvalidateRegionCommand final {
+    PAddr addr;
+    u32 size;
+};
+
+using CommandData =
+    std::variant<SubmitListCommand, MemoryFillCommand, DisplayTransferCommand, SwapBuffersCommand,
+                 FlushRegionCommand, InvalidateRegionCommand, FlushAndInvalidateRegionCommand>;
+
+struct CommandDataContainer {
+    CommandDataContainer() = default;
+
+    CommandDataContainer(CommandData&& data, u64 next_fence)
+        : data{std::move(data)}, fence{next_fence} {}
+
+    CommandData data;
+    u64 fence{};
+};
+
+/// Struct used to synchronize the GPU thread
+struct SynchState final {
+    std::atomic_bool is_running{true};
+
+    /// Fence of the last command pushed by the emulation thread
+    u64 last_fence{};
+    /// Fence of the last command completed by the GPU thread
+    std::atomic<u64> signaled_fence{};
+
+    Common::SPSCQueue<CommandDataContainer> queue;
+
+    std::mutex commands_mutex;
+    std::condition_variable commands_condition;
+
+    std::mutex synchronization_mutex;
+    std::condition_variable synchronization_condition;
+
+    /// Blocks the calling thread until the given fence has been signaled by the GPU thread
+    void WaitForSynchronization(u64 fence);
+
+    /// Marks all commands up to and including the given fence as completed
+    void SignalFence(u64 fence);
+
+    /// Wakes up the GPU thread after a command has been pushed to the queue
+    void NotifyCommandsPushed();
+
+    /// Blocks the GPU thread until there are commands in the queue or the thread is stopped
+    void WaitForCommands();
+};
+
+/**
+ * Runs PICA command lists, memory fills, display transfers and buffer swaps on a dedicated host
+ * thread, so that rendering overlaps with CPU emulation. The emulation thread only ever talks to
+ * the rasterizer through this class while it is alive; the GL context is owned by the GPU thread.
+ *
+ * Emulated memory that the rasterizer cache has marked is synchronized with fences: flushes and
+ * invalidations requested by the emulation thread block until the GPU thread has caught up with
+ * every command pushed before them. Pages the rasterizer cache marks or unmarks on the GPU thread
+ * are only patched into the page tables by the emulation thread, between two CPU slices and
+ * after buffer swaps, because the CPU reads the page tables without synchronization.
+ */
+class ThreadManager final {
+public:
+    ThreadManager(RendererBase& renderer, Frontend::EmuWindow& emu_window);
+    ~ThreadManager();
+
+    /// Queues a copy of a PICA command list for processing
+    void SubmitList(const u32* list, u32 size);
+
+    /// Queues a PSC memory fill and returns the fence signaled once it has been performed
+    u64 MemoryFill(const GPU::Regs::MemoryFillConfig& config, bool is_second_filler);
+
+    /// Queues a PPF display transfer or texture copy
+    void DisplayTransfer(const GPU::Regs::DisplayTransferConfig& config);
+
+    /// Queues a buffer swap, keeping at most one frame in flight
+    void SwapBuffers();
+
+    /// Flushes the region on the GPU thread and waits for it to complete
+    void FlushRegion(PAddr addr, u32 size);
+
+    /// Invalidates the region on the GPU thread and waits for it to complete
+    void InvalidateRegion(PAddr addr, u32 size);
+
+    /// Flushes and invalidates the region on the GPU thread and waits for it to complete
+    void FlushAndInvalidateRegion(PAddr addr, u32 size);
+
+    /// Blocks until every command pushed so far has been executed
+    void WaitIdle();
+
+    /// Returns true if the command with the given fence has been executed
+    bool IsFenceSignaled(u64 fence) const {
+        return state.signaled_fence >= fence;
+    }
+
+    /// Returns true if the calling thread is the GPU thread
+    bool IsGPUThread() const {
+        return std::this_thread::get_id() == thread_id;
+    }
+
+private:
+    /// Pushes a command to be executed by the GPU thread and returns its fence
+    u64 PushCommand(CommandData&& command_data);
+
+    /// Entry point of the GPU thread
+    void RunThread();
+
+    /// Executes a single command on the GPU thread
+    void ExecuteCommand(CommandData* command);
+
+    RendererBase& renderer;
+    Frontend::EmuWindow& emu_window;
+    SynchState state;
+    /// Fence of the last queued buffer swap, used to limit the number of frames in flight
+    u64 last_swap_fence{};
+    std::thread thread;
+    std::thread::id thread_id;
+};
+
+} // namespace VideoCore::GPUThread
@@ -6,6 +6,7 @@
 #include "video_core/geometry_pipeline.h"
 #include "video_core/pica.h"
 #include "video_core/pica_state.h"
+#include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_base.h"
 #include "video_core/video_core.h"
 
@@ -26,21 +27,24 @@ void Zero(T& o) {
     memset(&o, 0, sizeof(o));
 }
 
-State::State() : geometry_pipeline(*this) {
-    auto SubmitVertex = [this](const Shader::AttributeBuffer& vertex) {
-        using Pica::Shader::OutputVertex;
-        auto AddTriangle = [this](const OutputVertex& v0, const OutputVertex& v1,
-                                  const OutputVertex& v2) {
-            VideoCore::g_renderer->Rasterizer()->AddTriangle(v0, v1, v2);
-        };
-        primitive_assembler.SubmitVertex(
-            Shader::OutputVertex::FromAttributeBuffer(regs.rasterizer, vertex), AddTriangle);
-    };
-
-    auto SetWinding = [this]() { primitive_assembler.SetWinding(); };
-
-    g_state.gs_unit.SetVertexHandler(SubmitVertex, SetWinding);
-    g_state.geometry_pipeline.SetVertexHandler(SubmitVertex);
+State::State() : geometry_pipeline(*this) {}
+
+void State::SubmitVertex(const Shader::AttributeBuffer& vertex) {
+    primitive_assembler.SubmitVertex(
+        Shader::OutputVertex::FromAttributeBuffer(regs.rasterizer, vertex));
+    if (primitive_assembler.IsBatchFull()) {
+        FlushTriangles();
+    }
+}
+
+void State::FlushTriangles() {
+    const std::size_t num_triangles = primitive_assembler.GetNumBatchedTriangles();
+    if (num_triangles == 0) {
+        return;
+    }
+    VideoCore::g_renderer->Rasterizer()->AddTriangles(primitive_assembler.GetBatchedVertices(),
+                                                      num_triangles);
+    primitive_assembler.ClearBatch();
 }
 
 void State::Reset() {
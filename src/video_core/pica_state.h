@@ -20,6 +20,12 @@ struct State {
     State();
     void Reset();
 
+    /// Queues a vertex output by the vertex or geometry shader for primitive assembly
+    void SubmitVertex(const Shader::AttributeBuffer& vertex);
+
+    /// Hands the triangles assembled so far to the rasterizer
+    void FlushTriangles();
+
     /// Pica registers
     Regs regs;
 
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include "common/assert.h"
 #include "common/logging/log.h"
 #include "video_core/primitive_assembly.h"
 #include "video_core/regs_pipeline.h"
@@ -11,11 +12,21 @@ namespace Pica {
 
 template <typename VertexType>
 PrimitiveAssembler<VertexType>::PrimitiveAssembler(PipelineRegs::TriangleTopology topology)
-    : topology(topology), buffer_index(0) {}
+    : topology(topology), buffer_index(0) {
+    batch.reserve(MAX_BATCHED_TRIANGLES * 3);
+}
+
+template <typename VertexType>
+void PrimitiveAssembler<VertexType>::AddTriangle(const VertexType& v0, const VertexType& v1,
+                                                 const VertexType& v2) {
+    DEBUG_ASSERT(!IsBatchFull());
+    batch.push_back(v0);
+    batch.push_back(v1);
+    batch.push_back(v2);
+}
 
 template <typename VertexType>
-void PrimitiveAssembler<VertexType>::SubmitVertex(const VertexType& vtx,
-                                                  TriangleHandler triangle_handler) {
+void PrimitiveAssembler<VertexType>::SubmitVertex(const VertexType& vtx) {
     switch (topology) {
     case PipelineRegs::TriangleTopology::List:
     case PipelineRegs::TriangleTopology::Shader:
@@ -24,10 +35,10 @@ void PrimitiveAssembler<VertexType>::SubmitVertex(const VertexType& vtx,
         } else {
             buffer_index = 0;
             if (topology == PipelineRegs::TriangleTopology::Shader && winding) {
-                triangle_handler(buffer[1], buffer[0], vtx);
+                AddTriangle(buffer[1], buffer[0], vtx);
                 winding = false;
             } else {
-                triangle_handler(buffer[0], buffer[1], vtx);
+                AddTriangle(buffer[0], buffer[1], vtx);
             }
         }
         break;
@@ -35,7 +46,7 @@ void PrimitiveAssembler<VertexType>::SubmitVertex(const VertexType& vtx,
     case PipelineRegs::TriangleTopology::Strip:
     case PipelineRegs::TriangleTopology::Fan:
         if (strip_ready)
-            triangle_handler(buffer[0], buffer[1], vtx);
+            AddTriangle(buffer[0], buffer[1], vtx);
 
         buffer[buffer_index] = vtx;
 
@@ -4,7 +4,8 @@
 
 #pragma once
 
-#include <functional>
+#include <cstddef>
+#include <vector>
 #include "video_core/regs_pipeline.h"
 
 namespace Pica {
@@ -12,22 +13,42 @@ namespace Pica {
 /*
  * Utility class to build triangles from a series of vertices,
  * according to a given triangle topology.
+ * Assembled triangles are stored as a triangle list in a preallocated batch, which the owner
+ * hands to the rasterizer in one go.
  */
 template <typename VertexType>
 struct PrimitiveAssembler {
-    using TriangleHandler =
-        std::function<void(const VertexType& v0, const VertexType& v1, const VertexType& v2)>;
+    /// Number of triangles the batch can hold before it has to be flushed
+    static constexpr std::size_t MAX_BATCHED_TRIANGLES = 256;
 
     PrimitiveAssembler(
         PipelineRegs::TriangleTopology topology = PipelineRegs::TriangleTopology::List);
 
     /*
      * Queues a vertex, builds primitives from the vertex queue according to the given
-     * triangle topology, and calls triangle_handler for each generated primitive.
-     * NOTE: We could specify the triangle handler in the constructor, but this way we can
-     * keep event and handler code next to each other.
+     * triangle topology, and appends each generated primitive to the batch.
      */
-    void SubmitVertex(const VertexType& vtx, TriangleHandler triangle_handler);
+    void SubmitVertex(const VertexType& vtx);
+
+    /// Returns the vertices of the batched triangles, three consecutive vertices per triangle
+    const VertexType* GetBatchedVertices() const {
+        return batch.data();
+    }
+
+    /// Returns the number of triangles in the batch
+    std::size_t GetNumBatchedTriangles() const {
+        return batch.size() / 3;
+    }
+
+    /// Returns whether the batch has no room left for another triangle
+    bool IsBatchFull() const {
+        return batch.size() == MAX_BATCHED_TRIANGLES * 3;
+    }
+
+    /// Empties the batch. The vertex queue used to build strips and fans is left untouched.
+    void ClearBatch() {
+        batch.clear();
+    }
 
     /**
      * Invert the vertex order of the next triangle. Called by geometry shader emitter.
@@ -56,8 +77,13 @@ struct PrimitiveAssembler {
     PipelineRegs::TriangleTopology GetTopology() const;
 
 private:
+    /// Appends a triangle to the batch
+    void AddTriangle(const VertexType& v0, const VertexType& v1, const VertexType& v2);
+
     PipelineRegs::TriangleTopology topology;
 
+    std::vector<VertexType> batch;
+
     int buffer_index;
     VertexType buffer[2];
     bool strip_ready = false;
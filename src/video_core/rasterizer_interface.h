@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include "common/common_types.h"
 #include "core/hw/gpu.h"
 
@@ -21,10 +22,13 @@ class RasterizerInterface {
 public:
     virtual ~RasterizerInterface() {}
 
-    /// Queues the primitive formed by the given vertices for rendering
-    virtual void AddTriangle(const Pica::Shader::OutputVertex& v0,
-                             const Pica::Shader::OutputVertex& v1,
-                             const Pica::Shader::OutputVertex& v2) = 0;
+    /**
+     * Queues a batch of primitives for rendering
+     * @param vertices Triangle list holding three consecutive vertices per triangle
+     * @param num_triangles Number of triangles in the batch
+     */
+    virtual void AddTriangles(const Pica::Shader::OutputVertex* vertices,
+                              std::size_t num_triangles) = 0;
 
     /// Draw the current batch of triangles
     virtual void DrawTriangles() = 0;
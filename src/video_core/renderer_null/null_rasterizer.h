@@ -0,0 +1,28 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/common_types.h"
+#include "video_core/rasterizer_interface.h"
+
+namespace Pica::Shader {
+struct OutputVertex;
+} // namespace Pica::Shader
+
+namespace VideoCore {
+
+/// Rasterizer that discards every primitive, leaving emulated framebuffers untouched
+class NullRasterizer : public RasterizerInterface {
+    void AddTriangles(const Pica::Shader::OutputVertex* vertices,
+                      std::size_t num_triangles) override {}
+    void DrawTriangles() override {}
+    void NotifyPicaRegisterChanged(u32 id) override {}
+    void FlushAll() override {}
+    void FlushRegion(PAddr addr, u32 size) override {}
+    void InvalidateRegion(PAddr addr, u32 size) override {}
+    void FlushAndInvalidateRegion(PAddr addr, u32 size) override {}
+};
+
+} // namespace VideoCore
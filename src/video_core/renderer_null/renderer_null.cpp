@@ -0,0 +1,54 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/frontend/emu_window.h"
+#include "core/tracer/recorder.h"
+#include "video_core/debug_utils/debug_utils.h"
+#include "video_core/renderer_null/null_rasterizer.h"
+#include "video_core/renderer_null/renderer_null.h"
+#include "video_core/swrasterizer/swrasterizer.h"
+#include "video_core/video_core.h"
+
+namespace VideoCore {
+
+RendererNull::RendererNull(Frontend::EmuWindow& window, bool use_sw_rasterizer)
+    : RendererBase{window}, use_sw_rasterizer{use_sw_rasterizer} {}
+
+RendererNull::~RendererNull() = default;
+
+void RendererNull::SwapBuffers() {
+    // Frame pacing and window events are handled by the emulation thread when rendering on the
+    // GPU thread
+    if (!g_gpu_thread) {
+        auto& system = Core::System::GetInstance();
+        system.perf_stats.EndSystemFrame();
+
+        render_window.PollEvents();
+
+        system.frame_limiter.DoFrameLimiting(system.CoreTiming().GetGlobalTimeUs());
+        system.perf_stats.BeginSystemFrame();
+    }
+
+    m_current_frame++;
+
+    if (Pica::g_debug_context && Pica::g_debug_context->recorder) {
+        Pica::g_debug_context->recorder->FrameFinished();
+    }
+}
+
+Core::System::ResultStatus RendererNull::Init() {
+    if (use_sw_rasterizer) {
+        rasterizer = std::make_unique<SWRasterizer>();
+    } else {
+        rasterizer = std::make_unique<NullRasterizer>();
+    }
+    return Core::System::ResultStatus::Success;
+}
+
+void RendererNull::ShutDown() {}
+
+} // namespace VideoCore
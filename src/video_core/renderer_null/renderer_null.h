@@ -0,0 +1,34 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "video_core/renderer_base.h"
+
+namespace VideoCore {
+
+/**
+ * Renderer that never touches a graphics API, so that it can run without a window or a GPU. It
+ * either drops all draws or runs the software rasterizer into emulated memory; in both cases
+ * nothing is ever presented. Frames are still paced and accounted for in the performance stats.
+ */
+class RendererNull : public RendererBase {
+public:
+    RendererNull(Frontend::EmuWindow& window, bool use_sw_rasterizer);
+    ~RendererNull() override;
+
+    /// Swap buffers (render frame)
+    void SwapBuffers() override;
+
+    /// Initialize the renderer
+    Core::System::ResultStatus Init() override;
+
+    /// Shutdown the renderer
+    void ShutDown() override;
+
+private:
+    bool use_sw_rasterizer;
+};
+
+} // namespace VideoCore
@@ -0,0 +1,141 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/assert.h"
+#include "core/core.h"
+#include "video_core/renderer_opengl/gl_frame_mailbox.h"
+#include "video_core/renderer_opengl/gl_state.h"
+
+namespace OpenGL {
+
+FrameMailbox::FrameMailbox() {
+    for (auto& frame : swap_chain) {
+        free_queue.push_back(&frame);
+    }
+}
+
+FrameMailbox::~FrameMailbox() {
+    // The presentation thread has been stopped by now, so the remaining fences belong to the
+    // render context, which is current on this thread.
+    for (auto& frame : swap_chain) {
+        if (frame.render_fence) {
+            glDeleteSync(frame.render_fence);
+        }
+        if (frame.present_fence) {
+            glDeleteSync(frame.present_fence);
+        }
+    }
+}
+
+Frame* FrameMailbox::GetRenderFrame() {
+    std::lock_guard lock{swap_chain_lock};
+
+    if (!free_queue.empty()) {
+        Frame* frame = free_queue.front();
+        free_queue.pop_front();
+        return frame;
+    }
+
+    // The presentation thread is lagging behind, overwrite the oldest frame it hasn't picked up
+    ASSERT(!present_queue.empty());
+    Frame* frame = present_queue.front();
+    present_queue.pop_front();
+    Core::System::GetInstance().perf_stats.AddDroppedFrame();
+    return frame;
+}
+
+void FrameMailbox::ReloadRenderFrame(Frame* frame, u32 width, u32 height) {
+    OpenGLState prev_state = OpenGLState::GetCurState();
+    OpenGLState state = OpenGLState::GetCurState();
+
+    frame->color.Release();
+    frame->color.Create();
+    state.texture_units[0].texture_2d = frame->color.handle;
+    state.Apply();
+    glActiveTexture(GL_TEXTURE0);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                 nullptr);
+
+    frame->render.Release();
+    frame->render.Create();
+    state.draw.read_framebuffer = frame->render.handle;
+    state.draw.draw_framebuffer = frame->render.handle;
+    state.Apply();
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                           frame->color.handle, 0);
+
+    prev_state.Apply();
+
+    frame->width = width;
+    frame->height = height;
+    frame->color_reloaded = true;
+}
+
+void FrameMailbox::ReleaseRenderFrame(Frame* frame) {
+    {
+        std::lock_guard lock{swap_chain_lock};
+        frame->submit_time = Frame::Clock::now();
+        present_queue.push_back(frame);
+    }
+    present_cv.notify_one();
+}
+
+Frame* FrameMailbox::GetPresentFrame(std::chrono::milliseconds timeout) {
+    std::unique_lock lock{swap_chain_lock};
+    present_cv.wait_for(lock, timeout,
+                        [this] { return !present_queue.empty() || shutting_down; });
+
+    if (present_queue.empty()) {
+        if (previous_frame != nullptr && !shutting_down) {
+            Core::System::GetInstance().perf_stats.AddDuplicatedFrame();
+        }
+        return previous_frame;
+    }
+
+    // Always present the newest frame, recycling the ones that became stale while waiting
+    while (present_queue.size() > 1) {
+        free_queue.push_back(present_queue.front());
+        present_queue.pop_front();
+        Core::System::GetInstance().perf_stats.AddDroppedFrame();
+    }
+
+    if (previous_frame != nullptr) {
+        free_queue.push_back(previous_frame);
+    }
+    previous_frame = present_queue.front();
+    present_queue.pop_front();
+    return previous_frame;
+}
+
+void FrameMailbox::ReloadPresentFrame(Frame* frame) {
+    // OpenGLState tracks the render context, so only raw GL calls are made here
+    if (frame->present.handle != 0) {
+        glDeleteFramebuffers(1, &frame->present.handle);
+        frame->present.handle = 0;
+    }
+    frame->present.Create();
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, frame->present.handle);
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                           frame->color.handle, 0);
+    frame->color_reloaded = false;
+}
+
+void FrameMailbox::ReleasePresentObjects() {
+    for (auto& frame : swap_chain) {
+        if (frame.present.handle != 0) {
+            glDeleteFramebuffers(1, &frame.present.handle);
+            frame.present.handle = 0;
+        }
+    }
+}
+
+void FrameMailbox::NotifyShutdown() {
+    {
+        std::lock_guard lock{swap_chain_lock};
+        shutting_down = true;
+    }
+    present_cv.notify_all();
+}
+
+} // namespace OpenGL
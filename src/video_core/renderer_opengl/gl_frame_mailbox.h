@@ -0,0 +1,99 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <glad/glad.h>
+#include "common/common_types.h"
+#include "core/perf_stats.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+
+namespace OpenGL {
+
+/// An offscreen frame, rendered to by the emulation side and displayed by the presentation thread
+struct Frame {
+    using Clock = Core::PerfStats::Clock;
+
+    u32 width{};
+    u32 height{};
+
+    /// Color buffer of the frame, shared between the render and the presentation contexts
+    OGLTexture color;
+    /// Framebuffer object in the render context; framebuffer objects can't be shared
+    OGLFramebuffer render;
+    /// Framebuffer object in the presentation context
+    OGLFramebuffer present;
+
+    /// Signaled once the render context has finished drawing to the frame
+    GLsync render_fence{};
+    /// Signaled once the presentation context has finished reading from the frame
+    GLsync present_fence{};
+
+    /// Set when the color buffer was reallocated and the presentation framebuffer has to be
+    /// re-attached
+    bool color_reloaded = false;
+
+    /// Walltime at which the frame was handed off for presentation
+    Clock::time_point submit_time;
+};
+
+/**
+ * Triple-buffered mailbox passing offscreen frames from the thread that renders the emulated
+ * screens to the presentation thread. Handing a frame off never blocks the render side: if the
+ * presentation thread falls behind, the oldest frame waiting for presentation is recycled and
+ * counted as dropped. The presentation side always picks the newest completed frame.
+ */
+class FrameMailbox {
+public:
+    static constexpr std::size_t SWAP_CHAIN_SIZE = 3;
+
+    FrameMailbox();
+    ~FrameMailbox();
+
+    /// Gets a frame to render into. Called from the render thread.
+    Frame* GetRenderFrame();
+
+    /// (Re)allocates the color buffer of the frame. Called from the render thread.
+    void ReloadRenderFrame(Frame* frame, u32 width, u32 height);
+
+    /// Queues a rendered frame for presentation. Called from the render thread.
+    void ReleaseRenderFrame(Frame* frame);
+
+    /**
+     * Waits for a frame to present. Called from the presentation thread.
+     * @param timeout Maximum amount of time to wait for a new frame
+     * @returns The newest rendered frame, the previously presented frame if none was rendered in
+     * time, or nullptr if nothing has been rendered yet
+     */
+    Frame* GetPresentFrame(std::chrono::milliseconds timeout);
+
+    /// Re-attaches the color buffer to the presentation framebuffer. Called from the presentation
+    /// thread.
+    void ReloadPresentFrame(Frame* frame);
+
+    /// Releases the objects owned by the presentation context. Called from the presentation
+    /// thread before its context is destroyed.
+    void ReleasePresentObjects();
+
+    /// Wakes up the presentation thread if it is waiting for a frame
+    void NotifyShutdown();
+
+private:
+    std::array<Frame, SWAP_CHAIN_SIZE> swap_chain{};
+    std::deque<Frame*> free_queue;
+    std::deque<Frame*> present_queue;
+    /// Frame currently owned by the presentation thread
+    Frame* previous_frame = nullptr;
+    bool shutting_down = false;
+
+    std::mutex swap_chain_lock;
+    std::condition_variable present_cv;
+};
+
+} // namespace OpenGL
@@ -6,7 +6,11 @@
 #include <memory>
 #include <string>
 #include <tuple>
+#include <type_traits>
 #include <utility>
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
 #include <glad/glad.h>
 #include "common/alignment.h"
 #include "common/assert.h"
@@ -231,12 +235,14 @@ static bool AreQuaternionsOpposite(Common::Vec4<Pica::float24> qa, Common::Vec4<
     return (Common::Dot(a, b) < 0.f);
 }
 
-void RasterizerOpenGL::AddTriangle(const Pica::Shader::OutputVertex& v0,
-                                   const Pica::Shader::OutputVertex& v1,
-                                   const Pica::Shader::OutputVertex& v2) {
-    vertex_batch.emplace_back(v0, false);
-    vertex_batch.emplace_back(v1, AreQuaternionsOpposite(v0.quat, v1.quat));
-    vertex_batch.emplace_back(v2, AreQuaternionsOpposite(v0.quat, v2.quat));
+void RasterizerOpenGL::AddTriangles(const Pica::Shader::OutputVertex* vertices,
+                                    std::size_t num_triangles) {
+    for (std::size_t i = 0; i < num_triangles; ++i, vertices += 3) {
+        const auto& v0 = vertices[0];
+        vertex_batch.emplace_back(v0, false);
+        vertex_batch.emplace_back(vertices[1], AreQuaternionsOpposite(v0.quat, vertices[1].quat));
+        vertex_batch.emplace_back(vertices[2], AreQuaternionsOpposite(v0.quat, vertices[2].quat));
+    }
 }
 
 static constexpr std::array<GLenum, 4> vs_attrib_types{
@@ -252,6 +258,68 @@ struct VertexArrayInfo {
     u32 vs_input_size;
 };
 
+/// Returns the smallest and the largest index of an 8-bit index buffer
+static std::pair<u32, u32> GetIndexRange(const u8* indices, std::size_t count) {
+    u8 index_min = 0xFF;
+    u8 index_max = 0;
+    std::size_t i = 0;
+#ifdef ARCHITECTURE_x86_64
+    if (count >= 16) {
+        __m128i min_vec = _mm_set1_epi8(static_cast<char>(0xFF));
+        __m128i max_vec = _mm_setzero_si128();
+        for (; i + 16 <= count; i += 16) {
+            const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(indices + i));
+            min_vec = _mm_min_epu8(min_vec, data);
+            max_vec = _mm_max_epu8(max_vec, data);
+        }
+        alignas(16) std::array<u8, 16> min_lanes;
+        alignas(16) std::array<u8, 16> max_lanes;
+        _mm_store_si128(reinterpret_cast<__m128i*>(min_lanes.data()), min_vec);
+        _mm_store_si128(reinterpret_cast<__m128i*>(max_lanes.data()), max_vec);
+        index_min = *std::min_element(min_lanes.begin(), min_lanes.end());
+        index_max = *std::max_element(max_lanes.begin(), max_lanes.end());
+    }
+#endif
+    for (; i < count; ++i) {
+        index_min = std::min(index_min, indices[i]);
+        index_max = std::max(index_max, indices[i]);
+    }
+    return {index_min, index_max};
+}
+
+/// Returns the smallest and the largest index of a 16-bit index buffer
+static std::pair<u32, u32> GetIndexRange(const u16* indices, std::size_t count) {
+    u16 index_min = 0xFFFF;
+    u16 index_max = 0;
+    std::size_t i = 0;
+#ifdef ARCHITECTURE_x86_64
+    if (count >= 8) {
+        // SSE2 only has signed 16-bit min/max, flipping the sign bit maps the unsigned order onto
+        // the signed one
+        const __m128i bias = _mm_set1_epi16(static_cast<short>(0x8000));
+        __m128i min_vec = _mm_set1_epi16(0x7FFF);
+        __m128i max_vec = _mm_set1_epi16(static_cast<short>(0x8000));
+        for (; i + 8 <= count; i += 8) {
+            const __m128i data = _mm_xor_si128(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(indices + i)), bias);
+            min_vec = _mm_min_epi16(min_vec, data);
+            max_vec = _mm_max_epi16(max_vec, data);
+        }
+        alignas(16) std::array<u16, 8> min_lanes;
+        alignas(16) std::array<u16, 8> max_lanes;
+        _mm_store_si128(reinterpret_cast<__m128i*>(min_lanes.data()), _mm_xor_si128(min_vec, bias));
+        _mm_store_si128(reinterpret_cast<__m128i*>(max_lanes.data()), _mm_xor_si128(max_vec, bias));
+        index_min = *std::min_element(min_lanes.begin(), min_lanes.end());
+        index_max = *std::max_element(max_lanes.begin(), max_lanes.end());
+    }
+#endif
+    for (; i < count; ++i) {
+        index_min = std::min(index_min, indices[i]);
+        index_max = std::max(index_max, indices[i]);
+    }
+    return {index_min, index_max};
+}
+
 RasterizerOpenGL::VertexArrayInfo RasterizerOpenGL::AnalyzeVertexArray(bool is_indexed) {
     const auto& regs = Pica::g_state.regs;
     const auto& vertex_attributes = regs.pipeline.vertex_attributes;
@@ -265,15 +333,11 @@ RasterizerOpenGL::VertexArrayInfo RasterizerOpenGL::AnalyzeVertexArray(bool is_i
         const u16* index_address_16 = reinterpret_cast<const u16*>(index_address_8);
         bool index_u16 = index_info.format != 0;
 
-        vertex_min = 0xFFFF;
-        vertex_max = 0;
         std::size_t size = regs.pipeline.num_vertices * (index_u16 ? 2 : 1);
         res_cache.FlushRegion(address, size, nullptr);
-        for (u32 index = 0; index < regs.pipeline.num_vertices; ++index) {
-            u32 vertex = index_u16 ? index_address_16[index] : index_address_8[index];
-            vertex_min = std::min(vertex_min, vertex);
-            vertex_max = std::max(vertex_max, vertex);
-        }
+        std::tie(vertex_min, vertex_max) =
+            index_u16 ? GetIndexRange(index_address_16, regs.pipeline.num_vertices)
+                      : GetIndexRange(index_address_8, regs.pipeline.num_vertices);
     } else {
         vertex_min = regs.pipeline.vertex_offset;
         vertex_max = regs.pipeline.vertex_offset + regs.pipeline.num_vertices - 1;
@@ -290,8 +354,8 @@ RasterizerOpenGL::VertexArrayInfo RasterizerOpenGL::AnalyzeVertexArray(bool is_i
     return {vertex_min, vertex_max, vs_input_size};
 }
 
-void RasterizerOpenGL::SetupVertexArray(u8* array_ptr, GLintptr buffer_offset,
-                                        GLuint vs_input_index_min, GLuint vs_input_index_max) {
+u32 RasterizerOpenGL::SetupVertexArray(u8* array_ptr, GLintptr buffer_offset,
+                                       GLuint vs_input_index_min, GLuint vs_input_index_max) {
     MICROPROFILE_SCOPE(OpenGL_VAO);
     const auto& regs = Pica::g_state.regs;
     const auto& vertex_attributes = regs.pipeline.vertex_attributes;
@@ -302,12 +366,49 @@ void RasterizerOpenGL::SetupVertexArray(u8* array_ptr, GLintptr buffer_offset,
     state.Apply();
 
     std::array<bool, 16> enable_attributes{};
+    u32 streamed_size = 0;
+    const u32 vertex_num = vs_input_index_max - vs_input_index_min + 1;
+
+    std::array<u32, VertexArrayCache::MAX_DRAW_ARRAYS> array_sizes{};
+    static_assert(std::extent_v<decltype(vertex_attributes.attribute_loaders)> ==
+                  VertexArrayCache::MAX_DRAW_ARRAYS);
+    for (std::size_t i = 0; i < array_sizes.size(); ++i) {
+        const auto& loader = vertex_attributes.attribute_loaders[i];
+        if (loader.component_count != 0) {
+            array_sizes[i] = loader.byte_count * vertex_num;
+        }
+    }
+    vertex_array_cache.BeginDraw(state, array_sizes);
 
     for (const auto& loader : vertex_attributes.attribute_loaders) {
         if (loader.component_count == 0 || loader.byte_count == 0) {
             continue;
         }
 
+        PAddr data_addr =
+            base_address + loader.data_offset + (vs_input_index_min * loader.byte_count);
+
+        u32 data_size = loader.byte_count * vertex_num;
+
+        res_cache.FlushRegion(data_addr, data_size, nullptr);
+        const u8* data = VideoCore::g_memory->GetPhysicalPointer(data_addr);
+
+        // Static meshes are drawn from the vertex array cache, everything else is streamed. The
+        // cache binds its own buffer, which the attribute pointers below pick up.
+        GLintptr data_offset;
+        if (const auto cached_offset = vertex_array_cache.Get(state, data_addr, data_size, data)) {
+            data_offset = *cached_offset;
+        } else {
+            state.draw.vertex_buffer = vertex_buffer.GetHandle();
+            state.Apply();
+            std::memcpy(array_ptr, data, data_size);
+            data_offset = buffer_offset;
+
+            array_ptr += data_size;
+            buffer_offset += data_size;
+            streamed_size += data_size;
+        }
+
         u32 offset = 0;
         for (u32 comp = 0; comp < loader.component_count && comp < 12; ++comp) {
             u32 attribute_index = loader.GetComponent(comp);
@@ -322,7 +423,7 @@ void RasterizerOpenGL::SetupVertexArray(u8* array_ptr, GLintptr buffer_offset,
                         vertex_attributes.GetFormat(attribute_index))];
                     GLsizei stride = loader.byte_count;
                     glVertexAttribPointer(input_reg, size, type, GL_FALSE, stride,
-                                          reinterpret_cast<GLvoid*>(buffer_offset + offset));
+                                          reinterpret_cast<GLvoid*>(data_offset + offset));
                     enable_attributes[input_reg] = true;
 
                     offset += vertex_attributes.GetStride(attribute_index);
@@ -334,19 +435,8 @@ void RasterizerOpenGL::SetupVertexArray(u8* array_ptr, GLintptr buffer_offset,
                 offset += (attribute_index - 11) * 4;
             }
         }
-
-        PAddr data_addr =
-            base_address + loader.data_offset + (vs_input_index_min * loader.byte_count);
-
-        u32 vertex_num = vs_input_index_max - vs_input_index_min + 1;
-        u32 data_size = loader.byte_count * vertex_num;
-
-        res_cache.FlushRegion(data_addr, data_size, nullptr);
-        std::memcpy(array_ptr, VideoCore::g_memory->GetPhysicalPointer(data_addr), data_size);
-
-        array_ptr += data_size;
-        buffer_offset += data_size;
     }
+    vertex_array_cache.EndDraw();
 
     for (std::size_t i = 0; i < enable_attributes.size(); ++i) {
         if (enable_attributes[i] != hw_vao_enabled_attributes[i]) {
@@ -367,6 +457,8 @@ void RasterizerOpenGL::SetupVertexArray(u8* array_ptr, GLintptr buffer_offset,
             }
         }
     }
+
+    return streamed_size;
 }
 
 bool RasterizerOpenGL::SetupVertexShader() {
@@ -458,8 +550,11 @@ bool RasterizerOpenGL::AccelerateDrawBatchInternal(bool is_indexed, bool use_gs)
     u8* buffer_ptr;
     GLintptr buffer_offset;
     std::tie(buffer_ptr, buffer_offset, std::ignore) = vertex_buffer.Map(vs_input_size, 4);
-    SetupVertexArray(buffer_ptr, buffer_offset, vs_input_index_min, vs_input_index_max);
-    vertex_buffer.Unmap(vs_input_size);
+    const u32 streamed_size =
+        SetupVertexArray(buffer_ptr, buffer_offset, vs_input_index_min, vs_input_index_max);
+    state.draw.vertex_buffer = vertex_buffer.GetHandle();
+    state.Apply();
+    vertex_buffer.Unmap(streamed_size);
 
     shader_program_manager->ApplyTo(state);
     state.Apply();
@@ -1362,12 +1457,14 @@ void RasterizerOpenGL::FlushRegion(PAddr addr, u32 size) {
 void RasterizerOpenGL::InvalidateRegion(PAddr addr, u32 size) {
     MICROPROFILE_SCOPE(OpenGL_CacheManagement);
     res_cache.InvalidateRegion(addr, size, nullptr);
+    vertex_array_cache.InvalidateRegion(addr, size);
 }
 
 void RasterizerOpenGL::FlushAndInvalidateRegion(PAddr addr, u32 size) {
     MICROPROFILE_SCOPE(OpenGL_CacheManagement);
     res_cache.FlushRegion(addr, size);
     res_cache.InvalidateRegion(addr, size, nullptr);
+    vertex_array_cache.InvalidateRegion(addr, size);
 }
 
 bool RasterizerOpenGL::AccelerateDisplayTransfer(const GPU::Regs::DisplayTransferConfig& config) {
@@ -26,6 +26,7 @@
 #include "video_core/renderer_opengl/gl_shader_manager.h"
 #include "video_core/renderer_opengl/gl_state.h"
 #include "video_core/renderer_opengl/gl_stream_buffer.h"
+#include "video_core/renderer_opengl/gl_vertex_array_cache.h"
 #include "video_core/renderer_opengl/pica_to_gl.h"
 #include "video_core/shader/shader.h"
 
@@ -42,8 +43,8 @@ public:
     explicit RasterizerOpenGL(Frontend::EmuWindow& renderer);
     ~RasterizerOpenGL() override;
 
-    void AddTriangle(const Pica::Shader::OutputVertex& v0, const Pica::Shader::OutputVertex& v1,
-                     const Pica::Shader::OutputVertex& v2) override;
+    void AddTriangles(const Pica::Shader::OutputVertex* vertices,
+                      std::size_t num_triangles) override;
     void DrawTriangles() override;
     void NotifyPicaRegisterChanged(u32 id) override;
     void FlushAll() override;
@@ -248,9 +249,13 @@ private:
     /// Retrieve the range and the size of the input vertex
     VertexArrayInfo AnalyzeVertexArray(bool is_indexed);
 
-    /// Setup vertex array for AccelerateDrawBatch
-    void SetupVertexArray(u8* array_ptr, GLintptr buffer_offset, GLuint vs_input_index_min,
-                          GLuint vs_input_index_max);
+    /**
+     * Setup vertex array for AccelerateDrawBatch
+     * @returns The number of bytes written to the stream buffer. Arrays found in the vertex
+     * array cache aren't streamed.
+     */
+    u32 SetupVertexArray(u8* array_ptr, GLintptr buffer_offset, GLuint vs_input_index_min,
+                         GLuint vs_input_index_max);
 
     /// Setup vertex shader for AccelerateDrawBatch
     bool SetupVertexShader();
@@ -300,6 +305,7 @@ private:
     OGLStreamBuffer uniform_buffer;
     OGLStreamBuffer index_buffer;
     OGLStreamBuffer texture_buffer;
+    VertexArrayCache vertex_array_cache;
     OGLFramebuffer framebuffer;
     GLint uniform_buffer_alignment;
     std::size_t uniform_size_aligned_vs;
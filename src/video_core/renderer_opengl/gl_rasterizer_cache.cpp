@@ -1492,8 +1492,20 @@ const CachedTextureCube& RasterizerCacheOpenGL::GetTextureCube(const TextureCube
         {cube.nz, config.nz, GL_TEXTURE_CUBE_MAP_NEGATIVE_Z},
     }};
 
-    for (const Face& face : faces) {
+    for (std::size_t i = 0; i < faces.size(); ++i) {
+        const Face& face = faces[i];
         if (!face.watcher || !face.watcher->Get()) {
+            // Faces sourced from the same address share the watcher of the first one, so the
+            // surface is looked up and watched only once
+            const auto same_face =
+                std::find_if(faces.begin(), faces.begin() + i, [&](const Face& other) {
+                    return other.address == face.address && other.watcher && other.watcher->Get();
+                });
+            if (same_face != faces.begin() + i) {
+                face.watcher = same_face->watcher;
+                continue;
+            }
+
             Pica::Texture::TextureInfo info;
             info.physical_address = face.address;
             info.height = info.width = config.width;
@@ -1526,6 +1538,18 @@ const CachedTextureCube& RasterizerCacheOpenGL::GetTextureCube(const TextureCube
             cube.res_scale * config.width);
     }
 
+    // Only the faces whose source surface changed since they were last copied are re-blitted. The
+    // dirty state is gathered before any face gets validated, as faces may share a watcher.
+    std::array<bool, 6> dirty_faces{};
+    bool any_dirty = false;
+    for (std::size_t i = 0; i < faces.size(); ++i) {
+        dirty_faces[i] = faces[i].watcher && !faces[i].watcher->IsValid();
+        any_dirty |= dirty_faces[i];
+    }
+    if (!any_dirty) {
+        return cube;
+    }
+
     u32 scaled_size = cube.res_scale * config.width;
 
     OpenGLState prev_state = OpenGLState::GetCurState();
@@ -1536,8 +1560,9 @@ const CachedTextureCube& RasterizerCacheOpenGL::GetTextureCube(const TextureCube
     state.draw.draw_framebuffer = draw_framebuffer.handle;
     state.ResetTexture(cube.texture.handle);
 
-    for (const Face& face : faces) {
-        if (face.watcher && !face.watcher->IsValid()) {
+    for (std::size_t i = 0; i < faces.size(); ++i) {
+        const Face& face = faces[i];
+        if (dirty_faces[i]) {
             auto surface = face.watcher->Get();
             if (!surface->invalid_regions.empty()) {
                 ValidateSurface(surface, surface->addr, surface->size);
@@ -1557,7 +1582,12 @@ const CachedTextureCube& RasterizerCacheOpenGL::GetTextureCube(const TextureCube
             auto src_rect = surface->GetScaledRect();
             glBlitFramebuffer(src_rect.left, src_rect.bottom, src_rect.right, src_rect.top, 0, 0,
                               scaled_size, scaled_size, GL_COLOR_BUFFER_BIT, GL_LINEAR);
-            face.watcher->Validate();
+        }
+    }
+
+    for (std::size_t i = 0; i < faces.size(); ++i) {
+        if (dirty_faces[i]) {
+            faces[i].watcher->Validate();
         }
     }
 
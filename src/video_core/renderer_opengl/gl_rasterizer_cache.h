@@ -384,6 +384,9 @@ struct CachedSurface : SurfaceParams, std::enable_shared_from_this<CachedSurface
                            GLuint draw_fb_handle);
 
     std::shared_ptr<SurfaceWatcher> CreateWatcher() {
+        // Drop the watchers whose users are gone, they would otherwise pile up as texture cubes
+        // and mipmaps get rebuilt
+        watchers.remove_if([](const auto& watcher) { return watcher.expired(); });
         auto watcher = std::make_shared<SurfaceWatcher>(weak_from_this());
         watchers.push_front(watcher);
         return watcher;
@@ -0,0 +1,126 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "common/alignment.h"
+#include "common/assert.h"
+#include "common/hash.h"
+#include "common/microprofile.h"
+#include "video_core/renderer_opengl/gl_state.h"
+#include "video_core/renderer_opengl/gl_vertex_array_cache.h"
+
+MICROPROFILE_DEFINE(OpenGL_VertexArrayUpload, "OpenGL", "Vertex Array Cache Upload",
+                    MP_RGB(255, 160, 64));
+
+namespace OpenGL {
+
+VertexArrayCache::VertexArrayCache() {
+    buffer.Create();
+
+    OpenGLState state = OpenGLState::GetCurState();
+    state.draw.vertex_buffer = buffer.handle;
+    state.Apply();
+    glBufferData(GL_ARRAY_BUFFER, BUFFER_SIZE, nullptr, GL_STATIC_DRAW);
+}
+
+VertexArrayCache::~VertexArrayCache() = default;
+
+void VertexArrayCache::BeginDraw(OpenGLState& state,
+                                 const std::array<u32, MAX_DRAW_ARRAYS>& array_sizes) {
+    static_assert(MAX_DRAW_ARRAYS * MAX_ARRAY_SIZE <= BUFFER_SIZE,
+                  "Every array of a draw must fit in the cleared buffer");
+    ASSERT_MSG(!in_draw, "Vertex array cache draw already started");
+
+    // Upper bound of what the draw can add to the cache, as any of its arrays might be uploaded
+    std::size_t required_space = 0;
+    for (const u32 size : array_sizes) {
+        if (size != 0 && size <= MAX_ARRAY_SIZE) {
+            required_space += Common::AlignUp<std::size_t>(size, 4);
+        }
+    }
+
+    if (entries.size() + MAX_DRAW_ARRAYS > MAX_ENTRIES ||
+        buffer_pos + required_space > static_cast<std::size_t>(BUFFER_SIZE)) {
+        Clear(state);
+    }
+
+    in_draw = true;
+}
+
+void VertexArrayCache::EndDraw() {
+    in_draw = false;
+}
+
+std::optional<GLintptr> VertexArrayCache::Get(OpenGLState& state, PAddr addr, u32 size,
+                                              const u8* data) {
+    if (size == 0 || size > MAX_ARRAY_SIZE) {
+        return std::nullopt;
+    }
+
+    ASSERT_MSG(in_draw, "Vertex array cache used outside of a draw");
+
+    const u64 hash = Common::ComputeHash64(data, size);
+
+    auto [iter, inserted] = entries.try_emplace({addr, size});
+    Entry* entry = &iter->second;
+    if (inserted || entry->hash != hash) {
+        // First time the array is drawn with these contents, stream it and keep the hash to see
+        // whether it comes back unchanged
+        entry->hash = hash;
+        entry->uploaded = false;
+        max_entry_size = std::max(max_entry_size, size);
+        return std::nullopt;
+    }
+
+    state.draw.vertex_buffer = buffer.handle;
+    state.Apply();
+
+    if (!entry->uploaded) {
+        MICROPROFILE_SCOPE(OpenGL_VertexArrayUpload);
+        // BeginDraw made room for every array of the draw
+        ASSERT(buffer_pos + size <= static_cast<std::size_t>(BUFFER_SIZE));
+
+        glBufferSubData(GL_ARRAY_BUFFER, buffer_pos, size, data);
+
+        entry->offset = buffer_pos;
+        entry->uploaded = true;
+        buffer_pos = Common::AlignUp<std::size_t>(buffer_pos + size, 4);
+    }
+
+    return entry->offset;
+}
+
+void VertexArrayCache::InvalidateRegion(PAddr addr, u32 size) {
+    const PAddr end = addr + size;
+
+    // Entries are sorted by their start address, so only those starting less than the size of
+    // the largest entry before the region can overlap it
+    const PAddr search_start = addr > max_entry_size ? addr - max_entry_size : 0;
+    auto iter = entries.lower_bound({search_start, 0});
+    while (iter != entries.end() && iter->first.first < end) {
+        const auto& [entry_addr, entry_size] = iter->first;
+        if (entry_addr + entry_size > addr) {
+            iter = entries.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+
+void VertexArrayCache::Clear(OpenGLState& state) {
+    // Orphaning or rewinding the buffer would pull it from under the attribute pointers of the
+    // arrays of the current draw that are already set up
+    ASSERT_MSG(!in_draw, "Vertex array cache cleared in the middle of a draw");
+
+    // Orphan the storage so that uploads don't have to wait for draws still reading from it
+    state.draw.vertex_buffer = buffer.handle;
+    state.Apply();
+    glBufferData(GL_ARRAY_BUFFER, BUFFER_SIZE, nullptr, GL_STATIC_DRAW);
+
+    entries.clear();
+    buffer_pos = 0;
+    max_entry_size = 0;
+}
+
+} // namespace OpenGL
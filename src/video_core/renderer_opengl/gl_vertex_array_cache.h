@@ -0,0 +1,94 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <map>
+#include <optional>
+#include <utility>
+#include <glad/glad.h>
+#include "common/common_types.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+
+namespace OpenGL {
+
+class OpenGLState;
+
+/**
+ * Keeps vertex arrays that are drawn repeatedly in a persistent GL buffer, so that accelerated
+ * draws of static meshes don't stream the same data again every time.
+ *
+ * Arrays are keyed by their guest address range and validated with a hash of their contents,
+ * because CPU writes to vertex data aren't reported to the rasterizer. An array is only uploaded
+ * once it has been drawn twice with the same contents, which keeps geometry that is rewritten
+ * every frame in the stream buffer.
+ */
+class VertexArrayCache : NonCopyable {
+public:
+    /// Maximum number of arrays of a draw, one per attribute loader
+    static constexpr std::size_t MAX_DRAW_ARRAYS = 12;
+
+    VertexArrayCache();
+    ~VertexArrayCache();
+
+    /**
+     * Makes room for the arrays of a draw. The cache buffer is only ever cleared here, because
+     * the attribute pointers set up for earlier arrays of a draw point into it.
+     * @param state OpenGL state used to bind the cache buffer
+     * @param array_sizes Sizes in bytes of the arrays the draw will look up
+     */
+    void BeginDraw(OpenGLState& state, const std::array<u32, MAX_DRAW_ARRAYS>& array_sizes);
+
+    /// Ends the draw started with BeginDraw
+    void EndDraw();
+
+    /**
+     * Looks up a vertex array, uploading it to the cache buffer if it has been seen before with
+     * the same contents. The cache buffer is bound to GL_ARRAY_BUFFER if the array is cached.
+     * Must be called between BeginDraw and EndDraw.
+     * @param state OpenGL state used to bind the cache buffer
+     * @param addr Guest physical address of the array
+     * @param size Size of the array in bytes
+     * @param data Host pointer to the contents of the array
+     * @returns The offset of the array in the cache buffer, or std::nullopt if it has to be
+     * streamed
+     */
+    std::optional<GLintptr> Get(OpenGLState& state, PAddr addr, u32 size, const u8* data);
+
+    /// Drops the arrays that overlap the given guest region
+    void InvalidateRegion(PAddr addr, u32 size);
+
+    GLuint GetHandle() const {
+        return buffer.handle;
+    }
+
+private:
+    struct Entry {
+        u64 hash = 0;
+        GLintptr offset = 0;
+        bool uploaded = false;
+    };
+
+    /// Orphans the cache buffer and forgets every entry
+    void Clear(OpenGLState& state);
+
+    static constexpr GLsizeiptr BUFFER_SIZE = 16 * 1024 * 1024;
+    /// Arrays larger than this are always streamed
+    static constexpr u32 MAX_ARRAY_SIZE = 1 * 1024 * 1024;
+    /// Number of tracked arrays after which the cache is reset
+    static constexpr std::size_t MAX_ENTRIES = 4096;
+
+    OGLBuffer buffer;
+    GLintptr buffer_pos = 0;
+
+    /// Tracked arrays, keyed by guest address and size
+    std::map<std::pair<PAddr, u32>, Entry> entries;
+    /// Size of the largest tracked array, bounds the search for overlapping entries
+    u32 max_entry_size = 0;
+    /// Whether a draw is setting up attribute pointers into the cache buffer
+    bool in_draw = false;
+};
+
+} // namespace OpenGL
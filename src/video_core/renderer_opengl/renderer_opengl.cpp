@@ -5,13 +5,17 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdlib>
+#include <cstring>
 #include <memory>
 #include <glad/glad.h>
 #include "common/assert.h"
 #include "common/bit_field.h"
 #include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "common/thread.h"
 #include "core/core.h"
 #include "core/core_timing.h"
+#include "core/dumping/backend.h"
 #include "core/frontend/emu_window.h"
 #include "core/hw/gpu.h"
 #include "core/hw/hw.h"
@@ -21,6 +25,7 @@
 #include "core/tracer/recorder.h"
 #include "video_core/debug_utils/debug_utils.h"
 #include "video_core/rasterizer_interface.h"
+#include "video_core/renderer_opengl/gl_frame_mailbox.h"
 #include "video_core/renderer_opengl/gl_vars.h"
 #include "video_core/renderer_opengl/renderer_opengl.h"
 #include "video_core/video_core.h"
@@ -94,7 +99,20 @@ static std::array<GLfloat, 3 * 2> MakeOrthographicMatrix(const float width, cons
 }
 
 RendererOpenGL::RendererOpenGL(Frontend::EmuWindow& window) : RendererBase{window} {}
-RendererOpenGL::~RendererOpenGL() = default;
+
+RendererOpenGL::~RendererOpenGL() {
+    if (present_thread.joinable()) {
+        stop_presenting = true;
+        frame_mailbox->NotifyShutdown();
+        present_thread.join();
+    }
+
+    // The dumper is stopped after the renderer is destroyed, hand it the frames still in flight
+    auto& video_dumper = Core::System::GetInstance().VideoDumper();
+    if (video_dumper.IsDumping()) {
+        SubmitPendingDumpFrames(video_dumper);
+    }
+}
 
 /// Swap buffers (render frame)
 void RendererOpenGL::SwapBuffers() {
@@ -169,17 +187,41 @@ void RendererOpenGL::SwapBuffers() {
         VideoCore::g_renderer_screenshot_requested = false;
     }
 
-    DrawScreens(render_window.GetFramebufferLayout());
+    auto& video_dumper = Core::System::GetInstance().VideoDumper();
+    if (video_dumper.IsDumping()) {
+        DumpFrame(video_dumper);
+    } else {
+        // Dumping was stopped elsewhere, the dumper doesn't accept the frames in flight anymore
+        dump_pbos_pending = 0;
+    }
 
-    Core::System::GetInstance().perf_stats.EndSystemFrame();
+    if (frame_mailbox) {
+        // The window is swapped by the presentation thread
+        DrawScreensToMailbox(render_window.GetFramebufferLayout());
+    } else {
+        DrawScreens(render_window.GetFramebufferLayout());
+    }
+    m_current_frame++;
 
-    // Swap buffers
-    render_window.PollEvents();
-    render_window.SwapBuffers();
+    if (VideoCore::g_gpu_thread) {
+        // Frame pacing and window events are handled by the emulation thread when rendering on
+        // the GPU thread
+        if (!frame_mailbox) {
+            render_window.SwapBuffers();
+        }
+    } else {
+        Core::System::GetInstance().perf_stats.EndSystemFrame();
 
-    Core::System::GetInstance().frame_limiter.DoFrameLimiting(
-        Core::System::GetInstance().CoreTiming().GetGlobalTimeUs());
-    Core::System::GetInstance().perf_stats.BeginSystemFrame();
+        // Swap buffers
+        render_window.PollEvents();
+        if (!frame_mailbox) {
+            render_window.SwapBuffers();
+        }
+
+        Core::System::GetInstance().frame_limiter.DoFrameLimiting(
+            Core::System::GetInstance().CoreTiming().GetGlobalTimeUs());
+        Core::System::GetInstance().perf_stats.BeginSystemFrame();
+    }
 
     prev_state.Apply();
     RefreshRasterizerSetting();
@@ -474,8 +516,188 @@ void RendererOpenGL::DrawScreens(const Layout::FramebufferLayout& layout) {
                                     (float)bottom_screen.GetHeight());
         }
     }
+}
 
-    m_current_frame++;
+/**
+ * Draws the emulated screens to an offscreen frame and hands it off to the presentation thread.
+ */
+void RendererOpenGL::DrawScreensToMailbox(const Layout::FramebufferLayout& layout) {
+    Frame* frame = frame_mailbox->GetRenderFrame();
+
+    // Make sure the presentation thread is done reading from the frame before overwriting it
+    if (frame->present_fence) {
+        glWaitSync(frame->present_fence, 0, GL_TIMEOUT_IGNORED);
+        glDeleteSync(frame->present_fence);
+        frame->present_fence = nullptr;
+    }
+    // Fence of a frame that was dropped before the presentation thread picked it up
+    if (frame->render_fence) {
+        glDeleteSync(frame->render_fence);
+        frame->render_fence = nullptr;
+    }
+
+    if (frame->width != layout.width || frame->height != layout.height) {
+        frame_mailbox->ReloadRenderFrame(frame, layout.width, layout.height);
+    }
+
+    state.draw.draw_framebuffer = frame->render.handle;
+    state.Apply();
+
+    DrawScreens(layout);
+
+    state.draw.draw_framebuffer = 0;
+    state.Apply();
+
+    frame->render_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    // Submit the commands so that the presentation context can wait on the fence
+    glFlush();
+    frame_mailbox->ReleaseRenderFrame(frame);
+}
+
+/**
+ * Draws the emulated screens with the dumper's layout and starts reading them back into a pixel
+ * buffer. Once every buffer of the ring holds a frame, the oldest one, whose transfer has had
+ * DUMP_PBO_COUNT - 1 frames to complete, is copied into the dumper's frame queue.
+ */
+void RendererOpenGL::DumpFrame(VideoDumper::Backend& dumper) {
+    const Layout::FramebufferLayout layout = dumper.GetLayout();
+    const GLsizeiptr frame_size = static_cast<GLsizeiptr>(layout.width) * layout.height * 4;
+
+    if (dump_width != layout.width || dump_height != layout.height) {
+        // The buffers are about to be recreated, the frames they still hold go out first
+        SubmitPendingDumpFrames(dumper);
+
+        dump_texture.Release();
+        dump_texture.Create();
+        state.texture_units[0].texture_2d = dump_texture.handle;
+        state.Apply();
+        glActiveTexture(GL_TEXTURE0);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, layout.width, layout.height, 0, GL_RGBA,
+                     GL_UNSIGNED_BYTE, nullptr);
+        state.texture_units[0].texture_2d = 0;
+
+        dump_framebuffer.Release();
+        dump_framebuffer.Create();
+        state.draw.read_framebuffer = state.draw.draw_framebuffer = dump_framebuffer.handle;
+        state.Apply();
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                               dump_texture.handle, 0);
+
+        for (auto& pbo : dump_pbos) {
+            pbo.Release();
+            pbo.Create();
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo.handle);
+            glBufferData(GL_PIXEL_PACK_BUFFER, frame_size, nullptr, GL_STREAM_READ);
+        }
+        dump_pbo_index = 0;
+        dump_pbos_pending = 0;
+
+        dump_width = layout.width;
+        dump_height = layout.height;
+    } else {
+        state.draw.read_framebuffer = state.draw.draw_framebuffer = dump_framebuffer.handle;
+        state.Apply();
+    }
+
+    DrawScreens(layout);
+
+    // Reading into a pixel buffer returns without waiting for the GPU to finish drawing
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, dump_pbos[dump_pbo_index].handle);
+    glReadPixels(0, 0, layout.width, layout.height, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, nullptr);
+    dump_pbo_index = (dump_pbo_index + 1) % dump_pbos.size();
+    ++dump_pbos_pending;
+
+    state.draw.read_framebuffer = state.draw.draw_framebuffer = 0;
+    state.Apply();
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if (dump_pbos_pending == dump_pbos.size()) {
+        SubmitOldestDumpFrame(dumper);
+    }
+}
+
+/// Copies the oldest frame read back for dumping into the dumper's frame queue
+void RendererOpenGL::SubmitOldestDumpFrame(VideoDumper::Backend& dumper) {
+    const std::size_t index = (dump_pbo_index + dump_pbos.size() - dump_pbos_pending) %
+                              dump_pbos.size();
+    const GLsizeiptr frame_size = static_cast<GLsizeiptr>(dump_width) * dump_height * 4;
+    --dump_pbos_pending;
+
+    // Blocks while the encoder is behind, returns nullptr if dumping stopped meanwhile
+    VideoDumper::VideoFrame* frame = dumper.AcquireVideoFrame(dump_width, dump_height);
+    if (frame == nullptr) {
+        return;
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, dump_pbos[index].handle);
+    const void* pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, frame_size, GL_MAP_READ_BIT);
+    if (pixels != nullptr) {
+        std::memcpy(frame->data.data(), pixels, frame_size);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    dumper.SubmitVideoFrame(frame);
+}
+
+/// Hands every frame still being read back to the dumper, oldest first
+void RendererOpenGL::SubmitPendingDumpFrames(VideoDumper::Backend& dumper) {
+    while (dump_pbos_pending > 0) {
+        SubmitOldestDumpFrame(dumper);
+    }
+}
+
+/**
+ * Entry point of the presentation thread: blits the newest rendered frame to the window and swaps
+ * its buffers, independently of the emulated frame rate.
+ */
+void RendererOpenGL::PresentLoop() {
+    Common::SetCurrentThreadName("Present");
+    MicroProfileOnThreadCreate("PresentThread");
+
+    present_context->MakeCurrent();
+
+    while (!stop_presenting) {
+        Frame* frame = frame_mailbox->GetPresentFrame(std::chrono::milliseconds{100});
+        if (frame == nullptr || stop_presenting) {
+            continue;
+        }
+
+        const bool is_new_frame = frame->render_fence != nullptr;
+        if (is_new_frame) {
+            glWaitSync(frame->render_fence, 0, GL_TIMEOUT_IGNORED);
+            glDeleteSync(frame->render_fence);
+            frame->render_fence = nullptr;
+        }
+        if (frame->color_reloaded) {
+            frame_mailbox->ReloadPresentFrame(frame);
+        }
+
+        // Frames are rendered at the size of the window layout, so a plain copy is enough
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, frame->present.handle);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        glBlitFramebuffer(0, 0, frame->width, frame->height, 0, 0, frame->width, frame->height,
+                          GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+        if (frame->present_fence) {
+            glDeleteSync(frame->present_fence);
+        }
+        frame->present_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+        present_context->SwapBuffers();
+
+        if (is_new_frame) {
+            Core::System::GetInstance().perf_stats.AddPresentedFrame(Frame::Clock::now() -
+                                                                     frame->submit_time);
+        }
+    }
+
+    frame_mailbox->ReleasePresentObjects();
+    present_context->DoneCurrent();
+
+#if MICROPROFILE_ENABLED
+    MicroProfileOnThreadExit();
+#endif
 }
 
 /// Updates the framerate
@@ -569,6 +791,17 @@ Core::System::ResultStatus RendererOpenGL::Init() {
 
     RefreshRasterizerSetting();
 
+    if (Settings::values.use_present_thread) {
+        present_context = render_window.CreateSharedContext();
+        if (present_context) {
+            frame_mailbox = std::make_unique<FrameMailbox>();
+            present_thread = std::thread(&RendererOpenGL::PresentLoop, this);
+        } else {
+            LOG_WARNING(Render_OpenGL,
+                        "Frontend can't share its context, presenting from the render thread");
+        }
+    }
+
     return Core::System::ResultStatus::Success;
 }
 
@@ -5,6 +5,9 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <memory>
+#include <thread>
 #include <glad/glad.h>
 #include "common/common_types.h"
 #include "common/math_util.h"
@@ -13,12 +16,22 @@
 #include "video_core/renderer_opengl/gl_resource_manager.h"
 #include "video_core/renderer_opengl/gl_state.h"
 
+namespace Frontend {
+class GraphicsContext;
+}
+
 namespace Layout {
 struct FramebufferLayout;
 }
 
+namespace VideoDumper {
+class Backend;
+}
+
 namespace OpenGL {
 
+class FrameMailbox;
+
 /// Structure used for storing information about the textures for each 3DS screen
 struct TextureInfo {
     OGLTexture resource;
@@ -55,6 +68,11 @@ private:
     void ConfigureFramebufferTexture(TextureInfo& texture,
                                      const GPU::Regs::FramebufferConfig& framebuffer);
     void DrawScreens(const Layout::FramebufferLayout& layout);
+    void DrawScreensToMailbox(const Layout::FramebufferLayout& layout);
+    void DumpFrame(VideoDumper::Backend& dumper);
+    void SubmitOldestDumpFrame(VideoDumper::Backend& dumper);
+    void SubmitPendingDumpFrames(VideoDumper::Backend& dumper);
+    void PresentLoop();
     void DrawSingleScreenRotated(const ScreenInfo& screen_info, float x, float y, float w, float h);
     void UpdateFramerate();
 
@@ -72,6 +90,21 @@ private:
     OGLProgram shader;
     OGLFramebuffer screenshot_framebuffer;
 
+    /// Offscreen target the screens are drawn to for video dumping
+    OGLFramebuffer dump_framebuffer;
+    OGLTexture dump_texture;
+    u32 dump_width = 0;
+    u32 dump_height = 0;
+
+    /// Number of frames being read back asynchronously for video dumping
+    static constexpr std::size_t DUMP_PBO_COUNT = 3;
+    /// Ring of pixel buffers the dumped frames are read back into
+    std::array<OGLBuffer, DUMP_PBO_COUNT> dump_pbos;
+    /// Buffer the next frame is read into
+    std::size_t dump_pbo_index = 0;
+    /// Number of buffers holding a frame that hasn't been handed to the dumper yet
+    std::size_t dump_pbos_pending = 0;
+
     /// Display information for top and bottom screens respectively
     std::array<ScreenInfo, 3> screen_infos;
 
@@ -82,6 +115,13 @@ private:
     // Shader attribute input indices
     GLuint attrib_position;
     GLuint attrib_tex_coord;
+
+    /// Context shared with the render window's, owned by the presentation thread
+    std::unique_ptr<Frontend::GraphicsContext> present_context;
+    /// Frames handed off from SwapBuffers to the presentation thread
+    std::unique_ptr<FrameMailbox> frame_mailbox;
+    std::thread present_thread;
+    std::atomic_bool stop_presenting{false};
 };
 
 } // namespace OpenGL
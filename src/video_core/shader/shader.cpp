@@ -100,11 +100,12 @@ void UnitState::WriteOutput(const ShaderRegs& config, AttributeBuffer& output) {
 UnitState::UnitState(GSEmitter* emitter) : emitter_ptr(emitter) {}
 
 GSEmitter::GSEmitter() {
-    handlers = new Handlers;
+    primitives = new std::vector<Primitive>;
+    primitives->reserve(PREALLOCATED_PRIMITIVES);
 }
 
 GSEmitter::~GSEmitter() {
-    delete handlers;
+    delete primitives;
 }
 
 void GSEmitter::Emit(Common::Vec4<float24> (&output_regs)[16]) {
@@ -113,21 +114,12 @@ void GSEmitter::Emit(Common::Vec4<float24> (&output_regs)[16]) {
     CopyRegistersToOutput(output_regs, output_mask, buffer[vertex_id]);
 
     if (prim_emit) {
-        if (winding)
-            handlers->winding_setter();
-        for (std::size_t i = 0; i < buffer.size(); ++i) {
-            handlers->vertex_handler(buffer[i]);
-        }
+        primitives->push_back({buffer, winding});
     }
 }
 
 GSUnitState::GSUnitState() : UnitState(&emitter) {}
 
-void GSUnitState::SetVertexHandler(VertexHandler vertex_handler, WindingSetter winding_setter) {
-    emitter.handlers->vertex_handler = std::move(vertex_handler);
-    emitter.handlers->winding_setter = std::move(winding_setter);
-}
-
 void GSUnitState::ConfigOutput(const ShaderRegs& config) {
     emitter.output_mask = config.output_mask;
 }
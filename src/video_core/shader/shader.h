@@ -6,8 +6,8 @@
 
 #include <array>
 #include <cstddef>
-#include <functional>
 #include <type_traits>
+#include <vector>
 #include <nihstro/shader_bytecode.h>
 #include "common/assert.h"
 #include "common/common_funcs.h"
@@ -31,12 +31,6 @@ struct AttributeBuffer {
     alignas(16) Common::Vec4<float24> attr[16];
 };
 
-/// Handler type for receiving vertex outputs from vertex shader or geometry shader
-using VertexHandler = std::function<void(const AttributeBuffer&)>;
-
-/// Handler type for signaling to invert the vertex order of the next triangle
-using WindingSetter = std::function<void()>;
-
 struct OutputVertex {
     Common::Vec4<float24> pos;
     Common::Vec4<float24> quat;
@@ -72,18 +66,26 @@ static_assert(sizeof(OutputVertex) == 24 * sizeof(float), "OutputVertex has inva
  * This structure contains state information for primitive emitting in geometry shader.
  */
 struct GSEmitter {
+    /// A triangle emitted by the geometry shader
+    struct Primitive {
+        std::array<AttributeBuffer, 3> vertices;
+        /// Whether the vertex order of the triangle is inverted
+        bool winding;
+    };
+
+    /// Number of primitives the output array has room for before it has to grow
+    static constexpr std::size_t PREALLOCATED_PRIMITIVES = 64;
+
     std::array<AttributeBuffer, 3> buffer;
     u8 vertex_id;
     bool prim_emit;
     bool winding;
     u32 output_mask;
 
-    // Function objects are hidden behind a raw pointer to make the structure standard layout type,
-    // for JIT to use offsetof to access other members.
-    struct Handlers {
-        VertexHandler vertex_handler;
-        WindingSetter winding_setter;
-    } * handlers;
+    // The output array is hidden behind a raw pointer to make the structure standard layout type,
+    // for JIT to use offsetof to access other members. Primitives are collected there during a
+    // shader invocation and handed to primitive assembly once it has finished.
+    std::vector<Primitive>* primitives;
 
     GSEmitter();
     ~GSEmitter();
@@ -166,7 +168,6 @@ struct UnitState {
  */
 struct GSUnitState : public UnitState {
     GSUnitState();
-    void SetVertexHandler(VertexHandler vertex_handler, WindingSetter winding_setter);
     void ConfigOutput(const ShaderRegs& config);
 
     GSEmitter emitter;
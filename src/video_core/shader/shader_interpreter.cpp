@@ -5,6 +5,9 @@
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <iterator>
+#include <limits>
+#include <memory>
 #include <numeric>
 #include <boost/container/static_vector.hpp>
 #include <boost/range/algorithm/fill.hpp>
@@ -666,17 +669,895 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
     }
 }
 
+/// Register bank referred to by a pre-decoded operand
+enum class RegisterBank : u8 {
+    Input = 0,
+    Temporary = 1,
+    FloatUniform = 2,
+    Output = 3,
+    Invalid = 4,
+};
+
+enum class MicroOpType : u8 {
+    ADD,
+    MUL,
+    FLR,
+    MAX,
+    MIN,
+    DP3,
+    DP4,
+    DPH,
+    RCP,
+    RSQ,
+    MOVA,
+    MOV,
+    SGE,
+    SLT,
+    CMP,
+    EX2,
+    LG2,
+    MAD,
+    END,
+    JMPC,
+    JMPU,
+    CALL,
+    CALLU,
+    CALLC,
+    NOP,
+    IFU,
+    IFC,
+    LOOP,
+    EMIT,
+    SETEMIT,
+    UnhandledArithmetic,
+    UnhandledMultiplyAdd,
+    Unhandled,
+    NumMicroOps,
+};
+
+struct DecodedSource {
+    /// Undecoded register, used to resolve relative addressing at run time
+    SourceRegister reg;
+    RegisterBank bank;
+    u8 index;
+    std::array<u8, 4> selector;
+    bool negate;
+};
+
+/**
+ * A shader instruction with its operand descriptor resolved. There is exactly one micro-op per
+ * program word, so program offsets used by flow control instructions stay valid.
+ */
+struct MicroOp {
+    MicroOpType type;
+
+    RegisterBank dest_bank;
+    u8 dest_index;
+    /// Bit i is set if component i of the destination is written
+    u8 dest_mask;
+
+    /// 0 if no address register is used, otherwise 1 + the index of the address register
+    u8 address_register_index;
+    /// Source operand offset by the address register
+    u8 relative_src;
+    std::array<DecodedSource, 3> src;
+
+    std::array<Instruction::Common::CompareOpType, 2> compare_op;
+
+    /// Bit (cc.x | cc.y << 1) is set if the condition holds for those conditional codes
+    u8 condition_table;
+    /// Bool uniform tested by JMPU, CALLU and IFU, or integer uniform used by LOOP
+    u8 uniform_id;
+    /// Value of the bool uniform that makes JMPU jump
+    bool jump_if;
+    u32 dest_offset;
+    u32 num_instructions;
+
+    u8 vertex_id;
+    bool prim_emit;
+    bool winding;
+
+    /// Raw instruction word, used to report unhandled instructions
+    u32 hex;
+};
+
+static RegisterBank GetSourceBank(const SourceRegister& reg) {
+    switch (reg.GetRegisterType()) {
+    case RegisterType::Input:
+        return RegisterBank::Input;
+    case RegisterType::Temporary:
+        return RegisterBank::Temporary;
+    case RegisterType::FloatUniform:
+        return RegisterBank::FloatUniform;
+    default:
+        return RegisterBank::Invalid;
+    }
+}
+
+static DecodedSource DecodeSource(const SourceRegister& reg, u8 selector, bool negate) {
+    DecodedSource src{};
+    src.reg = reg;
+    src.bank = GetSourceBank(reg);
+    src.index = src.bank == RegisterBank::Invalid ? 0 : static_cast<u8>(reg.GetIndex());
+    // Selectors are stored as four 2-bit fields, with the x component in the upper bits
+    for (int i = 0; i < 4; ++i) {
+        src.selector[i] = (selector >> (6 - 2 * i)) & 3;
+    }
+    src.negate = negate;
+    return src;
+}
+
+static void DecodeDest(MicroOp& op, u32 dest) {
+    if (dest < 0x10) {
+        op.dest_bank = RegisterBank::Output;
+        op.dest_index = static_cast<u8>(dest);
+    } else if (dest < 0x20) {
+        op.dest_bank = RegisterBank::Temporary;
+        op.dest_index = static_cast<u8>(dest - 0x10);
+    } else {
+        op.dest_bank = RegisterBank::Invalid;
+        op.dest_index = 0;
+    }
+}
+
+static u8 BuildConditionTable(Instruction::FlowControlType flow_control) {
+    using Op = Instruction::FlowControlType::Op;
+
+    u8 table = 0;
+    for (u32 cc = 0; cc < 4; ++cc) {
+        const bool result_x = flow_control.refx.Value() == ((cc & 1) != 0);
+        const bool result_y = flow_control.refy.Value() == ((cc & 2) != 0);
+
+        bool result;
+        switch (flow_control.op) {
+        case Op::Or:
+            result = result_x || result_y;
+            break;
+        case Op::And:
+            result = result_x && result_y;
+            break;
+        case Op::JustX:
+            result = result_x;
+            break;
+        case Op::JustY:
+            result = result_y;
+            break;
+        default:
+            UNREACHABLE();
+            result = false;
+            break;
+        }
+        table |= (result ? 1 : 0) << cc;
+    }
+    return table;
+}
+
+static MicroOp DecodeInstruction(Instruction instr,
+                                 const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>& swizzle_data) {
+    MicroOp op{};
+    op.hex = instr.hex;
+    op.dest_bank = RegisterBank::Invalid;
+
+    switch (instr.opcode.Value().GetInfo().type) {
+    case OpCode::Type::Arithmetic: {
+        const SwizzlePattern swizzle = {swizzle_data[instr.common.operand_desc_id]};
+        const bool is_inverted =
+            (0 != (instr.opcode.Value().GetInfo().subtype & OpCode::Info::SrcInversed));
+
+        op.address_register_index = static_cast<u8>(instr.common.address_register_index.Value());
+        op.relative_src = is_inverted ? 1 : 0;
+        op.src[0] = DecodeSource(instr.common.GetSrc1(is_inverted), swizzle.GetRawSelector(1),
+                                 swizzle.negate_src1);
+        op.src[1] = DecodeSource(instr.common.GetSrc2(is_inverted), swizzle.GetRawSelector(2),
+                                 swizzle.negate_src2);
+        DecodeDest(op, instr.common.dest.Value());
+        for (int i = 0; i < 4; ++i) {
+            op.dest_mask |= (swizzle.DestComponentEnabled(i) ? 1 : 0) << i;
+        }
+
+        switch (instr.opcode.Value().EffectiveOpCode()) {
+        case OpCode::Id::ADD:
+            op.type = MicroOpType::ADD;
+            break;
+        case OpCode::Id::MUL:
+            op.type = MicroOpType::MUL;
+            break;
+        case OpCode::Id::FLR:
+            op.type = MicroOpType::FLR;
+            break;
+        case OpCode::Id::MAX:
+            op.type = MicroOpType::MAX;
+            break;
+        case OpCode::Id::MIN:
+            op.type = MicroOpType::MIN;
+            break;
+        case OpCode::Id::DP3:
+            op.type = MicroOpType::DP3;
+            break;
+        case OpCode::Id::DP4:
+            op.type = MicroOpType::DP4;
+            break;
+        case OpCode::Id::DPH:
+        case OpCode::Id::DPHI:
+            op.type = MicroOpType::DPH;
+            break;
+        case OpCode::Id::RCP:
+            op.type = MicroOpType::RCP;
+            break;
+        case OpCode::Id::RSQ:
+            op.type = MicroOpType::RSQ;
+            break;
+        case OpCode::Id::MOVA:
+            op.type = MicroOpType::MOVA;
+            break;
+        case OpCode::Id::MOV:
+            op.type = MicroOpType::MOV;
+            break;
+        case OpCode::Id::SGE:
+        case OpCode::Id::SGEI:
+            op.type = MicroOpType::SGE;
+            break;
+        case OpCode::Id::SLT:
+        case OpCode::Id::SLTI:
+            op.type = MicroOpType::SLT;
+            break;
+        case OpCode::Id::CMP:
+            op.type = MicroOpType::CMP;
+            op.compare_op = {instr.common.compare_op.x.Value(), instr.common.compare_op.y.Value()};
+            break;
+        case OpCode::Id::EX2:
+            op.type = MicroOpType::EX2;
+            break;
+        case OpCode::Id::LG2:
+            op.type = MicroOpType::LG2;
+            break;
+        default:
+            op.type = MicroOpType::UnhandledArithmetic;
+            break;
+        }
+        break;
+    }
+
+    case OpCode::Type::MultiplyAdd: {
+        if ((instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MAD) ||
+            (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI)) {
+            const SwizzlePattern swizzle = {swizzle_data[instr.mad.operand_desc_id]};
+            const bool is_inverted = (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI);
+
+            op.type = MicroOpType::MAD;
+            op.address_register_index = static_cast<u8>(instr.mad.address_register_index.Value());
+            op.relative_src = is_inverted ? 2 : 1;
+            op.src[0] = DecodeSource(instr.mad.GetSrc1(is_inverted), swizzle.GetRawSelector(1),
+                                     swizzle.negate_src1);
+            op.src[1] = DecodeSource(instr.mad.GetSrc2(is_inverted), swizzle.GetRawSelector(2),
+                                     swizzle.negate_src2);
+            op.src[2] = DecodeSource(instr.mad.GetSrc3(is_inverted), swizzle.GetRawSelector(3),
+                                     swizzle.negate_src3);
+            DecodeDest(op, instr.mad.dest.Value());
+            for (int i = 0; i < 4; ++i) {
+                op.dest_mask |= (swizzle.DestComponentEnabled(i) ? 1 : 0) << i;
+            }
+        } else {
+            op.type = MicroOpType::UnhandledMultiplyAdd;
+        }
+        break;
+    }
+
+    default: {
+        const auto& flow_control = instr.flow_control;
+        op.dest_offset = flow_control.dest_offset;
+        op.num_instructions = flow_control.num_instructions;
+
+        switch (instr.opcode.Value()) {
+        case OpCode::Id::END:
+            op.type = MicroOpType::END;
+            break;
+        case OpCode::Id::JMPC:
+            op.type = MicroOpType::JMPC;
+            op.condition_table = BuildConditionTable(flow_control);
+            break;
+        case OpCode::Id::JMPU:
+            op.type = MicroOpType::JMPU;
+            op.uniform_id = static_cast<u8>(flow_control.bool_uniform_id.Value());
+            op.jump_if = !(flow_control.num_instructions & 1);
+            break;
+        case OpCode::Id::CALL:
+            op.type = MicroOpType::CALL;
+            break;
+        case OpCode::Id::CALLU:
+            op.type = MicroOpType::CALLU;
+            op.uniform_id = static_cast<u8>(flow_control.bool_uniform_id.Value());
+            break;
+        case OpCode::Id::CALLC:
+            op.type = MicroOpType::CALLC;
+            op.condition_table = BuildConditionTable(flow_control);
+            break;
+        case OpCode::Id::NOP:
+            op.type = MicroOpType::NOP;
+            break;
+        case OpCode::Id::IFU:
+            op.type = MicroOpType::IFU;
+            op.uniform_id = static_cast<u8>(flow_control.bool_uniform_id.Value());
+            break;
+        case OpCode::Id::IFC:
+            op.type = MicroOpType::IFC;
+            op.condition_table = BuildConditionTable(flow_control);
+            break;
+        case OpCode::Id::LOOP:
+            op.type = MicroOpType::LOOP;
+            op.uniform_id = static_cast<u8>(flow_control.int_uniform_id.Value());
+            break;
+        case OpCode::Id::EMIT:
+            op.type = MicroOpType::EMIT;
+            break;
+        case OpCode::Id::SETEMIT:
+            op.type = MicroOpType::SETEMIT;
+            op.vertex_id = static_cast<u8>(instr.setemit.vertex_id.Value());
+            op.prim_emit = instr.setemit.prim_emit != 0;
+            op.winding = instr.setemit.winding != 0;
+            break;
+        default:
+            op.type = MicroOpType::Unhandled;
+            break;
+        }
+        break;
+    }
+    }
+
+    return op;
+}
+
+/**
+ * A shader program translated to micro-ops. Decoding happens once per program, so running the
+ * program doesn't have to look at the instruction encoding and the swizzle patterns again.
+ */
+class DecodedProgram {
+public:
+    DecodedProgram(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>& program_code,
+                   const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>& swizzle_data) {
+        for (std::size_t i = 0; i < program_code.size(); ++i) {
+            ops[i] = DecodeInstruction({program_code[i]}, swizzle_data);
+        }
+        // Guards against programs running off the end of the code memory
+        ops[MAX_PROGRAM_CODE_LENGTH] = {};
+        ops[MAX_PROGRAM_CODE_LENGTH].type = MicroOpType::END;
+    }
+
+    void Run(const Uniforms& uniforms, UnitState& state, unsigned entry_point) const;
+
+private:
+    std::array<MicroOp, MAX_PROGRAM_CODE_LENGTH + 1> ops;
+};
+
+// Use computed gotos where available, so that every handler has its own indirect branch. This
+// gives the host branch predictor a much better chance than a single shared switch dispatch.
+#if defined(__GNUC__) || defined(__clang__)
+#define SHADER_THREADED_DISPATCH
+#endif
+
+void DecodedProgram::Run(const Uniforms& uniforms, UnitState& state, unsigned entry_point) const {
+    boost::container::static_vector<CallStackElement, 16> call_stack;
+    // Final address of the innermost call stack element, cached to keep the per-instruction check
+    // down to a single comparison
+    u32 final_address = std::numeric_limits<u32>::max();
+    u32 program_counter = entry_point;
+
+    state.conditional_code[0] = false;
+    state.conditional_code[1] = false;
+
+    // Placeholder for invalid inputs and outputs
+    static float24 dummy_vec4_float24[4];
+
+    const float24* const source_banks[] = {
+        &state.registers.input[0].x,
+        &state.registers.temporary[0].x,
+        &uniforms.f[0].x,
+        nullptr,
+        dummy_vec4_float24,
+    };
+    float24* const dest_banks[] = {
+        nullptr,
+        &state.registers.temporary[0].x,
+        nullptr,
+        &state.registers.output[0].x,
+        dummy_vec4_float24,
+    };
+
+    auto call = [&](u32 offset, u32 num_instructions, u32 return_offset, u8 repeat_count,
+                    u8 loop_increment) {
+        // -1 to make sure when incrementing the PC we end up at the correct offset
+        program_counter = offset - 1;
+        ASSERT(call_stack.size() < call_stack.capacity());
+        call_stack.push_back(
+            {offset + num_instructions, return_offset, repeat_count, loop_increment, offset});
+        final_address = offset + num_instructions;
+    };
+
+    auto evaluate_condition = [&state](const MicroOp& op) {
+        const u32 cc = (state.conditional_code[0] ? 1 : 0) | (state.conditional_code[1] ? 2 : 0);
+        return (op.condition_table >> cc) & 1;
+    };
+
+    auto load_source = [&](const MicroOp& op, int n, float24(&out)[4]) {
+        const DecodedSource& src = op.src[n];
+        const float24* reg;
+        if (op.address_register_index != 0 && op.relative_src == n) {
+            const SourceRegister relative =
+                src.reg + state.address_registers[op.address_register_index - 1];
+            const RegisterBank bank = GetSourceBank(relative);
+            reg = source_banks[static_cast<std::size_t>(bank)];
+            if (bank != RegisterBank::Invalid) {
+                reg += relative.GetIndex() * 4;
+            }
+        } else {
+            reg = source_banks[static_cast<std::size_t>(src.bank)] + src.index * 4;
+        }
+
+        for (int i = 0; i < 4; ++i) {
+            out[i] = src.negate ? -reg[src.selector[i]] : reg[src.selector[i]];
+        }
+    };
+
+    auto get_dest = [&](const MicroOp& op) {
+        return dest_banks[static_cast<std::size_t>(op.dest_bank)] + op.dest_index * 4;
+    };
+
+    const MicroOp* op;
+    float24 src1[4];
+    float24 src2[4];
+    float24 src3[4];
+
+#ifdef SHADER_THREADED_DISPATCH
+    // Must be kept in the order of MicroOpType
+    static const void* const dispatch_table[] = {
+        &&op_ADD,  &&op_MUL,   &&op_FLR,   &&op_MAX,  &&op_MIN,  &&op_DP3,
+        &&op_DP4,  &&op_DPH,   &&op_RCP,   &&op_RSQ,  &&op_MOVA, &&op_MOV,
+        &&op_SGE,  &&op_SLT,   &&op_CMP,   &&op_EX2,  &&op_LG2,  &&op_MAD,
+        &&op_END,  &&op_JMPC,  &&op_JMPU,  &&op_CALL, &&op_CALLU, &&op_CALLC,
+        &&op_NOP,  &&op_IFU,   &&op_IFC,   &&op_LOOP, &&op_EMIT, &&op_SETEMIT,
+        &&op_UnhandledArithmetic,
+        &&op_UnhandledMultiplyAdd,
+        &&op_Unhandled,
+    };
+    static_assert(std::size(dispatch_table) == static_cast<std::size_t>(MicroOpType::NumMicroOps),
+                  "Dispatch table doesn't cover all micro-ops");
+#define DISPATCH() goto* dispatch_table[static_cast<std::size_t>(op->type)]
+#define CASE(name) op_##name
+#else
+#define DISPATCH() goto dispatch
+#define CASE(name) case MicroOpType::name
+#endif
+
+// Advances to the next instruction, leaving any scopes that end there
+#define NEXT()                                                                                     \
+    do {                                                                                           \
+        ++program_counter;                                                                         \
+        if (program_counter == final_address) {                                                   \
+            goto leave_scope;                                                                      \
+        }                                                                                          \
+        op = &ops[program_counter];                                                                \
+        DISPATCH();                                                                                \
+    } while (0)
+
+#define FOR_EACH_ENABLED_COMPONENT(i)                                                              \
+    for (int i = 0; i < 4; ++i)                                                                    \
+        if (op->dest_mask & (1 << i))
+
+    // The entry point may be the end of a scope if it hasn't been entered yet, so start by
+    // dispatching directly
+    op = &ops[program_counter];
+    DISPATCH();
+
+leave_scope:
+    while (!call_stack.empty() && program_counter == final_address) {
+        auto& top = call_stack.back();
+        state.address_registers[2] += top.loop_increment;
+
+        if (top.repeat_counter-- == 0) {
+            program_counter = top.return_address;
+            call_stack.pop_back();
+            final_address = call_stack.empty() ? std::numeric_limits<u32>::max()
+                                               : call_stack.back().final_address;
+        } else {
+            program_counter = top.loop_address;
+        }
+    }
+    op = &ops[program_counter];
+    DISPATCH();
+
+#ifndef SHADER_THREADED_DISPATCH
+dispatch:
+    switch (op->type) {
+#endif
+
+    CASE(ADD) : {
+        load_source(*op, 0, src1);
+        load_source(*op, 1, src2);
+        float24* dest = get_dest(*op);
+        FOR_EACH_ENABLED_COMPONENT(i) {
+            dest[i] = src1[i] + src2[i];
+        }
+        NEXT();
+    }
+
+    CASE(MUL) : {
+        load_source(*op, 0, src1);
+        load_source(*op, 1, src2);
+        float24* dest = get_dest(*op);
+        FOR_EACH_ENABLED_COMPONENT(i) {
+            dest[i] = src1[i] * src2[i];
+        }
+        NEXT();
+    }
+
+    CASE(FLR) : {
+        load_source(*op, 0, src1);
+        float24* dest = get_dest(*op);
+        FOR_EACH_ENABLED_COMPONENT(i) {
+            dest[i] = float24::FromFloat32(std::floor(src1[i].ToFloat32()));
+        }
+        NEXT();
+    }
+
+    CASE(MAX) : {
+        load_source(*op, 0, src1);
+        load_source(*op, 1, src2);
+        float24* dest = get_dest(*op);
+        FOR_EACH_ENABLED_COMPONENT(i) {
+            // NOTE: Exact form required to match NaN semantics to hardware:
+            //   max(0, NaN) -> NaN
+            //   max(NaN, 0) -> 0
+            dest[i] = (src1[i] > src2[i]) ? src1[i] : src2[i];
+        }
+        NEXT();
+    }
+
+    CASE(MIN) : {
+        load_source(*op, 0, src1);
+        load_source(*op, 1, src2);
+        float24* dest = get_dest(*op);
+        FOR_EACH_ENABLED_COMPONENT(i) {
+            // NOTE: Exact form required to match NaN semantics to hardware:
+            //   min(0, NaN) -> NaN
+            //   min(NaN, 0) -> 0
+            dest[i] = (src1[i] < src2[i]) ? src1[i] : src2[i];
+        }
+        NEXT();
+    }
+
+    CASE(DP3) : {
+        load_source(*op, 0, src1);
+        load_source(*op, 1, src2);
+        float24* dest = get_dest(*op);
+        const float24 dot = std::inner_product(src1, src1 + 3, src2, float24::FromFloat32(0.f));
+        FOR_EACH_ENABLED_COMPONENT(i) {
+            dest[i] = dot;
+        }
+        NEXT();
+    }
+
+    CASE(DP4) : {
+        load_source(*op, 0, src1);
+        load_source(*op, 1, src2);
+        float24* dest = get_dest(*op);
+        const float24 dot = std::inner_product(src1, src1 + 4, src2, float24::FromFloat32(0.f));
+        FOR_EACH_ENABLED_COMPONENT(i) {
+            dest[i] = dot;
+        }
+        NEXT();
+    }
+
+    CASE(DPH) : {
+        load_source(*op, 0, src1);
+        load_source(*op, 1, src2);
+        float24* dest = get_dest(*op);
+        src1[3] = float24::FromFloat32(1.0f);
+        const float24 dot = std::inner_product(src1, src1 + 4, src2, float24::FromFloat32(0.f));
+        FOR_EACH_ENABLED_COMPONENT(i) {
+            dest[i] = dot;
+        }
+        NEXT();
+    }
+
+    CASE(RCP) : {
+        load_source(*op, 0, src1);
+        float24* dest = get_dest(*op);
+        const float24 rcp_res = float24::FromFloat32(1.0f / src1[0].ToFloat32());
+        FOR_EACH_ENABLED_COMPONENT(i) {
+            dest[i] = rcp_res;
+        }
+        NEXT();
+    }
+
+    CASE(RSQ) : {
+        load_source(*op, 0, src1);
+        float24* dest = get_dest(*op);
+        const float24 rsq_res = float24::FromFloat32(1.0f / std::sqrt(src1[0].ToFloat32()));
+        FOR_EACH_ENABLED_COMPONENT(i) {
+            dest[i] = rsq_res;
+        }
+        NEXT();
+    }
+
+    CASE(MOVA) : {
+        load_source(*op, 0, src1);
+        for (int i = 0; i < 2; ++i) {
+            if (op->dest_mask & (1 << i)) {
+                // TODO: Figure out how the rounding is done on hardware
+                state.address_registers[i] = static_cast<s32>(src1[i].ToFloat32());
+            }
+        }
+        NEXT();
+    }
+
+    CASE(MOV) : {
+        load_source(*op, 0, src1);
+        float24* dest = get_dest(*op);
+        FOR_EACH_ENABLED_COMPONENT(i) {
+            dest[i] = src1[i];
+        }
+        NEXT();
+    }
+
+    CASE(SGE) : {
+        load_source(*op, 0, src1);
+        load_source(*op, 1, src2);
+        float24* dest = get_dest(*op);
+        FOR_EACH_ENABLED_COMPONENT(i) {
+            dest[i] =
+                (src1[i] >= src2[i]) ? float24::FromFloat32(1.0f) : float24::FromFloat32(0.0f);
+        }
+        NEXT();
+    }
+
+    CASE(SLT) : {
+        load_source(*op, 0, src1);
+        load_source(*op, 1, src2);
+        float24* dest = get_dest(*op);
+        FOR_EACH_ENABLED_COMPONENT(i) {
+            dest[i] = (src1[i] < src2[i]) ? float24::FromFloat32(1.0f) : float24::FromFloat32(0.0f);
+        }
+        NEXT();
+    }
+
+    CASE(CMP) : {
+        load_source(*op, 0, src1);
+        load_source(*op, 1, src2);
+        for (int i = 0; i < 2; ++i) {
+            switch (op->compare_op[i]) {
+            case Instruction::Common::CompareOpType::Equal:
+                state.conditional_code[i] = (src1[i] == src2[i]);
+                break;
+
+            case Instruction::Common::CompareOpType::NotEqual:
+                state.conditional_code[i] = (src1[i] != src2[i]);
+                break;
+
+            case Instruction::Common::CompareOpType::LessThan:
+                state.conditional_code[i] = (src1[i] < src2[i]);
+                break;
+
+            case Instruction::Common::CompareOpType::LessEqual:
+                state.conditional_code[i] = (src1[i] <= src2[i]);
+                break;
+
+            case Instruction::Common::CompareOpType::GreaterThan:
+                state.conditional_code[i] = (src1[i] > src2[i]);
+                break;
+
+            case Instruction::Common::CompareOpType::GreaterEqual:
+                state.conditional_code[i] = (src1[i] >= src2[i]);
+                break;
+
+            default:
+                LOG_ERROR(HW_GPU, "Unknown compare mode {:x}",
+                          static_cast<int>(op->compare_op[i]));
+                break;
+            }
+        }
+        NEXT();
+    }
+
+    CASE(EX2) : {
+        load_source(*op, 0, src1);
+        float24* dest = get_dest(*op);
+        const float24 ex2_res = float24::FromFloat32(std::exp2(src1[0].ToFloat32()));
+        FOR_EACH_ENABLED_COMPONENT(i) {
+            dest[i] = ex2_res;
+        }
+        NEXT();
+    }
+
+    CASE(LG2) : {
+        load_source(*op, 0, src1);
+        float24* dest = get_dest(*op);
+        const float24 lg2_res = float24::FromFloat32(std::log2(src1[0].ToFloat32()));
+        FOR_EACH_ENABLED_COMPONENT(i) {
+            dest[i] = lg2_res;
+        }
+        NEXT();
+    }
+
+    CASE(MAD) : {
+        load_source(*op, 0, src1);
+        load_source(*op, 1, src2);
+        load_source(*op, 2, src3);
+        float24* dest = get_dest(*op);
+        FOR_EACH_ENABLED_COMPONENT(i) {
+            dest[i] = src1[i] * src2[i] + src3[i];
+        }
+        NEXT();
+    }
+
+    CASE(END) : {
+        goto end;
+    }
+
+    CASE(JMPC) : {
+        if (evaluate_condition(*op)) {
+            program_counter = op->dest_offset - 1;
+        }
+        NEXT();
+    }
+
+    CASE(JMPU) : {
+        if (uniforms.b[op->uniform_id] == op->jump_if) {
+            program_counter = op->dest_offset - 1;
+        }
+        NEXT();
+    }
+
+    CASE(CALL) : {
+        call(op->dest_offset, op->num_instructions, program_counter + 1, 0, 0);
+        NEXT();
+    }
+
+    CASE(CALLU) : {
+        if (uniforms.b[op->uniform_id]) {
+            call(op->dest_offset, op->num_instructions, program_counter + 1, 0, 0);
+        }
+        NEXT();
+    }
+
+    CASE(CALLC) : {
+        if (evaluate_condition(*op)) {
+            call(op->dest_offset, op->num_instructions, program_counter + 1, 0, 0);
+        }
+        NEXT();
+    }
+
+    CASE(NOP) : {
+        NEXT();
+    }
+
+    CASE(IFU) : {
+        if (uniforms.b[op->uniform_id]) {
+            call(program_counter + 1, op->dest_offset - program_counter - 1,
+                 op->dest_offset + op->num_instructions, 0, 0);
+        } else {
+            call(op->dest_offset, op->num_instructions, op->dest_offset + op->num_instructions, 0,
+                 0);
+        }
+        NEXT();
+    }
+
+    CASE(IFC) : {
+        if (evaluate_condition(*op)) {
+            call(program_counter + 1, op->dest_offset - program_counter - 1,
+                 op->dest_offset + op->num_instructions, 0, 0);
+        } else {
+            call(op->dest_offset, op->num_instructions, op->dest_offset + op->num_instructions, 0,
+                 0);
+        }
+        NEXT();
+    }
+
+    CASE(LOOP) : {
+        const auto& loop_param = uniforms.i[op->uniform_id];
+        state.address_registers[2] = loop_param.y;
+        call(program_counter + 1, op->dest_offset - program_counter, op->dest_offset + 1,
+             loop_param.x, loop_param.z);
+        NEXT();
+    }
+
+    CASE(EMIT) : {
+        GSEmitter* emitter = state.emitter_ptr;
+        ASSERT_MSG(emitter, "Execute EMIT on VS");
+        emitter->Emit(state.registers.output);
+        NEXT();
+    }
+
+    CASE(SETEMIT) : {
+        GSEmitter* emitter = state.emitter_ptr;
+        ASSERT_MSG(emitter, "Execute SETEMIT on VS");
+        emitter->vertex_id = op->vertex_id;
+        emitter->prim_emit = op->prim_emit;
+        emitter->winding = op->winding;
+        NEXT();
+    }
+
+    CASE(UnhandledArithmetic) : {
+        const Instruction instr = {op->hex};
+        LOG_ERROR(HW_GPU, "Unhandled arithmetic instruction: 0x{:02x} ({}): 0x{:08x}",
+                  (int)instr.opcode.Value().EffectiveOpCode(), instr.opcode.Value().GetInfo().name,
+                  instr.hex);
+        DEBUG_ASSERT(false);
+        NEXT();
+    }
+
+    CASE(UnhandledMultiplyAdd) : {
+        const Instruction instr = {op->hex};
+        LOG_ERROR(HW_GPU, "Unhandled multiply-add instruction: 0x{:02x} ({}): 0x{:08x}",
+                  (int)instr.opcode.Value().EffectiveOpCode(), instr.opcode.Value().GetInfo().name,
+                  instr.hex);
+        NEXT();
+    }
+
+    CASE(Unhandled) : {
+        const Instruction instr = {op->hex};
+        LOG_ERROR(HW_GPU, "Unhandled instruction: 0x{:02x} ({}): 0x{:08x}",
+                  (int)instr.opcode.Value().EffectiveOpCode(), instr.opcode.Value().GetInfo().name,
+                  instr.hex);
+        NEXT();
+    }
+
+#ifndef SHADER_THREADED_DISPATCH
+    default:
+        UNREACHABLE();
+        goto end;
+    }
+#endif
+
+end:
+    return;
+
+#undef FOR_EACH_ENABLED_COMPONENT
+#undef NEXT
+#undef CASE
+#undef DISPATCH
+}
+
+InterpreterEngine::InterpreterEngine() = default;
+InterpreterEngine::~InterpreterEngine() = default;
+
 void InterpreterEngine::SetupBatch(ShaderSetup& setup, unsigned int entry_point) {
     ASSERT(entry_point < MAX_PROGRAM_CODE_LENGTH);
     setup.engine_data.entry_point = entry_point;
+
+    u64 code_hash = setup.GetProgramCodeHash();
+    u64 swizzle_hash = setup.GetSwizzleDataHash();
+
+    u64 cache_key = code_hash ^ swizzle_hash;
+    auto iter = cache.find(cache_key);
+    if (iter == cache.end()) {
+        if (cache.size() >= MAX_CACHED_PROGRAMS) {
+            const auto oldest =
+                std::min_element(cache.begin(), cache.end(), [](const auto& a, const auto& b) {
+                    return a.second.last_use < b.second.last_use;
+                });
+            cache.erase(oldest);
+        }
+
+        auto program = std::make_unique<DecodedProgram>(setup.program_code, setup.swizzle_data);
+        iter = cache.emplace(cache_key, CacheEntry{std::move(program)}).first;
+    }
+
+    iter->second.last_use = ++use_counter;
+    setup.engine_data.cached_shader = iter->second.program.get();
 }
 
 MICROPROFILE_DECLARE(GPU_Shader);
 
 void InterpreterEngine::Run(const ShaderSetup& setup, UnitState& state) const {
+    ASSERT(setup.engine_data.cached_shader != nullptr);
 
     MICROPROFILE_SCOPE(GPU_Shader);
 
+    const auto* program = static_cast<const DecodedProgram*>(setup.engine_data.cached_shader);
+    program->Run(setup.uniforms, state, setup.engine_data.entry_point);
+}
+
+void InterpreterEngine::RunUndecoded(const ShaderSetup& setup, UnitState& state) const {
     DebugData<false> dummy_debug_data;
     RunInterpreter(setup, state, dummy_debug_data, setup.engine_data.entry_point);
 }
@@ -4,16 +4,33 @@
 
 #pragma once
 
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include "common/common_types.h"
 #include "video_core/shader/debug_data.h"
 #include "video_core/shader/shader.h"
 
 namespace Pica::Shader {
 
+class DecodedProgram;
+
 class InterpreterEngine final : public ShaderEngine {
 public:
+    InterpreterEngine();
+    ~InterpreterEngine() override;
+
     void SetupBatch(ShaderSetup& setup, unsigned int entry_point) override;
     void Run(const ShaderSetup& setup, UnitState& state) const override;
 
+    /**
+     * Runs the shader like Run, but decodes every instruction as it is executed instead of using
+     * the pre-decoded program. Much slower, it serves as a reference for the decoded path.
+     * @param setup Shader engine state, SetupBatch must have been called
+     * @param state Shader unit state, must be setup with input data before each shader invocation
+     */
+    void RunUndecoded(const ShaderSetup& setup, UnitState& state) const;
+
     /**
      * Produce debug information based on the given shader and input vertex
      * @param setup  Shader engine state
@@ -23,6 +40,23 @@ public:
      */
     DebugData<true> ProduceDebugInfo(const ShaderSetup& setup, const AttributeBuffer& input,
                                      const ShaderRegs& config) const;
+
+private:
+    /// Maximum number of decoded programs kept, each of them takes about 260 KiB. The least
+    /// recently set up program is evicted first, so the programs of the vertex and geometry shader
+    /// setups of the current draw are never evicted.
+    static constexpr std::size_t MAX_CACHED_PROGRAMS = 32;
+
+    struct CacheEntry {
+        std::unique_ptr<DecodedProgram> program;
+        /// Value of use_counter when the program was last set up
+        u64 last_use = 0;
+    };
+
+    /// Programs translated to micro-ops, keyed by the hashes of their code and swizzle data
+    std::unordered_map<u64, CacheEntry> cache;
+    /// Incremented whenever a program is set up
+    u64 use_counter = 0;
 };
 
 } // namespace Pica::Shader
@@ -2,16 +2,34 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <array>
+#include <boost/functional/hash.hpp>
+#include "common/hash.h"
+#include "common/logging/log.h"
 #include "common/microprofile.h"
+#include "common/vector_math.h"
 #include "video_core/shader/shader.h"
 #include "video_core/shader/shader_jit_x64.h"
 #include "video_core/shader/shader_jit_x64_compiler.h"
 
 namespace Pica::Shader {
 
-JitX64Engine::JitX64Engine() = default;
+JitX64Engine::JitX64Engine() {
+    LOG_INFO(HW_GPU, "Shader JIT targeting {}",
+             JitShader::IsAVXTierSupported() ? "AVX2" : "SSE");
+}
+
 JitX64Engine::~JitX64Engine() = default;
 
+/// Hashes the uniforms that a specialized shader treats as constants
+static u64 GetUniformConstantsHash(const Uniforms& uniforms) {
+    struct {
+        std::array<bool, 16> b;
+        std::array<Common::Vec4<u8>, 4> i;
+    } constants{uniforms.b, uniforms.i};
+    return Common::ComputeStructHash64(constants);
+}
+
 void JitX64Engine::SetupBatch(ShaderSetup& setup, unsigned int entry_point) {
     ASSERT(entry_point < MAX_PROGRAM_CODE_LENGTH);
     setup.engine_data.entry_point = entry_point;
@@ -21,14 +39,49 @@ void JitX64Engine::SetupBatch(ShaderSetup& setup, unsigned int entry_point) {
 
     u64 cache_key = code_hash ^ swizzle_hash;
     auto iter = cache.find(cache_key);
-    if (iter != cache.end()) {
-        setup.engine_data.cached_shader = iter->second.get();
-    } else {
+    if (iter == cache.end()) {
         auto shader = std::make_unique<JitShader>();
         shader->Compile(&setup.program_code, &setup.swizzle_data);
-        setup.engine_data.cached_shader = shader.get();
-        cache.emplace_hint(iter, cache_key, std::move(shader));
+        iter = cache.emplace_hint(iter, cache_key, CacheEntry{std::move(shader)});
+    }
+
+    CacheEntry& entry = iter->second;
+    setup.engine_data.cached_shader = entry.shader.get();
+
+    if (!entry.shader->UsesUniformFlowControl()) {
+        return;
+    }
+
+    // Only specialize programs whose uniforms stay the same for a while, most uniform changes
+    // would otherwise trigger a compilation
+    const u64 uniform_hash = GetUniformConstantsHash(setup.uniforms);
+    if (uniform_hash != entry.uniform_hash) {
+        entry.uniform_hash = uniform_hash;
+        entry.stable_batches = 0;
+        return;
+    }
+    if (entry.stable_batches < SPECIALIZATION_THRESHOLD) {
+        ++entry.stable_batches;
+        return;
+    }
+
+    // Specialized shaders drop unreachable code, which might contain another entry point
+    std::size_t specialized_key = cache_key;
+    boost::hash_combine(specialized_key, uniform_hash);
+    boost::hash_combine(specialized_key, entry_point);
+    auto specialized_iter = specialized_cache.find(specialized_key);
+    if (specialized_iter == specialized_cache.end()) {
+        if (entry.num_specializations >= MAX_SPECIALIZATIONS) {
+            return;
+        }
+        ++entry.num_specializations;
+
+        auto shader = std::make_unique<JitShader>();
+        shader->Compile(&setup.program_code, &setup.swizzle_data, &setup.uniforms, entry_point);
+        specialized_iter =
+            specialized_cache.emplace_hint(specialized_iter, specialized_key, std::move(shader));
     }
+    setup.engine_data.cached_shader = specialized_iter->second.get();
 }
 
 MICROPROFILE_DECLARE(GPU_Shader);
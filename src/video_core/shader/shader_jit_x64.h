@@ -22,7 +22,27 @@ public:
     void Run(const ShaderSetup& setup, UnitState& state) const override;
 
 private:
-    std::unordered_map<u64, std::unique_ptr<JitShader>> cache;
+    /// Number of consecutive batches a program has to run with the same bool and int uniforms
+    /// before a variant specialized to those uniforms is compiled
+    static constexpr unsigned SPECIALIZATION_THRESHOLD = 8;
+    /// Maximum number of specialized variants compiled for a single program
+    static constexpr unsigned MAX_SPECIALIZATIONS = 16;
+
+    struct CacheEntry {
+        std::unique_ptr<JitShader> shader;
+        /// Hash of the bool and int uniforms of the last batch running this program
+        u64 uniform_hash = 0;
+        /// Number of consecutive batches run with the same bool and int uniforms
+        unsigned stable_batches = 0;
+        /// Number of specialized variants compiled for this program so far
+        unsigned num_specializations = 0;
+    };
+
+    /// Generic shaders, keyed by the hashes of their code and swizzle data
+    std::unordered_map<u64, CacheEntry> cache;
+    /// Shaders specialized to bool and int uniform values, keyed by the hashes of their code,
+    /// swizzle data and uniform values
+    std::unordered_map<u64, std::unique_ptr<JitShader>> specialized_cache;
 };
 
 } // namespace Pica::Shader
@@ -211,24 +211,22 @@ void JitShader::Compile_SwizzleSrc(Instruction instr, unsigned src_num, SourceRe
         address_register_index = instr.common.address_register_index;
     }
 
+    Xbyak::RegExp src_addr = src_ptr + src_offset_disp;
     if (src_num == offset_src && address_register_index != 0) {
         switch (address_register_index) {
         case 1: // address offset 1
-            movaps(dest, xword[src_ptr + ADDROFFS_REG_0 + src_offset_disp]);
+            src_addr = src_ptr + ADDROFFS_REG_0 + src_offset_disp;
             break;
         case 2: // address offset 2
-            movaps(dest, xword[src_ptr + ADDROFFS_REG_1 + src_offset_disp]);
+            src_addr = src_ptr + ADDROFFS_REG_1 + src_offset_disp;
             break;
         case 3: // address offset 3
-            movaps(dest, xword[src_ptr + LOOPCOUNT_REG.cvt64() + src_offset_disp]);
+            src_addr = src_ptr + LOOPCOUNT_REG.cvt64() + src_offset_disp;
             break;
         default:
             UNREACHABLE();
             break;
         }
-    } else {
-        // Load the source
-        movaps(dest, xword[src_ptr + src_offset_disp]);
     }
 
     SwizzlePattern swiz = {(*swizzle_data)[operand_desc_id]};
@@ -239,8 +237,17 @@ void JitShader::Compile_SwizzleSrc(Instruction instr, unsigned src_num, SourceRe
         // Selector component order needs to be reversed for the SHUFPS instruction
         sel = ((sel & 0xc0) >> 6) | ((sel & 3) << 6) | ((sel & 0xc) << 2) | ((sel & 0x30) >> 2);
 
-        // Shuffle inputs for swizzle
-        shufps(dest, dest, sel);
+        if (use_avx) {
+            // Load and shuffle the source in one go
+            vpermilps(dest, xword[src_addr], sel);
+        } else {
+            // Load the source and shuffle inputs for swizzle
+            movaps(dest, xword[src_addr]);
+            shufps(dest, dest, sel);
+        }
+    } else {
+        // Load the source
+        movaps(dest, xword[src_addr]);
     }
 
     // If the source register should be negated, flip the negative bit using XOR
@@ -274,13 +281,18 @@ void JitShader::Compile_DestEnable(Instruction instr, Xmm src) {
     } else {
         // Not all components are enabled, so mask the result when storing to the destination
         // register...
-        movaps(SCRATCH, xword[STATE + dest_offset_disp]);
-
-        if (Common::GetCPUCaps().sse4_1) {
+        if (use_avx) {
+            // Blend the disabled components in straight from memory
+            u8 mask = ((swiz.dest_mask & 1) << 3) | ((swiz.dest_mask & 8) >> 3) |
+                      ((swiz.dest_mask & 2) << 1) | ((swiz.dest_mask & 4) >> 1);
+            vblendps(SCRATCH, src, xword[STATE + dest_offset_disp], static_cast<u8>(~mask & 0xf));
+        } else if (Common::GetCPUCaps().sse4_1) {
+            movaps(SCRATCH, xword[STATE + dest_offset_disp]);
             u8 mask = ((swiz.dest_mask & 1) << 3) | ((swiz.dest_mask & 8) >> 3) |
                       ((swiz.dest_mask & 2) << 1) | ((swiz.dest_mask & 4) >> 1);
             blendps(SCRATCH, src, mask);
         } else {
+            movaps(SCRATCH, xword[STATE + dest_offset_disp]);
             movaps(SCRATCH2, src);
             unpckhps(SCRATCH2, SCRATCH); // Unpack X/Y components of source and destination
             unpcklps(SCRATCH, src);      // Unpack Z/W components of source and destination
@@ -305,6 +317,16 @@ void JitShader::Compile_SanitizedMul(Xmm src1, Xmm src2, Xmm scratch) {
     // where neither source was, this NaN was generated by a 0 * inf multiplication, and so the
     // result should be transformed to 0 to match PICA fp rules.
 
+    if (use_avx) {
+        // Same as below, the non-destructive forms just save the copies
+        vcmpordps(scratch, src1, src2);
+        vmulps(src1, src1, src2);
+        vcmpunordps(src2, src1, src1);
+        vxorps(scratch, scratch, src2);
+        vandps(src1, src1, scratch);
+        return;
+    }
+
     // Set scratch to mask of (src1 != NaN and src2 != NaN)
     movaps(scratch, src1);
     cmpordps(scratch, src2);
@@ -320,6 +342,36 @@ void JitShader::Compile_SanitizedMul(Xmm src1, Xmm src2, Xmm scratch) {
     andps(src1, scratch);
 }
 
+void JitShader::Compile_HorizontalSum(Xmm src, int num_components, Xmm scratch, Xmm scratch2) {
+    // The interpreter sums the components one after the other, starting from +0. Adding them in
+    // the same order rounds the same way, and adding +0 at the end turns a -0 result into +0 like
+    // the initial +0 would have.
+    static constexpr u8 broadcast[] = {_MM_SHUFFLE(0, 0, 0, 0), _MM_SHUFFLE(1, 1, 1, 1),
+                                       _MM_SHUFFLE(2, 2, 2, 2), _MM_SHUFFLE(3, 3, 3, 3)};
+
+    if (use_avx) {
+        vmovaps(scratch2, src);
+        vpermilps(src, scratch2, broadcast[0]);
+        for (int i = 1; i < num_components; ++i) {
+            vpermilps(scratch, scratch2, broadcast[i]);
+            vaddps(src, src, scratch);
+        }
+        vxorps(scratch, scratch, scratch);
+        vaddps(src, src, scratch);
+        return;
+    }
+
+    movaps(scratch2, src);
+    shufps(src, src, broadcast[0]);
+    for (int i = 1; i < num_components; ++i) {
+        movaps(scratch, scratch2);
+        shufps(scratch, scratch, broadcast[i]);
+        addps(src, scratch);
+    }
+    xorps(scratch, scratch);
+    addps(src, scratch);
+}
+
 void JitShader::Compile_EvaluateCondition(Instruction instr) {
     // Note: NXOR is used below to check for equality
     switch (instr.flow_control.op) {
@@ -372,16 +424,7 @@ void JitShader::Compile_DP3(Instruction instr) {
     Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
 
     Compile_SanitizedMul(SRC1, SRC2, SCRATCH);
-
-    movaps(SRC2, SRC1);
-    shufps(SRC2, SRC2, _MM_SHUFFLE(1, 1, 1, 1));
-
-    movaps(SRC3, SRC1);
-    shufps(SRC3, SRC3, _MM_SHUFFLE(2, 2, 2, 2));
-
-    shufps(SRC1, SRC1, _MM_SHUFFLE(0, 0, 0, 0));
-    addps(SRC1, SRC2);
-    addps(SRC1, SRC3);
+    Compile_HorizontalSum(SRC1, 3, SCRATCH, SRC2);
 
     Compile_DestEnable(instr, SRC1);
 }
@@ -391,9 +434,7 @@ void JitShader::Compile_DP4(Instruction instr) {
     Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
 
     Compile_SanitizedMul(SRC1, SRC2, SCRATCH);
-
-    haddps(SRC1, SRC1);
-    haddps(SRC1, SRC1);
+    Compile_HorizontalSum(SRC1, 4, SCRATCH, SRC2);
 
     Compile_DestEnable(instr, SRC1);
 }
@@ -407,7 +448,10 @@ void JitShader::Compile_DPH(Instruction instr) {
         Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
     }
 
-    if (Common::GetCPUCaps().sse4_1) {
+    if (use_avx) {
+        // Set 4th component to 1.0
+        vblendps(SRC1, SRC1, ONE, 0b1000);
+    } else if (Common::GetCPUCaps().sse4_1) {
         // Set 4th component to 1.0
         blendps(SRC1, ONE, 0b1000);
     } else {
@@ -418,9 +462,7 @@ void JitShader::Compile_DPH(Instruction instr) {
     }
 
     Compile_SanitizedMul(SRC1, SRC2, SCRATCH);
-
-    haddps(SRC1, SRC1);
-    haddps(SRC1, SRC1);
+    Compile_HorizontalSum(SRC1, 4, SCRATCH, SRC2);
 
     Compile_DestEnable(instr, SRC1);
 }
@@ -623,6 +665,13 @@ void JitShader::Compile_CALLC(Instruction instr) {
 }
 
 void JitShader::Compile_CALLU(Instruction instr) {
+    if (uniform_constants) {
+        if (uniform_constants->b[instr.flow_control.bool_uniform_id]) {
+            Compile_CALL(instr);
+        }
+        return;
+    }
+
     Compile_UniformCondition(instr);
     Label b;
     jz(b);
@@ -684,8 +733,13 @@ void JitShader::Compile_MAD(Instruction instr) {
         Compile_SwizzleSrc(instr, 3, instr.mad.src3, SRC3);
     }
 
+    // Not fused: the product is rounded before the addition, like in the interpreter
     Compile_SanitizedMul(SRC1, SRC2, SCRATCH);
-    addps(SRC1, SRC3);
+    if (use_avx) {
+        vaddps(SRC1, SRC1, SRC3);
+    } else {
+        addps(SRC1, SRC3);
+    }
 
     Compile_DestEnable(instr, SRC1);
 }
@@ -695,6 +749,19 @@ void JitShader::Compile_IF(Instruction instr) {
                    "Backwards if-statements not supported");
     Label l_else, l_endif;
 
+    if (instr.opcode.Value() == OpCode::Id::IFU && uniform_constants) {
+        // Only the branch selected by the constant uniform needs to be compiled
+        if (uniform_constants->b[instr.flow_control.bool_uniform_id]) {
+            Compile_Block(instr.flow_control.dest_offset);
+            Compile_DeadBlock(instr.flow_control.dest_offset +
+                              instr.flow_control.num_instructions);
+        } else {
+            Compile_DeadBlock(instr.flow_control.dest_offset);
+            Compile_Block(instr.flow_control.dest_offset + instr.flow_control.num_instructions);
+        }
+        return;
+    }
+
     // Evaluate the "IF" condition
     if (instr.opcode.Value() == OpCode::Id::IFU) {
         Compile_UniformCondition(instr);
@@ -732,16 +799,23 @@ void JitShader::Compile_LOOP(Instruction instr) {
     // This decodes the fields from the integer uniform at index instr.flow_control.int_uniform_id.
     // The Y (LOOPCOUNT_REG) and Z (LOOPINC) component are kept multiplied by 16 (Left shifted by
     // 4 bits) to be used as an offset into the 16-byte vector registers later
-    std::size_t offset = Uniforms::GetIntUniformOffset(instr.flow_control.int_uniform_id);
-    mov(LOOPCOUNT, dword[UNIFORMS + offset]);
-    mov(LOOPCOUNT_REG, LOOPCOUNT);
-    shr(LOOPCOUNT_REG, 4);
-    and_(LOOPCOUNT_REG, 0xFF0); // Y-component is the start
-    mov(LOOPINC, LOOPCOUNT);
-    shr(LOOPINC, 12);
-    and_(LOOPINC, 0xFF0);               // Z-component is the incrementer
-    movzx(LOOPCOUNT, LOOPCOUNT.cvt8()); // X-component is iteration count
-    add(LOOPCOUNT, 1);                  // Iteration count is X-component + 1
+    if (uniform_constants) {
+        const auto& loop_param = uniform_constants->i[instr.flow_control.int_uniform_id];
+        mov(LOOPCOUNT_REG, loop_param.y * 16);
+        mov(LOOPINC, loop_param.z * 16);
+        mov(LOOPCOUNT, loop_param.x + 1);
+    } else {
+        std::size_t offset = Uniforms::GetIntUniformOffset(instr.flow_control.int_uniform_id);
+        mov(LOOPCOUNT, dword[UNIFORMS + offset]);
+        mov(LOOPCOUNT_REG, LOOPCOUNT);
+        shr(LOOPCOUNT_REG, 4);
+        and_(LOOPCOUNT_REG, 0xFF0); // Y-component is the start
+        mov(LOOPINC, LOOPCOUNT);
+        shr(LOOPINC, 12);
+        and_(LOOPINC, 0xFF0);               // Z-component is the incrementer
+        movzx(LOOPCOUNT, LOOPCOUNT.cvt8()); // X-component is iteration count
+        add(LOOPCOUNT, 1);                  // Iteration count is X-component + 1
+    }
 
     Label l_loop_start;
     L(l_loop_start);
@@ -759,6 +833,15 @@ void JitShader::Compile_LOOP(Instruction instr) {
 }
 
 void JitShader::Compile_JMP(Instruction instr) {
+    if (instr.opcode.Value() == OpCode::Id::JMPU && uniform_constants) {
+        const bool jump = uniform_constants->b[instr.flow_control.bool_uniform_id] ==
+                          !(instr.flow_control.num_instructions & 1);
+        if (jump) {
+            jmp(instruction_labels[instr.flow_control.dest_offset], T_NEAR);
+        }
+        return;
+    }
+
     if (instr.opcode.Value() == OpCode::Id::JMPC)
         Compile_EvaluateCondition(instr);
     else if (instr.opcode.Value() == OpCode::Id::JMPU)
@@ -828,6 +911,28 @@ void JitShader::Compile_Block(unsigned end) {
     }
 }
 
+void JitShader::Compile_DeadBlock(unsigned end) {
+    if (program_counter >= end) {
+        return;
+    }
+
+    auto is_referenced = [this, end](const std::vector<unsigned>& offsets) {
+        const auto it = std::lower_bound(offsets.begin(), offsets.end(), program_counter);
+        return it != offsets.end() && *it < end;
+    };
+
+    if (!is_referenced(branch_targets) && !is_referenced(return_offsets)) {
+        program_counter = end;
+        return;
+    }
+
+    // Keep the code for the labels inside of it, but never fall through into it
+    Label skip;
+    jmp(skip, T_NEAR);
+    Compile_Block(end);
+    L(skip);
+}
+
 void JitShader::Compile_Return() {
     // Peek return offset on the stack and check if we're at that offset
     mov(rax, qword[rsp + 8]);
@@ -864,16 +969,31 @@ void JitShader::Compile_NextInstr() {
 
 void JitShader::FindReturnOffsets() {
     return_offsets.clear();
+    branch_targets.clear();
+    uses_uniform_flow_control = false;
 
     for (std::size_t offset = 0; offset < program_code->size(); ++offset) {
         Instruction instr = {(*program_code)[offset]};
 
         switch (instr.opcode.Value()) {
+        case OpCode::Id::CALLU:
+            uses_uniform_flow_control = true;
+            [[fallthrough]];
         case OpCode::Id::CALL:
         case OpCode::Id::CALLC:
-        case OpCode::Id::CALLU:
             return_offsets.push_back(instr.flow_control.dest_offset +
                                      instr.flow_control.num_instructions);
+            branch_targets.push_back(instr.flow_control.dest_offset);
+            break;
+        case OpCode::Id::JMPU:
+            uses_uniform_flow_control = true;
+            [[fallthrough]];
+        case OpCode::Id::JMPC:
+            branch_targets.push_back(instr.flow_control.dest_offset);
+            break;
+        case OpCode::Id::IFU:
+        case OpCode::Id::LOOP:
+            uses_uniform_flow_control = true;
             break;
         default:
             break;
@@ -882,12 +1002,15 @@ void JitShader::FindReturnOffsets() {
 
     // Sort for efficient binary search later
     std::sort(return_offsets.begin(), return_offsets.end());
+    std::sort(branch_targets.begin(), branch_targets.end());
 }
 
 void JitShader::Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code_,
-                        const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data_) {
+                        const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data_,
+                        const Uniforms* uniform_constants_, unsigned entry_point) {
     program_code = program_code_;
     swizzle_data = swizzle_data_;
+    uniform_constants = uniform_constants_;
 
     // Reset flow control state
     program = (CompiledShader*)getCurr();
@@ -898,6 +1021,14 @@ void JitShader::Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_
     // Find all `CALL` instructions and identify return locations
     FindReturnOffsets();
 
+    // Run jumps to the label of the entry point, so its code must be kept even if the uniforms
+    // make it unreachable from the start of the program
+    if (uniform_constants) {
+        branch_targets.insert(
+            std::upper_bound(branch_targets.begin(), branch_targets.end(), entry_point),
+            entry_point);
+    }
+
     // The stack pointer is 8 modulo 16 at the entry of a procedure
     // We reserve 16 bytes and assign a dummy value to the first 8 bytes, to catch any potential
     // return checks (see Compile_Return) that happen in shader main routine.
@@ -938,8 +1069,11 @@ void JitShader::Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_
     // Free memory that's no longer needed
     program_code = nullptr;
     swizzle_data = nullptr;
+    uniform_constants = nullptr;
     return_offsets.clear();
     return_offsets.shrink_to_fit();
+    branch_targets.clear();
+    branch_targets.shrink_to_fit();
 
     ready();
 
@@ -947,10 +1081,18 @@ void JitShader::Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_
     LOG_DEBUG(HW_GPU, "Compiled shader size={}", getSize());
 }
 
-JitShader::JitShader() : Xbyak::CodeGenerator(MAX_SHADER_SIZE) {
+JitShader::JitShader() : JitShader(IsAVXTierSupported()) {}
+
+JitShader::JitShader(bool use_avx) : Xbyak::CodeGenerator(MAX_SHADER_SIZE), use_avx(use_avx) {
+    ASSERT_MSG(!use_avx || IsAVXTierSupported(), "Host CPU doesn't support AVX2");
     CompilePrelude();
 }
 
+bool JitShader::IsAVXTierSupported() {
+    const auto& caps = Common::GetCPUCaps();
+    return caps.avx2;
+}
+
 void JitShader::CompilePrelude() {
     log2_subroutine = CompilePrelude_Log2();
     exp2_subroutine = CompilePrelude_Exp2();
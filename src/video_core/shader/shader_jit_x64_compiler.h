@@ -27,17 +27,47 @@ constexpr std::size_t MAX_SHADER_SIZE = MAX_PROGRAM_CODE_LENGTH * 64;
 /**
  * This class implements the shader JIT compiler. It recompiles a Pica shader program into x86_64
  * code that can be executed on the host machine directly.
+ *
+ * The baseline code targets SSE3, with SSE4.1 used where available. On hosts with AVX2, arithmetic
+ * and register moves can instead use VEX-encoded instructions. Both produce the same results as
+ * the interpreter.
  */
 class JitShader : public Xbyak::CodeGenerator {
 public:
+    /// Creates a compiler targeting the best code tier supported by the host CPU
     JitShader();
 
+    /**
+     * Creates a compiler targeting a specific code tier.
+     * @param use_avx Whether to emit AVX2 code, which the host CPU must support
+     */
+    explicit JitShader(bool use_avx);
+
+    /// Returns true if the host CPU supports the AVX2 code tier
+    static bool IsAVXTierSupported();
+
     void Run(const ShaderSetup& setup, UnitState& state, unsigned offset) const {
         program(&setup.uniforms, &state, instruction_labels[offset].getAddress());
     }
 
+    /**
+     * Compiles a shader program.
+     * @param program_code Program code of the shader
+     * @param swizzle_data Operand descriptors of the shader
+     * @param uniform_constants If not null, the bool and integer uniforms are taken from here and
+     *        treated as constants: conditions on them are resolved while compiling, and loops get
+     *        fixed trip counts. The compiled shader is then only valid for these uniform values.
+     * @param entry_point Offset a shader specialized for uniform_constants is run from. Code that
+     *        the uniforms make unreachable is dropped, except from there.
+     */
     void Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code,
-                 const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data);
+                 const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data,
+                 const Uniforms* uniform_constants = nullptr, unsigned entry_point = 0);
+
+    /// Returns true if the compiled program has flow control that depends on bool or int uniforms
+    bool UsesUniformFlowControl() const {
+        return uses_uniform_flow_control;
+    }
 
     void Compile_ADD(Instruction instr);
     void Compile_DP3(Instruction instr);
@@ -71,6 +101,12 @@ public:
 
 private:
     void Compile_Block(unsigned end);
+
+    /**
+     * Compiles a block that can't be reached with the constant uniforms. The block is left out
+     * entirely, unless it may still be entered through a jump, a call or a subroutine return.
+     */
+    void Compile_DeadBlock(unsigned end);
     void Compile_NextInstr();
 
     void Compile_SwizzleSrc(Instruction instr, unsigned src_num, SourceRegister src_reg,
@@ -83,6 +119,13 @@ private:
      */
     void Compile_SanitizedMul(Xbyak::Xmm src1, Xbyak::Xmm src2, Xbyak::Xmm scratch);
 
+    /**
+     * Sums up the first `num_components` components of `src` into all of its components, rounding
+     * like the interpreter. Clobbers `scratch` and `scratch2`.
+     */
+    void Compile_HorizontalSum(Xbyak::Xmm src, int num_components, Xbyak::Xmm scratch,
+                               Xbyak::Xmm scratch2);
+
     void Compile_EvaluateCondition(Instruction instr);
     void Compile_UniformCondition(Instruction instr);
 
@@ -102,7 +145,8 @@ private:
 
     /**
      * Analyzes the entire shader program for `CALL` instructions before emitting any code,
-     * identifying the locations where a return needs to be inserted.
+     * identifying the locations where a return needs to be inserted. Also records the targets of
+     * all jumps and calls, and whether any flow control depends on bool or int uniforms.
      */
     void FindReturnOffsets();
 
@@ -126,9 +170,20 @@ private:
     /// Offsets in code where a return needs to be inserted
     std::vector<unsigned> return_offsets;
 
+    /// Offsets in code that are the target of a jump or a call
+    std::vector<unsigned> branch_targets;
+
+    /// Bool and int uniforms compiled in as constants, or null if they are read at run time
+    const Uniforms* uniform_constants = nullptr;
+
+    bool uses_uniform_flow_control = false;
+
     unsigned program_counter = 0; ///< Offset of the next instruction to decode
     bool looping = false;         ///< True if compiling a loop, used to check for nested loops
 
+    /// Whether AVX2 code is emitted
+    bool use_avx = false;
+
     using CompiledShader = void(const void* setup, void* state, const u8* start_addr);
     CompiledShader* program = nullptr;
 
@@ -9,11 +9,16 @@ namespace Shader {
 struct OutputVertex;
 }
 
+namespace Rasterizer {
+class DepthTileCache;
+}
+
 namespace Clipper {
 
 using Shader::OutputVertex;
 
-void ProcessTriangle(const OutputVertex& v0, const OutputVertex& v1, const OutputVertex& v2);
+void ProcessTriangle(const OutputVertex& v0, const OutputVertex& v1, const OutputVertex& v2,
+                     Rasterizer::DepthTileCache& depth_tiles);
 
 } // namespace Clipper
 } // namespace Pica
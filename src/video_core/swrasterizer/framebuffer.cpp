@@ -18,208 +18,175 @@
 
 namespace Pica::Rasterizer {
 
-void DrawPixel(int x, int y, const Common::Vec4<u8>& color) {
+namespace {
+void UnknownColorFormat() {
     const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
-    const PAddr addr = framebuffer.GetColorBufferPhysicalAddress();
+    LOG_CRITICAL(Render_Software, "Unknown framebuffer color format {:x}",
+                 static_cast<u32>(framebuffer.color_format.Value()));
+    UNIMPLEMENTED();
+}
 
-    // Similarly to textures, the render framebuffer is laid out from bottom to top, too.
-    // NOTE: The framebuffer height register contains the actual FB height minus one.
-    y = framebuffer.height - y;
+void UnknownDepthFormat() {
+    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
+    LOG_CRITICAL(HW_GPU, "Unimplemented depth format {}",
+                 static_cast<u32>(framebuffer.depth_format.Value()));
+    UNIMPLEMENTED();
+}
+} // Anonymous namespace
 
-    const u32 coarse_y = y & ~7;
-    u32 bytes_per_pixel =
+FramebufferAccessor::FramebufferAccessor(const FramebufferRegs& regs,
+                                         DepthTileCache& depth_tiles)
+    : depth_tiles(&depth_tiles) {
+    const auto& framebuffer = regs.framebuffer;
+    height = framebuffer.height;
+
+    color_buffer =
+        VideoCore::g_memory->GetPhysicalPointer(framebuffer.GetColorBufferPhysicalAddress());
+    color_bytes_per_pixel =
         GPU::Regs::BytesPerPixel(GPU::Regs::PixelFormat(framebuffer.color_format.Value()));
-    u32 dst_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) +
-                     coarse_y * framebuffer.width * bytes_per_pixel;
-    u8* dst_pixel = VideoCore::g_memory->GetPhysicalPointer(addr) + dst_offset;
+    color_row_stride = framebuffer.width * color_bytes_per_pixel;
 
     switch (framebuffer.color_format) {
     case FramebufferRegs::ColorFormat::RGBA8:
-        Color::EncodeRGBA8(color, dst_pixel);
+        decode_color = Color::DecodeRGBA8;
+        encode_color = Color::EncodeRGBA8;
         break;
 
     case FramebufferRegs::ColorFormat::RGB8:
-        Color::EncodeRGB8(color, dst_pixel);
+        decode_color = Color::DecodeRGB8;
+        encode_color = Color::EncodeRGB8;
         break;
 
     case FramebufferRegs::ColorFormat::RGB5A1:
-        Color::EncodeRGB5A1(color, dst_pixel);
+        decode_color = Color::DecodeRGB5A1;
+        encode_color = Color::EncodeRGB5A1;
         break;
 
     case FramebufferRegs::ColorFormat::RGB565:
-        Color::EncodeRGB565(color, dst_pixel);
+        decode_color = Color::DecodeRGB565;
+        encode_color = Color::EncodeRGB565;
         break;
 
     case FramebufferRegs::ColorFormat::RGBA4:
-        Color::EncodeRGBA4(color, dst_pixel);
+        decode_color = Color::DecodeRGBA4;
+        encode_color = Color::EncodeRGBA4;
         break;
 
     default:
-        LOG_CRITICAL(Render_Software, "Unknown framebuffer color format {:x}",
-                     static_cast<u32>(framebuffer.color_format.Value()));
-        UNIMPLEMENTED();
-    }
-}
-
-const Common::Vec4<u8> GetPixel(int x, int y) {
-    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
-    const PAddr addr = framebuffer.GetColorBufferPhysicalAddress();
-
-    y = framebuffer.height - y;
-
-    const u32 coarse_y = y & ~7;
-    u32 bytes_per_pixel =
-        GPU::Regs::BytesPerPixel(GPU::Regs::PixelFormat(framebuffer.color_format.Value()));
-    u32 src_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) +
-                     coarse_y * framebuffer.width * bytes_per_pixel;
-    u8* src_pixel = VideoCore::g_memory->GetPhysicalPointer(addr) + src_offset;
-
-    switch (framebuffer.color_format) {
-    case FramebufferRegs::ColorFormat::RGBA8:
-        return Color::DecodeRGBA8(src_pixel);
-
-    case FramebufferRegs::ColorFormat::RGB8:
-        return Color::DecodeRGB8(src_pixel);
-
-    case FramebufferRegs::ColorFormat::RGB5A1:
-        return Color::DecodeRGB5A1(src_pixel);
-
-    case FramebufferRegs::ColorFormat::RGB565:
-        return Color::DecodeRGB565(src_pixel);
-
-    case FramebufferRegs::ColorFormat::RGBA4:
-        return Color::DecodeRGBA4(src_pixel);
-
-    default:
-        LOG_CRITICAL(Render_Software, "Unknown framebuffer color format {:x}",
-                     static_cast<u32>(framebuffer.color_format.Value()));
-        UNIMPLEMENTED();
-    }
-
-    return {0, 0, 0, 0};
-}
-
-u32 GetDepth(int x, int y) {
-    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
-    const PAddr addr = framebuffer.GetDepthBufferPhysicalAddress();
-    u8* depth_buffer = VideoCore::g_memory->GetPhysicalPointer(addr);
-
-    y = framebuffer.height - y;
-
-    const u32 coarse_y = y & ~7;
-    u32 bytes_per_pixel = FramebufferRegs::BytesPerDepthPixel(framebuffer.depth_format);
-    u32 stride = framebuffer.width * bytes_per_pixel;
-
-    u32 src_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) + coarse_y * stride;
-    u8* src_pixel = depth_buffer + src_offset;
-
-    switch (framebuffer.depth_format) {
-    case FramebufferRegs::DepthFormat::D16:
-        return Color::DecodeD16(src_pixel);
-    case FramebufferRegs::DepthFormat::D24:
-        return Color::DecodeD24(src_pixel);
-    case FramebufferRegs::DepthFormat::D24S8:
-        return Color::DecodeD24S8(src_pixel).x;
-    default:
-        LOG_CRITICAL(HW_GPU, "Unimplemented depth format {}",
-                     static_cast<u32>(framebuffer.depth_format.Value()));
-        UNIMPLEMENTED();
-        return 0;
-    }
-}
-
-u8 GetStencil(int x, int y) {
-    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
-    const PAddr addr = framebuffer.GetDepthBufferPhysicalAddress();
-    u8* depth_buffer = VideoCore::g_memory->GetPhysicalPointer(addr);
-
-    y = framebuffer.height - y;
-
-    const u32 coarse_y = y & ~7;
-    u32 bytes_per_pixel = Pica::FramebufferRegs::BytesPerDepthPixel(framebuffer.depth_format);
-    u32 stride = framebuffer.width * bytes_per_pixel;
-
-    u32 src_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) + coarse_y * stride;
-    u8* src_pixel = depth_buffer + src_offset;
-
-    switch (framebuffer.depth_format) {
-    case FramebufferRegs::DepthFormat::D24S8:
-        return Color::DecodeD24S8(src_pixel).y;
-
-    default:
-        LOG_WARNING(
-            HW_GPU,
-            "GetStencil called for function which doesn't have a stencil component (format {})",
-            static_cast<u32>(framebuffer.depth_format.Value()));
-        return 0;
+        // Only complain once the buffer is actually accessed, the color buffer may be unused
+        decode_color = [](const u8*) {
+            UnknownColorFormat();
+            return Common::Vec4<u8>{0, 0, 0, 0};
+        };
+        encode_color = [](const Common::Vec4<u8>&, u8*) { UnknownColorFormat(); };
+        break;
     }
-}
 
-void SetDepth(int x, int y, u32 value) {
-    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
-    const PAddr addr = framebuffer.GetDepthBufferPhysicalAddress();
-    u8* depth_buffer = VideoCore::g_memory->GetPhysicalPointer(addr);
-
-    y = framebuffer.height - y;
-
-    const u32 coarse_y = y & ~7;
-    u32 bytes_per_pixel = FramebufferRegs::BytesPerDepthPixel(framebuffer.depth_format);
-    u32 stride = framebuffer.width * bytes_per_pixel;
-
-    u32 dst_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) + coarse_y * stride;
-    u8* dst_pixel = depth_buffer + dst_offset;
+    // The depth buffer address is left unresolved if the output merger doesn't access it, as it
+    // may be anything in that case
+    const auto& output_merger = regs.output_merger;
+    const bool uses_depth_buffer =
+        output_merger.depth_test_enable || output_merger.stencil_test.enable ||
+        (output_merger.depth_write_enable && framebuffer.allow_depth_stencil_write != 0);
+    depth_buffer = uses_depth_buffer ? VideoCore::g_memory->GetPhysicalPointer(
+                                           framebuffer.GetDepthBufferPhysicalAddress())
+                                     : nullptr;
+    has_stencil = false;
 
     switch (framebuffer.depth_format) {
     case FramebufferRegs::DepthFormat::D16:
-        Color::EncodeD16(value, dst_pixel);
+        depth_bytes_per_pixel = 2;
+        decode_depth = Color::DecodeD16;
+        encode_depth = Color::EncodeD16;
         break;
 
     case FramebufferRegs::DepthFormat::D24:
-        Color::EncodeD24(value, dst_pixel);
+        depth_bytes_per_pixel = 3;
+        decode_depth = Color::DecodeD24;
+        encode_depth = Color::EncodeD24;
         break;
 
     case FramebufferRegs::DepthFormat::D24S8:
-        Color::EncodeD24X8(value, dst_pixel);
+        depth_bytes_per_pixel = 4;
+        decode_depth = [](const u8* pixel) { return Color::DecodeD24S8(pixel).x; };
+        encode_depth = Color::EncodeD24X8;
+        has_stencil = true;
         break;
 
     default:
-        LOG_CRITICAL(HW_GPU, "Unimplemented depth format {}",
-                     static_cast<u32>(framebuffer.depth_format.Value()));
-        UNIMPLEMENTED();
+        depth_bytes_per_pixel = 0;
+        decode_depth = [](const u8*) {
+            UnknownDepthFormat();
+            return 0u;
+        };
+        encode_depth = [](u32, u8*) { UnknownDepthFormat(); };
         break;
     }
+    depth_row_stride = framebuffer.width * depth_bytes_per_pixel;
 }
 
-void SetStencil(int x, int y, u8 value) {
-    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
-    const PAddr addr = framebuffer.GetDepthBufferPhysicalAddress();
-    u8* depth_buffer = VideoCore::g_memory->GetPhysicalPointer(addr);
+void FramebufferAccessor::EncodeDepth(int x, int y, u32 value, u8* pixel) const {
+    depth_tiles->Update(x, y, value);
+    encode_depth(value, pixel);
+}
 
-    y = framebuffer.height - y;
+const DepthTileRange* DepthTileCache::GetRange(const FramebufferAccessor& framebuffer, int x,
+                                               int y) {
+    DepthTile* tile = GetTile(x, y);
+    if (tile == nullptr) {
+        return nullptr;
+    }
 
-    const u32 coarse_y = y & ~7;
-    u32 bytes_per_pixel = Pica::FramebufferRegs::BytesPerDepthPixel(framebuffer.depth_format);
-    u32 stride = framebuffer.width * bytes_per_pixel;
+    if (tile->epoch != epoch) {
+        const int tile_x = x - x % DEPTH_TILE_SIZE;
+        const int tile_y = y - y % DEPTH_TILE_SIZE;
+        u32 min = 0xFFFFFFFF;
+        u32 max = 0;
+        for (int pixel_y = tile_y; pixel_y < tile_y + DEPTH_TILE_SIZE; ++pixel_y) {
+            for (int pixel_x = tile_x; pixel_x < tile_x + DEPTH_TILE_SIZE; ++pixel_x) {
+                const u32 depth =
+                    framebuffer.DecodeDepth(framebuffer.GetDepthAddress(pixel_x, pixel_y));
+                min = std::min(min, depth);
+                max = std::max(max, depth);
+            }
+        }
+        tile->range = {min, max};
+        tile->epoch = epoch;
+    }
+    return &tile->range;
+}
 
-    u32 dst_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) + coarse_y * stride;
-    u8* dst_pixel = depth_buffer + dst_offset;
+void DepthTileCache::Update(int x, int y, u32 depth) {
+    // Tiles that aren't loaded are read in full when they are next needed
+    if (DepthTile* tile = GetTile(x, y); tile != nullptr && tile->epoch == epoch) {
+        tile->range.min = std::min(tile->range.min, depth);
+        tile->range.max = std::max(tile->range.max, depth);
+    }
+}
 
-    switch (framebuffer.depth_format) {
-    case Pica::FramebufferRegs::DepthFormat::D16:
-    case Pica::FramebufferRegs::DepthFormat::D24:
-        // Nothing to do
-        break;
+void DepthTileCache::Invalidate() {
+    if (++epoch == 0) {
+        // Tiles tagged with an epoch from before the wrap-around would look valid again
+        tiles.clear();
+        epoch = 1;
+    }
+}
 
-    case Pica::FramebufferRegs::DepthFormat::D24S8:
-        Color::EncodeX24S8(value, dst_pixel);
-        break;
+DepthTileCache::DepthTile* DepthTileCache::GetTile(int x, int y) {
+    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
+    const int tiles_per_row = framebuffer.width / DEPTH_TILE_SIZE;
+    const int tiles_per_column = (framebuffer.height + 1) / DEPTH_TILE_SIZE;
+    const int tile_x = x / DEPTH_TILE_SIZE;
+    const int tile_y = y / DEPTH_TILE_SIZE;
+    if (x < 0 || y < 0 || tile_x >= tiles_per_row || tile_y >= tiles_per_column) {
+        return nullptr;
+    }
 
-    default:
-        LOG_CRITICAL(HW_GPU, "Unimplemented depth format {}",
-                     static_cast<u32>(framebuffer.depth_format.Value()));
-        UNIMPLEMENTED();
-        break;
+    const std::size_t index = tile_y * tiles_per_row + tile_x;
+    if (index >= tiles.size()) {
+        tiles.resize(tiles_per_row * tiles_per_column, DepthTile{{0, 0}, 0});
     }
+    return &tiles[index];
 }
 
 u8 PerformStencilAction(FramebufferRegs::StencilAction action, u8 old_stencil, u8 ref) {
@@ -4,18 +4,175 @@
 
 #pragma once
 
+#include <vector>
+#include "common/color.h"
 #include "common/common_types.h"
 #include "common/vector_math.h"
 #include "video_core/regs_framebuffer.h"
+#include "video_core/utils.h"
 
 namespace Pica::Rasterizer {
 
-void DrawPixel(int x, int y, const Common::Vec4<u8>& color);
-const Common::Vec4<u8> GetPixel(int x, int y);
-u32 GetDepth(int x, int y);
-u8 GetStencil(int x, int y);
-void SetDepth(int x, int y, u32 value);
-void SetStencil(int x, int y, u8 value);
+class DepthTileCache;
+
+/**
+ * Accessor for the color and depth buffers configured in the framebuffer registers. Buffer
+ * addresses and pixel formats are resolved once on construction, so the rasterizer creates one
+ * per triangle instead of looking them up and switching on the formats for every pixel access.
+ * Pixels are addressed once and then decoded and encoded in place, which lets read-modify-write
+ * operations like blending touch the address computation only once.
+ */
+class FramebufferAccessor {
+public:
+    /**
+     * @param regs Framebuffer configuration to access
+     * @param depth_tiles Coarse depth buffer that depth writes are reported to
+     */
+    FramebufferAccessor(const FramebufferRegs& regs, DepthTileCache& depth_tiles);
+
+    /**
+     * Position of a pixel in the buffers, which are tiled in 8x8 Morton-ordered blocks. It is
+     * split into the offsets of the row, which the rasterizer computes once per row, and an index
+     * along the row that steps to the next pixel without recomputing the Morton order.
+     */
+    struct PixelPosition {
+        /// Offset of the tile in the row of tiles, in pixels, plus the x bits of the Morton index
+        u32 x_index;
+        /// Offset of the row of tiles plus the y bits of the Morton index, in bytes
+        u32 color_row_offset;
+        u32 depth_row_offset;
+
+        /// Moves to the pixel on the right
+        void StepX() {
+            // Setting the y bits carries the increment over them, and from the last column of a
+            // tile over to the next tile
+            x_index = ((x_index | MORTON_Y_BITS) + 1) & ~MORTON_Y_BITS;
+        }
+    };
+
+    PixelPosition GetPixelPosition(int x, int y) const {
+        // Similarly to textures, the render framebuffer is laid out from bottom to top, too.
+        // NOTE: The framebuffer height register contains the actual FB height minus one.
+        const u32 flipped_y = height - y;
+        const u32 y_bits = VideoCore::MortonInterleave(0, flipped_y);
+        return {(static_cast<u32>(x) & ~7u) * 8 + VideoCore::MortonInterleave(x, 0),
+                (flipped_y & ~7u) * color_row_stride + y_bits * color_bytes_per_pixel,
+                (flipped_y & ~7u) * depth_row_stride + y_bits * depth_bytes_per_pixel};
+    }
+
+    /// Returns the address of a pixel of the color buffer
+    u8* GetColorAddress(const PixelPosition& position) const {
+        return color_buffer + position.color_row_offset + position.x_index * color_bytes_per_pixel;
+    }
+
+    u8* GetColorAddress(int x, int y) const {
+        return GetColorAddress(GetPixelPosition(x, y));
+    }
+
+    /// Returns the address of a pixel of the depth-stencil buffer
+    u8* GetDepthAddress(const PixelPosition& position) const {
+        return depth_buffer + position.depth_row_offset + position.x_index * depth_bytes_per_pixel;
+    }
+
+    u8* GetDepthAddress(int x, int y) const {
+        return GetDepthAddress(GetPixelPosition(x, y));
+    }
+
+    Common::Vec4<u8> DecodeColor(const u8* pixel) const {
+        return decode_color(pixel);
+    }
+
+    void EncodeColor(const Common::Vec4<u8>& color, u8* pixel) const {
+        encode_color(color, pixel);
+    }
+
+    u32 DecodeDepth(const u8* pixel) const {
+        return decode_depth(pixel);
+    }
+
+    /// Writes the depth of a pixel at the given address, keeping the coarse depth tiles in sync
+    void EncodeDepth(int x, int y, u32 value, u8* pixel) const;
+
+    /// Returns the stencil value of a pixel, or 0 if the depth format has no stencil component
+    u8 DecodeStencil(const u8* pixel) const {
+        return has_stencil ? static_cast<u8>(Color::DecodeD24S8(pixel).y) : 0;
+    }
+
+    /// Writes the stencil value of a pixel. Does nothing if the depth format has no stencil.
+    void EncodeStencil(u8 value, u8* pixel) const {
+        if (has_stencil) {
+            Color::EncodeX24S8(value, pixel);
+        }
+    }
+
+private:
+    /// Bits of a Morton index within a tile that come from the y coordinate
+    static constexpr u32 MORTON_Y_BITS = 0x2A;
+
+    u32 height;
+
+    u8* color_buffer;
+    u32 color_bytes_per_pixel;
+    /// Size in bytes of one row of pixels of the color buffer
+    u32 color_row_stride;
+    Common::Vec4<u8> (*decode_color)(const u8*);
+    void (*encode_color)(const Common::Vec4<u8>&, u8*);
+
+    u8* depth_buffer;
+    u32 depth_bytes_per_pixel;
+    /// Size in bytes of one row of pixels of the depth-stencil buffer
+    u32 depth_row_stride;
+    u32 (*decode_depth)(const u8*);
+    void (*encode_depth)(u32, u8*);
+    bool has_stencil;
+
+    DepthTileCache* depth_tiles;
+};
+
+/// Width and height in pixels of the tiles tracked by the coarse depth buffer
+constexpr int DEPTH_TILE_SIZE = 8;
+
+/// Conservative range of the depth values stored in a tile of the depth buffer
+struct DepthTileRange {
+    u32 min;
+    u32 max;
+};
+
+/**
+ * Coarse depth buffer of the software rasterizer, holding the depth range of each tile of the
+ * depth buffer. A range is read from the depth buffer the first time its tile is accessed after
+ * Invalidate, and depth writes made through FramebufferAccessor::EncodeDepth keep it up to date.
+ */
+class DepthTileCache {
+public:
+    /**
+     * Returns the depth range of the tile containing the given pixel.
+     * @returns The range, or nullptr if the tile isn't fully inside the framebuffer
+     */
+    const DepthTileRange* GetRange(const FramebufferAccessor& framebuffer, int x, int y);
+
+    /// Widens the range of the tile containing the given pixel to a depth written to it
+    void Update(int x, int y, u32 depth);
+
+    /// Forgets all tile ranges. Must be called whenever the depth buffer or the framebuffer
+    /// configuration may have changed without going through FramebufferAccessor::EncodeDepth.
+    void Invalidate();
+
+private:
+    struct DepthTile {
+        DepthTileRange range;
+        /// Value of epoch when the range was read, the range is stale if they differ
+        u32 epoch;
+    };
+
+    /// Returns the tile containing the pixel, or nullptr if the tile isn't fully inside the
+    /// framebuffer
+    DepthTile* GetTile(int x, int y);
+
+    std::vector<DepthTile> tiles;
+    u32 epoch = 1;
+};
+
 u8 PerformStencilAction(FramebufferRegs::StencilAction action, u8 old_stencil, u8 ref);
 
 Common::Vec4<u8> EvaluateBlendEquation(const Common::Vec4<u8>& src,
@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <limits>
 #include <tuple>
 #include "common/assert.h"
 #include "common/bit_field.h"
@@ -124,7 +125,7 @@ MICROPROFILE_DEFINE(GPU_Rasterization, "GPU", "Rasterization", MP_RGB(50, 50, 24
  * culling via recursion.
  */
 static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Vertex& v2,
-                                    bool reversed = false) {
+                                    DepthTileCache& depth_tiles, bool reversed = false) {
     const auto& regs = g_state.regs;
     MICROPROFILE_SCOPE(GPU_Rasterization);
 
@@ -145,13 +146,13 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
     if (regs.rasterizer.cull_mode == RasterizerRegs::CullMode::KeepAll) {
         // Make sure we always end up with a triangle wound counter-clockwise
         if (!reversed && SignedArea(vtxpos[0].xy(), vtxpos[1].xy(), vtxpos[2].xy()) <= 0) {
-            ProcessTriangleInternal(v0, v2, v1, true);
+            ProcessTriangleInternal(v0, v2, v1, depth_tiles, true);
             return;
         }
     } else {
         if (!reversed && regs.rasterizer.cull_mode == RasterizerRegs::CullMode::KeepClockWise) {
             // Reverse vertex order and use the CCW code path.
-            ProcessTriangleInternal(v0, v2, v1, true);
+            ProcessTriangleInternal(v0, v2, v1, depth_tiles, true);
             return;
         }
 
@@ -220,10 +221,221 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
         g_state.regs.framebuffer.framebuffer.depth_format == FramebufferRegs::DepthFormat::D24S8;
     const auto stencil_test = g_state.regs.framebuffer.output_merger.stencil_test;
 
+    const auto& output_merger = regs.framebuffer.output_merger;
+    const FramebufferAccessor framebuffer{regs.framebuffer, depth_tiles};
+    const u32 depth_max =
+        (1u << FramebufferRegs::DepthBitsPerPixel(regs.framebuffer.framebuffer.depth_format)) - 1;
+
+    // Performs the stencil and depth tests and their buffer updates for a fragment. Returns false
+    // if the fragment is discarded.
+    auto TestDepthStencil = [&](u16 x, u16 y, const FramebufferAccessor::PixelPosition& position,
+                                float depth) -> bool {
+        u8* const depth_pixel = framebuffer.GetDepthAddress(position);
+        u8 old_stencil = 0;
+
+        auto UpdateStencil = [stencil_test, depth_pixel, &framebuffer,
+                              &old_stencil](Pica::FramebufferRegs::StencilAction action) {
+            u8 new_stencil =
+                PerformStencilAction(action, old_stencil, stencil_test.reference_value);
+            if (g_state.regs.framebuffer.framebuffer.allow_depth_stencil_write != 0)
+                framebuffer.EncodeStencil((new_stencil & stencil_test.write_mask) |
+                                              (old_stencil & ~stencil_test.write_mask),
+                                          depth_pixel);
+        };
+
+        if (stencil_action_enable) {
+            old_stencil = framebuffer.DecodeStencil(depth_pixel);
+            u8 dest = old_stencil & stencil_test.input_mask;
+            u8 ref = stencil_test.reference_value & stencil_test.input_mask;
+
+            bool pass = false;
+            switch (stencil_test.func) {
+            case FramebufferRegs::CompareFunc::Never:
+                pass = false;
+                break;
+
+            case FramebufferRegs::CompareFunc::Always:
+                pass = true;
+                break;
+
+            case FramebufferRegs::CompareFunc::Equal:
+                pass = (ref == dest);
+                break;
+
+            case FramebufferRegs::CompareFunc::NotEqual:
+                pass = (ref != dest);
+                break;
+
+            case FramebufferRegs::CompareFunc::LessThan:
+                pass = (ref < dest);
+                break;
+
+            case FramebufferRegs::CompareFunc::LessThanOrEqual:
+                pass = (ref <= dest);
+                break;
+
+            case FramebufferRegs::CompareFunc::GreaterThan:
+                pass = (ref > dest);
+                break;
+
+            case FramebufferRegs::CompareFunc::GreaterThanOrEqual:
+                pass = (ref >= dest);
+                break;
+            }
+
+            if (!pass) {
+                UpdateStencil(stencil_test.action_stencil_fail);
+                return false;
+            }
+        }
+
+        // Convert float to integer
+        u32 z = (u32)(depth * depth_max);
+
+        if (output_merger.depth_test_enable) {
+            u32 ref_z = framebuffer.DecodeDepth(depth_pixel);
+
+            bool pass = false;
+
+            switch (output_merger.depth_test_func) {
+            case FramebufferRegs::CompareFunc::Never:
+                pass = false;
+                break;
+
+            case FramebufferRegs::CompareFunc::Always:
+                pass = true;
+                break;
+
+            case FramebufferRegs::CompareFunc::Equal:
+                pass = z == ref_z;
+                break;
+
+            case FramebufferRegs::CompareFunc::NotEqual:
+                pass = z != ref_z;
+                break;
+
+            case FramebufferRegs::CompareFunc::LessThan:
+                pass = z < ref_z;
+                break;
+
+            case FramebufferRegs::CompareFunc::LessThanOrEqual:
+                pass = z <= ref_z;
+                break;
+
+            case FramebufferRegs::CompareFunc::GreaterThan:
+                pass = z > ref_z;
+                break;
+
+            case FramebufferRegs::CompareFunc::GreaterThanOrEqual:
+                pass = z >= ref_z;
+                break;
+            }
+
+            if (!pass) {
+                if (stencil_action_enable)
+                    UpdateStencil(stencil_test.action_depth_fail);
+                return false;
+            }
+        }
+
+        if (regs.framebuffer.framebuffer.allow_depth_stencil_write != 0 &&
+            output_merger.depth_write_enable) {
+
+            framebuffer.EncodeDepth(x >> 4, y >> 4, z, depth_pixel);
+        }
+
+        // The stencil depth_pass action is executed even if depth testing is disabled
+        if (stencil_action_enable)
+            UpdateStencil(stencil_test.action_depth_pass);
+
+        return true;
+    };
+
+    // Shading has no side effects on the framebuffer, so unless the alpha test can discard a
+    // fragment after shading, testing depth and stencil first gives the same result while
+    // skipping the shading of hidden fragments.
+    const bool early_depth_stencil =
+        output_merger.fragment_operation_mode == FramebufferRegs::FragmentOperationMode::Default &&
+        (!output_merger.alpha_test.enable ||
+         output_merger.alpha_test.func == FramebufferRegs::CompareFunc::Always);
+
+    // Whole tiles of the coarse depth buffer can be skipped when the depth range of the triangle
+    // fails the depth test against every value in the tile, as long as the failing fragments
+    // wouldn't update the stencil buffer either. The depth of a fragment is interpolated between
+    // the vertex depths, which bound it up to rounding; W-buffering isn't linear and isn't handled.
+    bool use_depth_tiles =
+        output_merger.fragment_operation_mode == FramebufferRegs::FragmentOperationMode::Default &&
+        output_merger.depth_test_enable &&
+        regs.rasterizer.depthmap_enable != RasterizerRegs::DepthBuffering::WBuffering &&
+        (!stencil_action_enable ||
+         (stencil_test.action_stencil_fail == FramebufferRegs::StencilAction::Keep &&
+          stencil_test.action_depth_fail == FramebufferRegs::StencilAction::Keep));
+
+    u32 triangle_depth_min = 0;
+    u32 triangle_depth_max = 0;
+    if (use_depth_tiles) {
+        const float depth_scale =
+            float24::FromRaw(regs.rasterizer.viewport_depth_range).ToFloat32();
+        const float depth_offset =
+            float24::FromRaw(regs.rasterizer.viewport_depth_near_plane).ToFloat32();
+        auto VertexDepth = [&](const Vertex& v) {
+            const float depth =
+                std::clamp(v.screenpos[2].ToFloat32() * depth_scale + depth_offset, 0.0f, 1.0f);
+            return static_cast<u32>(depth * depth_max);
+        };
+        const u32 z0 = VertexDepth(v0);
+        const u32 z1 = VertexDepth(v1);
+        const u32 z2 = VertexDepth(v2);
+
+        // The interpolated z / w is a convex combination of the vertex values, computed with about
+        // seven float32 roundings, each off by at most half an epsilon of the largest magnitude
+        // involved. Scaling and offsetting it, and the vertex values, adds a few more. Eight
+        // epsilons of the magnitude of the unclamped depths bound the total error with margin,
+        // plus one unit for each side's rounding of the conversion to integers.
+        const float z_magnitude = std::max({std::abs(v0.screenpos[2].ToFloat32()),
+                                            std::abs(v1.screenpos[2].ToFloat32()),
+                                            std::abs(v2.screenpos[2].ToFloat32())});
+        const float depth_error = 8 * std::numeric_limits<float>::epsilon() *
+                                  (std::abs(depth_scale) * z_magnitude + std::abs(depth_offset));
+        const float depth_slack = std::ceil(depth_error * depth_max) + 2;
+
+        // Nothing can be skipped when the error spans the whole range, which also catches
+        // infinite and NaN depths
+        if (depth_slack < depth_max) {
+            const u32 slack = static_cast<u32>(depth_slack);
+            triangle_depth_min = std::max(std::min({z0, z1, z2}), slack) - slack;
+            triangle_depth_max = std::max({z0, z1, z2}) + slack;
+        } else {
+            use_depth_tiles = false;
+        }
+    }
+
+    auto IsTileOccluded = [&](int x, int y) {
+        const DepthTileRange* range = depth_tiles.GetRange(framebuffer, x, y);
+        if (range == nullptr)
+            return false;
+
+        switch (output_merger.depth_test_func) {
+        case FramebufferRegs::CompareFunc::Never:
+            return true;
+        case FramebufferRegs::CompareFunc::LessThan:
+            return triangle_depth_min >= range->max;
+        case FramebufferRegs::CompareFunc::LessThanOrEqual:
+            return triangle_depth_min > range->max;
+        case FramebufferRegs::CompareFunc::GreaterThan:
+            return triangle_depth_max <= range->min;
+        case FramebufferRegs::CompareFunc::GreaterThanOrEqual:
+            return triangle_depth_max < range->min;
+        default:
+            return false;
+        }
+    };
+
     // Enter rasterization loop, starting at the center of the topleft bounding box corner.
     // TODO: Not sure if looping through x first might be faster
     for (u16 y = min_y + 8; y < max_y; y += 0x10) {
-        for (u16 x = min_x + 8; x < max_x; x += 0x10) {
+        auto position = framebuffer.GetPixelPosition((min_x + 8) >> 4, y >> 4);
+        for (u16 x = min_x + 8; x < max_x; x += 0x10, position.StepX()) {
 
             // Do not process the pixel if it's inside the scissor box and the scissor mode is set
             // to Exclude
@@ -242,6 +454,18 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
             if (w0 < 0 || w1 < 0 || w2 < 0)
                 continue;
 
+            // Only tiles the triangle covers are tested, so that the parts of the bounding box
+            // outside of it never load their tile range from the depth buffer
+            if (use_depth_tiles && IsTileOccluded(x >> 4, y >> 4)) {
+                // Skip the rest of the tile on this row
+                const int next_x = (((x >> 4) | (DEPTH_TILE_SIZE - 1)) + 1) * 0x10 + 8;
+                if (next_x >= max_x)
+                    break;
+                x = static_cast<u16>(next_x - 0x10);
+                position = framebuffer.GetPixelPosition(x >> 4, y >> 4);
+                continue;
+            }
+
             auto baricentric_coordinates =
                 Common::MakeVec(float24::FromFloat32(static_cast<float>(w0)),
                                 float24::FromFloat32(static_cast<float>(w1)),
@@ -272,6 +496,9 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
             // Clamp the result
             depth = std::clamp(depth, 0.0f, 1.0f);
 
+            if (early_depth_stencil && !TestDepthStencil(x, y, position, depth))
+                continue;
+
             // Perspective correct attribute interpolation:
             // Attribute values cannot be calculated by simple linear interpolation since
             // they are not linear in screen space. For example, when interpolating a
@@ -574,8 +801,6 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
                 }
             }
 
-            const auto& output_merger = regs.framebuffer.output_merger;
-
             if (output_merger.fragment_operation_mode ==
                 FramebufferRegs::FragmentOperationMode::Shadow) {
                 u32 depth_int = static_cast<u32>(depth * 0xFFFFFF);
@@ -661,126 +886,12 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
                 }
             }
 
-            u8 old_stencil = 0;
-
-            auto UpdateStencil = [stencil_test, x, y,
-                                  &old_stencil](Pica::FramebufferRegs::StencilAction action) {
-                u8 new_stencil =
-                    PerformStencilAction(action, old_stencil, stencil_test.reference_value);
-                if (g_state.regs.framebuffer.framebuffer.allow_depth_stencil_write != 0)
-                    SetStencil(x >> 4, y >> 4,
-                               (new_stencil & stencil_test.write_mask) |
-                                   (old_stencil & ~stencil_test.write_mask));
-            };
-
-            if (stencil_action_enable) {
-                old_stencil = GetStencil(x >> 4, y >> 4);
-                u8 dest = old_stencil & stencil_test.input_mask;
-                u8 ref = stencil_test.reference_value & stencil_test.input_mask;
-
-                bool pass = false;
-                switch (stencil_test.func) {
-                case FramebufferRegs::CompareFunc::Never:
-                    pass = false;
-                    break;
-
-                case FramebufferRegs::CompareFunc::Always:
-                    pass = true;
-                    break;
-
-                case FramebufferRegs::CompareFunc::Equal:
-                    pass = (ref == dest);
-                    break;
-
-                case FramebufferRegs::CompareFunc::NotEqual:
-                    pass = (ref != dest);
-                    break;
-
-                case FramebufferRegs::CompareFunc::LessThan:
-                    pass = (ref < dest);
-                    break;
-
-                case FramebufferRegs::CompareFunc::LessThanOrEqual:
-                    pass = (ref <= dest);
-                    break;
-
-                case FramebufferRegs::CompareFunc::GreaterThan:
-                    pass = (ref > dest);
-                    break;
-
-                case FramebufferRegs::CompareFunc::GreaterThanOrEqual:
-                    pass = (ref >= dest);
-                    break;
-                }
-
-                if (!pass) {
-                    UpdateStencil(stencil_test.action_stencil_fail);
-                    continue;
-                }
-            }
-
-            // Convert float to integer
-            unsigned num_bits =
-                FramebufferRegs::DepthBitsPerPixel(regs.framebuffer.framebuffer.depth_format);
-            u32 z = (u32)(depth * ((1 << num_bits) - 1));
-
-            if (output_merger.depth_test_enable) {
-                u32 ref_z = GetDepth(x >> 4, y >> 4);
-
-                bool pass = false;
-
-                switch (output_merger.depth_test_func) {
-                case FramebufferRegs::CompareFunc::Never:
-                    pass = false;
-                    break;
-
-                case FramebufferRegs::CompareFunc::Always:
-                    pass = true;
-                    break;
-
-                case FramebufferRegs::CompareFunc::Equal:
-                    pass = z == ref_z;
-                    break;
-
-                case FramebufferRegs::CompareFunc::NotEqual:
-                    pass = z != ref_z;
-                    break;
-
-                case FramebufferRegs::CompareFunc::LessThan:
-                    pass = z < ref_z;
-                    break;
-
-                case FramebufferRegs::CompareFunc::LessThanOrEqual:
-                    pass = z <= ref_z;
-                    break;
-
-                case FramebufferRegs::CompareFunc::GreaterThan:
-                    pass = z > ref_z;
-                    break;
-
-                case FramebufferRegs::CompareFunc::GreaterThanOrEqual:
-                    pass = z >= ref_z;
-                    break;
-                }
-
-                if (!pass) {
-                    if (stencil_action_enable)
-                        UpdateStencil(stencil_test.action_depth_fail);
-                    continue;
-                }
-            }
-
-            if (regs.framebuffer.framebuffer.allow_depth_stencil_write != 0 &&
-                output_merger.depth_write_enable) {
-
-                SetDepth(x >> 4, y >> 4, z);
-            }
-
-            // The stencil depth_pass action is executed even if depth testing is disabled
-            if (stencil_action_enable)
-                UpdateStencil(stencil_test.action_depth_pass);
+            if (!early_depth_stencil && !TestDepthStencil(x, y, position, depth))
+                continue;
 
-            auto dest = GetPixel(x >> 4, y >> 4);
+            // Address the pixel once for both the read and the write of the blending
+            u8* const color_pixel = framebuffer.GetColorAddress(position);
+            const auto dest = framebuffer.DecodeColor(color_pixel);
             Common::Vec4<u8> blend_output = combiner_output;
 
             if (output_merger.alphablend_enable) {
@@ -886,13 +997,14 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
             };
 
             if (regs.framebuffer.framebuffer.allow_color_write != 0)
-                DrawPixel(x >> 4, y >> 4, result);
+                framebuffer.EncodeColor(result, color_pixel);
         }
     }
 }
 
-void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2) {
-    ProcessTriangleInternal(v0, v1, v2);
+void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2,
+                     DepthTileCache& depth_tiles) {
+    ProcessTriangleInternal(v0, v1, v2, depth_tiles);
 }
 
 } // namespace Pica::Rasterizer
@@ -39,6 +39,9 @@ struct Vertex : Shader::OutputVertex {
     }
 };
 
-void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2);
+class DepthTileCache;
+
+void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2,
+                     DepthTileCache& depth_tiles);
 
 } // namespace Pica::Rasterizer
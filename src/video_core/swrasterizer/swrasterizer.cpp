@@ -2,15 +2,22 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include "video_core/shader/shader.h"
 #include "video_core/swrasterizer/clipper.h"
 #include "video_core/swrasterizer/swrasterizer.h"
 
 namespace VideoCore {
 
-void SWRasterizer::AddTriangle(const Pica::Shader::OutputVertex& v0,
-                               const Pica::Shader::OutputVertex& v1,
-                               const Pica::Shader::OutputVertex& v2) {
-    Pica::Clipper::ProcessTriangle(v0, v1, v2);
+void SWRasterizer::AddTriangles(const Pica::Shader::OutputVertex* vertices,
+                                std::size_t num_triangles) {
+    for (std::size_t i = 0; i < num_triangles; ++i, vertices += 3) {
+        Pica::Clipper::ProcessTriangle(vertices[0], vertices[1], vertices[2], depth_tiles);
+    }
+}
+
+void SWRasterizer::DrawTriangles() {
+    // The depth buffer may be cleared or written by the CPU before the next draw
+    depth_tiles.Invalidate();
 }
 
 } // namespace VideoCore
@@ -14,6 +14,9 @@
 #include "video_core/shader/shader.h"
 #include "video_core/vertex_loader.h"
 #include "video_core/video_core.h"
+#ifdef ARCHITECTURE_x86_64
+#include "video_core/vertex_loader_jit_x64.h"
+#endif // ARCHITECTURE_x86_64
 
 namespace Pica {
 
@@ -21,12 +24,12 @@ void VertexLoader::Setup(const PipelineRegs& regs) {
     ASSERT_MSG(!is_setup, "VertexLoader is not intended to be setup more than once.");
 
     const auto& attribute_config = regs.vertex_attributes;
-    num_total_attributes = attribute_config.GetNumTotalAttributes();
+    layout.num_total_attributes = attribute_config.GetNumTotalAttributes();
 
-    boost::fill(vertex_attribute_sources, 0xdeadbeef);
+    boost::fill(layout.sources, 0xdeadbeef);
 
     for (int i = 0; i < 16; i++) {
-        vertex_attribute_is_default[i] = attribute_config.IsDefaultAttribute(i);
+        layout.is_default[i] = attribute_config.IsDefaultAttribute(i);
     }
 
     // Setup attribute data from loaders
@@ -48,13 +51,10 @@ void VertexLoader::Setup(const PipelineRegs& regs) {
             if (attribute_index < 12) {
                 offset = Common::AlignUp(offset,
                                          attribute_config.GetElementSizeInBytes(attribute_index));
-                vertex_attribute_sources[attribute_index] = loader_config.data_offset + offset;
-                vertex_attribute_strides[attribute_index] =
-                    static_cast<u32>(loader_config.byte_count);
-                vertex_attribute_formats[attribute_index] =
-                    attribute_config.GetFormat(attribute_index);
-                vertex_attribute_elements[attribute_index] =
-                    attribute_config.GetNumElements(attribute_index);
+                layout.sources[attribute_index] = loader_config.data_offset + offset;
+                layout.strides[attribute_index] = static_cast<u32>(loader_config.byte_count);
+                layout.formats[attribute_index] = attribute_config.GetFormat(attribute_index);
+                layout.elements[attribute_index] = attribute_config.GetNumElements(attribute_index);
                 offset += attribute_config.GetStride(attribute_index);
             } else if (attribute_index < 16) {
                 // Attribute ids 12, 13, 14 and 15 signify 4, 8, 12 and 16-byte paddings,
@@ -68,37 +68,63 @@ void VertexLoader::Setup(const PipelineRegs& regs) {
         }
     }
 
+#ifdef ARCHITECTURE_x86_64
+    if (VideoCore::g_shader_jit_enabled) {
+        jit = &GetVertexLoaderJit(layout);
+    }
+#endif // ARCHITECTURE_x86_64
+
     is_setup = true;
 }
 
+template <bool debug>
 void VertexLoader::LoadVertex(u32 base_address, int index, int vertex,
                               Shader::AttributeBuffer& input,
                               DebugUtils::MemoryAccessTracker& memory_accesses) {
     ASSERT_MSG(is_setup, "A VertexLoader needs to be setup before loading vertices.");
 
-    for (int i = 0; i < num_total_attributes; ++i) {
-        if (vertex_attribute_elements[i] != 0) {
+#ifdef ARCHITECTURE_x86_64
+    // The compiled loader doesn't report memory accesses, leave those to the interpreter
+    if (jit && !(debug && g_debug_context->recorder)) {
+        if (!jit_pointers_valid || base_address != jit_base_address) {
+            // Each attribute array lies in a single physical memory area, which is contiguous in
+            // host memory, so resolving the start of each array once is enough.
+            for (int i = 0; i < layout.num_total_attributes; ++i) {
+                if (layout.elements[i] != 0) {
+                    jit_attribute_pointers[i] =
+                        VideoCore::g_memory->GetPhysicalPointer(base_address + layout.sources[i]);
+                }
+            }
+            jit_base_address = base_address;
+            jit_pointers_valid = true;
+        }
+        jit->LoadVertex(jit_attribute_pointers, vertex, input);
+        return;
+    }
+#endif // ARCHITECTURE_x86_64
+
+    for (int i = 0; i < layout.num_total_attributes; ++i) {
+        if (layout.elements[i] != 0) {
             // Load per-vertex data from the loader arrays
-            u32 source_addr =
-                base_address + vertex_attribute_sources[i] + vertex_attribute_strides[i] * vertex;
+            u32 source_addr = base_address + layout.sources[i] + layout.strides[i] * vertex;
 
-            if (g_debug_context && Pica::g_debug_context->recorder) {
+            if (debug && g_debug_context->recorder) {
                 memory_accesses.AddAccess(
                     source_addr,
-                    vertex_attribute_elements[i] *
-                        ((vertex_attribute_formats[i] == PipelineRegs::VertexAttributeFormat::FLOAT)
+                    layout.elements[i] *
+                        ((layout.formats[i] == PipelineRegs::VertexAttributeFormat::FLOAT)
                              ? 4
-                             : (vertex_attribute_formats[i] ==
+                             : (layout.formats[i] ==
                                 PipelineRegs::VertexAttributeFormat::SHORT)
                                    ? 2
                                    : 1));
             }
 
-            switch (vertex_attribute_formats[i]) {
+            switch (layout.formats[i]) {
             case PipelineRegs::VertexAttributeFormat::BYTE: {
                 const s8* srcdata = reinterpret_cast<const s8*>(
                     VideoCore::g_memory->GetPhysicalPointer(source_addr));
-                for (unsigned int comp = 0; comp < vertex_attribute_elements[i]; ++comp) {
+                for (unsigned int comp = 0; comp < layout.elements[i]; ++comp) {
                     input.attr[i][comp] = float24::FromFloat32(srcdata[comp]);
                 }
                 break;
@@ -106,7 +132,7 @@ void VertexLoader::LoadVertex(u32 base_address, int index, int vertex,
             case PipelineRegs::VertexAttributeFormat::UBYTE: {
                 const u8* srcdata = reinterpret_cast<const u8*>(
                     VideoCore::g_memory->GetPhysicalPointer(source_addr));
-                for (unsigned int comp = 0; comp < vertex_attribute_elements[i]; ++comp) {
+                for (unsigned int comp = 0; comp < layout.elements[i]; ++comp) {
                     input.attr[i][comp] = float24::FromFloat32(srcdata[comp]);
                 }
                 break;
@@ -114,7 +140,7 @@ void VertexLoader::LoadVertex(u32 base_address, int index, int vertex,
             case PipelineRegs::VertexAttributeFormat::SHORT: {
                 const s16* srcdata = reinterpret_cast<const s16*>(
                     VideoCore::g_memory->GetPhysicalPointer(source_addr));
-                for (unsigned int comp = 0; comp < vertex_attribute_elements[i]; ++comp) {
+                for (unsigned int comp = 0; comp < layout.elements[i]; ++comp) {
                     input.attr[i][comp] = float24::FromFloat32(srcdata[comp]);
                 }
                 break;
@@ -122,7 +148,7 @@ void VertexLoader::LoadVertex(u32 base_address, int index, int vertex,
             case PipelineRegs::VertexAttributeFormat::FLOAT: {
                 const float* srcdata = reinterpret_cast<const float*>(
                     VideoCore::g_memory->GetPhysicalPointer(source_addr));
-                for (unsigned int comp = 0; comp < vertex_attribute_elements[i]; ++comp) {
+                for (unsigned int comp = 0; comp < layout.elements[i]; ++comp) {
                     input.attr[i][comp] = float24::FromFloat32(srcdata[comp]);
                 }
                 break;
@@ -132,7 +158,7 @@ void VertexLoader::LoadVertex(u32 base_address, int index, int vertex,
             // Default attribute values set if array elements have < 4 components. This
             // is *not* carried over from the default attribute settings even if they're
             // enabled for this attribute.
-            for (unsigned int comp = vertex_attribute_elements[i]; comp < 4; ++comp) {
+            for (unsigned int comp = layout.elements[i]; comp < 4; ++comp) {
                 input.attr[i][comp] =
                     comp == 3 ? float24::FromFloat32(1.0f) : float24::FromFloat32(0.0f);
             }
@@ -140,11 +166,11 @@ void VertexLoader::LoadVertex(u32 base_address, int index, int vertex,
             LOG_TRACE(HW_GPU,
                       "Loaded {} components of attribute {:x} for vertex {:x} (index {:x}) from "
                       "0x{:08x} + 0x{:08x} + 0x{:04x}: {} {} {} {}",
-                      vertex_attribute_elements[i], i, vertex, index, base_address,
-                      vertex_attribute_sources[i], vertex_attribute_strides[i] * vertex,
+                      layout.elements[i], i, vertex, index, base_address,
+                      layout.sources[i], layout.strides[i] * vertex,
                       input.attr[i][0].ToFloat32(), input.attr[i][1].ToFloat32(),
                       input.attr[i][2].ToFloat32(), input.attr[i][3].ToFloat32());
-        } else if (vertex_attribute_is_default[i]) {
+        } else if (layout.is_default[i]) {
             // Load the default attribute if we're configured to do so
             input.attr[i] = g_state.input_default_attributes.attr[i];
             LOG_TRACE(
@@ -160,4 +186,9 @@ void VertexLoader::LoadVertex(u32 base_address, int index, int vertex,
     }
 }
 
+template void VertexLoader::LoadVertex<false>(u32, int, int, Shader::AttributeBuffer&,
+                                              DebugUtils::MemoryAccessTracker&);
+template void VertexLoader::LoadVertex<true>(u32, int, int, Shader::AttributeBuffer&,
+                                             DebugUtils::MemoryAccessTracker&);
+
 } // namespace Pica
@@ -14,29 +14,50 @@ namespace Shader {
 struct AttributeBuffer;
 }
 
+class VertexLoaderJit;
+
 class VertexLoader {
 public:
+    /// Attribute layout of the vertex arrays, used as the cache key of compiled loaders
+    struct Layout {
+        std::array<u32, 16> sources{};
+        std::array<u32, 16> strides{};
+        std::array<PipelineRegs::VertexAttributeFormat, 16> formats{};
+        std::array<u32, 16> elements{};
+        std::array<bool, 16> is_default{};
+        int num_total_attributes = 0;
+    };
+
     VertexLoader() = default;
     explicit VertexLoader(const PipelineRegs& regs) {
         Setup(regs);
     }
 
     void Setup(const PipelineRegs& regs);
+
+    /**
+     * Loads the attributes of a vertex from the vertex arrays.
+     * @tparam debug If true, the memory read is reported to memory_accesses for the CiTrace
+     * recorder. Otherwise memory_accesses is left untouched.
+     */
+    template <bool debug>
     void LoadVertex(u32 base_address, int index, int vertex, Shader::AttributeBuffer& input,
                     DebugUtils::MemoryAccessTracker& memory_accesses);
 
     int GetNumTotalAttributes() const {
-        return num_total_attributes;
+        return layout.num_total_attributes;
     }
 
 private:
-    std::array<u32, 16> vertex_attribute_sources;
-    std::array<u32, 16> vertex_attribute_strides{};
-    std::array<PipelineRegs::VertexAttributeFormat, 16> vertex_attribute_formats;
-    std::array<u32, 16> vertex_attribute_elements{};
-    std::array<bool, 16> vertex_attribute_is_default;
-    int num_total_attributes = 0;
+    Layout layout;
     bool is_setup = false;
+
+    /// Compiled loader for the layout, or nullptr if vertices are loaded by the interpreter
+    const VertexLoaderJit* jit = nullptr;
+    /// Host pointers to the first element of each attribute array, valid for jit_base_address
+    std::array<const u8*, 16> jit_attribute_pointers{};
+    u32 jit_base_address = 0;
+    bool jit_pointers_valid = false;
 };
 
 } // namespace Pica
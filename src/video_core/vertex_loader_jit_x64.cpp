@@ -0,0 +1,223 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <xmmintrin.h>
+#include "common/assert.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "common/x64/xbyak_abi.h"
+#include "video_core/pica_state.h"
+#include "video_core/shader/shader.h"
+#include "video_core/vertex_loader_jit_x64.h"
+
+using namespace Common::X64;
+using namespace Xbyak::util;
+using Xbyak::Reg32;
+using Xbyak::Reg64;
+using Xbyak::Xmm;
+
+namespace Pica {
+
+/// Memory allocated for each compiled loader, enough for 16 attributes of the longest kind
+constexpr std::size_t MAX_LOADER_SIZE = 4096;
+
+/// Maximum number of compiled loaders kept around, the least recently used one is evicted beyond
+constexpr std::size_t MAX_CACHED_LOADERS = 64;
+
+// Only caller-saved registers that aren't used for parameter passing in either ABI once the
+// parameters have been moved out of the way are used, so that no registers have to be preserved.
+
+/// Pointer to the array of attribute pointers
+static const Reg64 ATTRIBUTE_POINTERS = r9;
+/// Index of the vertex being loaded
+static const Reg32 VERTEX = eax;
+/// Pointer to the AttributeBuffer being loaded into
+static const Reg64 INPUT = r8;
+/// Pointer to the current attribute data
+static const Reg64 SOURCE = r10;
+/// Scratch registers
+static const Reg64 SCRATCH0 = r11;
+static const Reg64 SCRATCH1 = rcx;
+/// (0.0, 0.0, 0.0, 1.0), OR'd into attributes with less than 4 elements
+static const Xmm W_ONE = xmm3;
+
+static_assert(sizeof(float24) == sizeof(float),
+              "The compiled loader assumes float24 to be stored as a float");
+
+VertexLoaderJit::VertexLoaderJit(const VertexLoader::Layout& layout)
+    : Xbyak::CodeGenerator(MAX_LOADER_SIZE) {
+    program = (CompiledLoader*)getCurr();
+
+    mov(ATTRIBUTE_POINTERS, ABI_PARAM1);
+    mov(VERTEX, ABI_PARAM2.cvt32());
+    mov(INPUT, ABI_PARAM3);
+
+    mov(SCRATCH0.cvt32(), 0x3F800000); // 1.0f
+    movd(W_ONE, SCRATCH0.cvt32());
+    pshufd(W_ONE, W_ONE, _MM_SHUFFLE(0, 1, 1, 1));
+
+    for (int i = 0; i < layout.num_total_attributes; ++i) {
+        if (layout.elements[i] != 0) {
+            Compile_LoadAttribute(i, layout.formats[i], layout.elements[i], layout.strides[i]);
+        } else if (layout.is_default[i]) {
+            // Default attributes may change between batches, so they are read from the PICA
+            // state instead of being embedded into the code
+            mov(SCRATCH0, reinterpret_cast<std::uintptr_t>(
+                              &g_state.input_default_attributes.attr[i]));
+            movaps(xmm0, xword[SCRATCH0]);
+            movaps(xword[INPUT + i * sizeof(Common::Vec4<float24>)], xmm0);
+        }
+    }
+
+    ret();
+    ready();
+
+    ASSERT_MSG(getSize() <= MAX_LOADER_SIZE,
+               "Compiled a vertex loader that exceeds the allocated size!");
+    LOG_DEBUG(HW_GPU, "Compiled vertex loader size={}", getSize());
+}
+
+void VertexLoaderJit::Compile_LoadAttribute(int index, PipelineRegs::VertexAttributeFormat format,
+                                            u32 elements, u32 stride) {
+    using Format = PipelineRegs::VertexAttributeFormat;
+
+    // SOURCE = attribute_pointers[index] + vertex * stride
+    mov(SOURCE, qword[ATTRIBUTE_POINTERS + index * sizeof(const u8*)]);
+    imul(SCRATCH0.cvt32(), VERTEX, stride);
+    add(SOURCE, SCRATCH0);
+
+    // Load exactly the bytes of the attribute into the low bits of xmm0, zeroing the rest, so that
+    // reads never run past the end of the array
+    switch (format) {
+    case Format::BYTE:
+    case Format::UBYTE:
+        switch (elements) {
+        case 1:
+            movzx(SCRATCH0.cvt32(), byte[SOURCE]);
+            movd(xmm0, SCRATCH0.cvt32());
+            break;
+        case 2:
+            movzx(SCRATCH0.cvt32(), word[SOURCE]);
+            movd(xmm0, SCRATCH0.cvt32());
+            break;
+        case 3:
+            movzx(SCRATCH0.cvt32(), word[SOURCE]);
+            movzx(SCRATCH1.cvt32(), byte[SOURCE + 2]);
+            shl(SCRATCH1.cvt32(), 16);
+            or_(SCRATCH0.cvt32(), SCRATCH1.cvt32());
+            movd(xmm0, SCRATCH0.cvt32());
+            break;
+        case 4:
+            movd(xmm0, dword[SOURCE]);
+            break;
+        }
+
+        if (format == Format::BYTE) {
+            // Widen to the top byte of each dword and sign-extend back down
+            punpcklbw(xmm0, xmm0);
+            punpcklwd(xmm0, xmm0);
+            psrad(xmm0, 24);
+        } else {
+            pxor(xmm1, xmm1);
+            punpcklbw(xmm0, xmm1);
+            punpcklwd(xmm0, xmm1);
+        }
+        cvtdq2ps(xmm0, xmm0);
+        break;
+
+    case Format::SHORT:
+        switch (elements) {
+        case 1:
+            movzx(SCRATCH0.cvt32(), word[SOURCE]);
+            movd(xmm0, SCRATCH0.cvt32());
+            break;
+        case 2:
+            movd(xmm0, dword[SOURCE]);
+            break;
+        case 3:
+            movd(xmm0, dword[SOURCE]);
+            pinsrw(xmm0, word[SOURCE + 4], 2);
+            break;
+        case 4:
+            movq(xmm0, qword[SOURCE]);
+            break;
+        }
+
+        // Widen to the top half of each dword and sign-extend back down
+        punpcklwd(xmm0, xmm0);
+        psrad(xmm0, 16);
+        cvtdq2ps(xmm0, xmm0);
+        break;
+
+    case Format::FLOAT:
+        switch (elements) {
+        case 1:
+            movss(xmm0, dword[SOURCE]);
+            break;
+        case 2:
+            movq(xmm0, qword[SOURCE]);
+            break;
+        case 3:
+            movq(xmm0, qword[SOURCE]);
+            movss(xmm1, dword[SOURCE + 8]);
+            movlhps(xmm0, xmm1);
+            break;
+        case 4:
+            movups(xmm0, xword[SOURCE]);
+            break;
+        }
+        break;
+    }
+
+    // Missing elements default to (0, 0, 0, 1). Everything past the loaded elements is zero here.
+    if (elements < 4) {
+        orps(xmm0, W_ONE);
+    }
+
+    movaps(xword[INPUT + index * sizeof(Common::Vec4<float24>)], xmm0);
+}
+
+const VertexLoaderJit& GetVertexLoaderJit(const VertexLoader::Layout& layout) {
+    struct CacheEntry {
+        VertexLoader::Layout layout;
+        std::unique_ptr<VertexLoaderJit> loader;
+        u64 last_use = 0;
+    };
+
+    // Vertex loading only ever happens on the thread processing PICA commands. Only the loader
+    // of the draw being set up is in use, so evicting any other entry is safe.
+    static std::unordered_map<u64, CacheEntry> cache;
+    static u64 use_counter = 0;
+
+    const u64 key = Common::ComputeStructHash64(layout);
+    auto iter = cache.find(key);
+    // The layout is hashed byte by byte, so it is compared the same way to rule out collisions
+    if (iter != cache.end() &&
+        std::memcmp(&iter->second.layout, &layout, sizeof(VertexLoader::Layout)) != 0) {
+        LOG_DEBUG(HW_GPU, "Vertex loader hash collision, recompiling");
+        cache.erase(iter);
+        iter = cache.end();
+    }
+    if (iter == cache.end()) {
+        if (cache.size() >= MAX_CACHED_LOADERS) {
+            cache.erase(std::min_element(cache.begin(), cache.end(),
+                                         [](const auto& a, const auto& b) {
+                                             return a.second.last_use < b.second.last_use;
+                                         }));
+        }
+        auto loader = std::make_unique<VertexLoaderJit>(layout);
+        iter = cache.emplace(key, CacheEntry{layout, std::move(loader)}).first;
+    }
+    iter->second.last_use = ++use_counter;
+    return *iter->second.loader;
+}
+
+} // namespace Pica
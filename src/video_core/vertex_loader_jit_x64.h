@@ -0,0 +1,53 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <xbyak.h>
+#include "common/common_types.h"
+#include "video_core/vertex_loader.h"
+
+namespace Pica {
+
+namespace Shader {
+struct AttributeBuffer;
+}
+
+/**
+ * Vertex fetch routine compiled for a single attribute layout. Offsets, strides, formats and
+ * element counts are baked into the code, so loading a vertex boils down to a couple of SIMD
+ * loads and conversions per attribute, without any per-component branching.
+ */
+class VertexLoaderJit : public Xbyak::CodeGenerator {
+public:
+    explicit VertexLoaderJit(const VertexLoader::Layout& layout);
+
+    /**
+     * Loads all attributes of a vertex.
+     * @param attribute_pointers Host pointers to the first element of each attribute array
+     * @param vertex Index of the vertex in the attribute arrays
+     * @param input Attribute buffer to load the vertex into
+     */
+    void LoadVertex(const std::array<const u8*, 16>& attribute_pointers, u32 vertex,
+                    Shader::AttributeBuffer& input) const {
+        program(attribute_pointers.data(), vertex, &input);
+    }
+
+private:
+    void Compile_LoadAttribute(int index, PipelineRegs::VertexAttributeFormat format,
+                               u32 elements, u32 stride);
+
+    using CompiledLoader = void(const u8* const* attribute_pointers, u32 vertex,
+                                Shader::AttributeBuffer* input);
+    CompiledLoader* program = nullptr;
+};
+
+/**
+ * Returns the loader compiled for the layout, compiling it on first use. Rarely used loaders are
+ * evicted, so the returned reference only stays valid until the next call.
+ */
+const VertexLoaderJit& GetVertexLoaderJit(const VertexLoader::Layout& layout);
+
+} // namespace Pica
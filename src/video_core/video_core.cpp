@@ -5,8 +5,10 @@
 #include <memory>
 #include "common/logging/log.h"
 #include "core/settings.h"
+#include "video_core/gpu_thread.h"
 #include "video_core/pica.h"
 #include "video_core/renderer_base.h"
+#include "video_core/renderer_null/renderer_null.h"
 #include "video_core/renderer_opengl/gl_vars.h"
 #include "video_core/renderer_opengl/renderer_opengl.h"
 #include "video_core/video_core.h"
@@ -17,6 +19,7 @@
 namespace VideoCore {
 
 std::unique_ptr<RendererBase> g_renderer; ///< Renderer plugin
+std::unique_ptr<GPUThread::ThreadManager> g_gpu_thread;
 
 std::atomic<bool> g_hw_renderer_enabled;
 std::atomic<bool> g_shader_jit_enabled;
@@ -37,14 +40,26 @@ Core::System::ResultStatus Init(Frontend::EmuWindow& emu_window, Memory::MemoryS
     g_memory = &memory;
     Pica::Init();
 
-    OpenGL::GLES = Settings::values.use_gles;
-
-    g_renderer = std::make_unique<OpenGL::RendererOpenGL>(emu_window);
+    switch (Settings::values.renderer_backend) {
+    case Settings::RendererBackend::Null:
+        g_renderer = std::make_unique<RendererNull>(emu_window, false);
+        break;
+    case Settings::RendererBackend::NullSoftware:
+        g_renderer = std::make_unique<RendererNull>(emu_window, true);
+        break;
+    default:
+        OpenGL::GLES = Settings::values.use_gles;
+        g_renderer = std::make_unique<OpenGL::RendererOpenGL>(emu_window);
+        break;
+    }
     Core::System::ResultStatus result = g_renderer->Init();
 
     if (result != Core::System::ResultStatus::Success) {
         LOG_ERROR(Render, "initialization failed !");
     } else {
+        if (Settings::values.use_gpu_thread) {
+            g_gpu_thread = std::make_unique<GPUThread::ThreadManager>(*g_renderer, emu_window);
+        }
         LOG_DEBUG(Render, "initialized OK");
     }
 
@@ -53,6 +68,7 @@ Core::System::ResultStatus Init(Frontend::EmuWindow& emu_window, Memory::MemoryS
 
 /// Shutdown the video core
 void Shutdown() {
+    g_gpu_thread.reset();
     Pica::Shutdown();
 
     g_renderer.reset();
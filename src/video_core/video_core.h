@@ -24,7 +24,13 @@ class MemorySystem;
 
 namespace VideoCore {
 
+namespace GPUThread {
+class ThreadManager;
+}
+
 extern std::unique_ptr<RendererBase> g_renderer; ///< Renderer plugin
+/// GPU command processing thread, only present if enabled in the settings
+extern std::unique_ptr<GPUThread::ThreadManager> g_gpu_thread;
 
 // TODO: Wrap these in a user settings struct along with any other graphics settings (often set from
 // qt ui)